@@ -5,116 +5,153 @@
  */
 
 #include "M5UnitFingerprint2.hpp"
-
-#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
-// 静态成员变量定义 / Static member variable definitions
-SemaphoreHandle_t M5UnitFingerprint2::mutexLock         = nullptr;
-SemaphoreHandle_t M5UnitFingerprint2::responseSemaphore = nullptr;
-M5UnitFingerprint2* M5UnitFingerprint2::instance        = nullptr;
-
-// 队列相关静态变量 / Queue-related static variables
-QueueHandle_t M5UnitFingerprint2::dataQueue      = nullptr;
-TaskHandle_t M5UnitFingerprint2::parseTaskHandle = nullptr;
-#endif
+#include "M5UnitFingerprint2_session.hpp"
 
 void M5UnitFingerprint2::acquireMutex()
 {
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
     if (mutexLock == nullptr) {
         mutexLock = xSemaphoreCreateMutex();
     }
-    if (mutexLock != nullptr) {
+    if (mutexLock != nullptr && xSemaphoreTake(mutexLock, 0) != pdTRUE) {
+        uint32_t start = static_cast<uint32_t>(micros());
         xSemaphoreTake(mutexLock, portMAX_DELAY);
+        recordLockWait(_rxLockWait, static_cast<uint32_t>(micros()) - start);
+    }
+#else
+    if (!_mutex.try_lock()) {
+        uint32_t start = static_cast<uint32_t>(micros());
+        _mutex.lock();
+        recordLockWait(_rxLockWait, static_cast<uint32_t>(micros()) - start);
     }
+#endif
 }
 
 void M5UnitFingerprint2::releaseMutex()
 {
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
     if (mutexLock != nullptr) {
         xSemaphoreGive(mutexLock);
     }
+#else
+    _mutex.unlock();
+#endif
 }
 
+// 发送锁只串行化写出，解析器从不获取 / The send lock only serializes writes; the parser never takes it
+void M5UnitFingerprint2::acquireTxMutex()
+{
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    if (txMutexLock == nullptr) {
+        txMutexLock = xSemaphoreCreateMutex();
+    }
+    if (txMutexLock != nullptr && xSemaphoreTake(txMutexLock, 0) != pdTRUE) {
+        uint32_t start = static_cast<uint32_t>(micros());
+        xSemaphoreTake(txMutexLock, portMAX_DELAY);
+        recordLockWait(_txLockWait, static_cast<uint32_t>(micros()) - start);
+    }
+#else
+    if (!_txMutex.try_lock()) {
+        uint32_t start = static_cast<uint32_t>(micros());
+        _txMutex.lock();
+        recordLockWait(_txLockWait, static_cast<uint32_t>(micros()) - start);
+    }
+#endif
+}
+
+void M5UnitFingerprint2::releaseTxMutex()
+{
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    if (txMutexLock != nullptr) {
+        xSemaphoreGive(txMutexLock);
+    }
+#else
+    _txMutex.unlock();
+#endif
+}
+
+void M5UnitFingerprint2::recordLockWait(LockWaitStats& stats, uint32_t waitedUs)
+{
+    stats.contended++;
+    stats.totalUs += waitedUs;
+    if (waitedUs > stats.maxUs) {
+        stats.maxUs = waitedUs;
+    }
+}
+
+#if defined(ARDUINO)
 // 构造函数 - Arduino 版本 / Constructor - Arduino version
 M5UnitFingerprint2::M5UnitFingerprint2(HardwareSerial* serialPort, int txPin, int rxPin, uint32_t address)
+    : M5UnitFingerprint2(static_cast<Fingerprint_Transport*>(nullptr), address)
 {
-    _serialPort  = serialPort;
+    _arduinoTransport = Fingerprint_ArduinoTransport(serialPort, txPin, rxPin);
+    _transport        = (serialPort != nullptr) ? &_arduinoTransport : nullptr;
+}
+#endif
+
+// 构造函数 - 传输接口版本 / Constructor - transport version
+M5UnitFingerprint2::M5UnitFingerprint2(Fingerprint_Transport* transport, uint32_t address)
+{
+    _transport   = transport;
     _fp2_address = address;
-    _txPin       = txPin;
-    _rxPin       = rxPin;
-    instance     = this;
+    _framer.setCallback(onFrameReceived, this);
+    _framer.setStorageCallback(onFrameStorage);
 }
 
 // 析构函数，ESP 平台上删除互斥锁 / Destructor, delete mutex lock on ESP platform
 M5UnitFingerprint2::~M5UnitFingerprint2()
 {
 #if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    // 注销数据到达回调 / Unregister data arrival callback
+    if (_transport != nullptr && _eventDrivenRx) {
+        _transport->setReceiveCallback(nullptr, nullptr);
+    }
+
     // 停止解析任务 / Stop parsing task
     if (parseTaskHandle != nullptr) {
         vTaskDelete(parseTaskHandle);
         parseTaskHandle = nullptr;
     }
-
-    // 删除队列 / Delete queue
-    if (dataQueue != nullptr) {
-        vQueueDelete(dataQueue);
-        dataQueue = nullptr;
-    }
-
-    // 删除响应信号量 / Delete response semaphore
-    if (responseSemaphore != nullptr) {
-        vSemaphoreDelete(responseSemaphore);
-        responseSemaphore = nullptr;
-    }
 #endif
 
-    // 清理静态实例指针 / Clean up static instance pointer
-    if (instance == this) {
-        instance = nullptr;
-    }
-
 #if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    // 只删除本实例的互斥锁，其它实例不受影响 / Only this instance's mutex is deleted; other instances are unaffected
     if (mutexLock != NULL) {
         vSemaphoreDelete(mutexLock);
         mutexLock = NULL;
     }
+    if (txMutexLock != NULL) {
+        vSemaphoreDelete(txMutexLock);
+        txMutexLock = NULL;
+    }
+#if !FINGERPRINT_HANDOFF_INDEXED_NOTIFY
+    if (_handoffSignal != NULL) {
+        vSemaphoreDelete(_handoffSignal);
+        _handoffSignal = NULL;
+    }
+#endif
 #endif
 }
 
 // 读取串口数据 / Read serial data
 size_t M5UnitFingerprint2::readSerial(uint8_t* buffer, size_t length)
 {
-    if (buffer == nullptr || length == 0) {
+    if (buffer == nullptr || length == 0 || _transport == nullptr) {
         return 0;
     }
 
-#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
-    // Arduino 平台 / Arduino platform
-    if (_serialPort != nullptr) {
-        size_t bytesRead = 0;
-        while (bytesRead < length && _serialPort->available()) {
-            buffer[bytesRead] = _serialPort->read();
-            bytesRead++;
-        }
-        return bytesRead;
-    }
-#endif
-    return 0;
+    // 传输按可用字节数一次性块读取，不阻塞 / The transport reads everything available in one block call without blocking
+    return _transport->read(buffer, length);
 }
 
 // 写入串口数据 / Write serial data
 size_t M5UnitFingerprint2::writeSerial(const uint8_t* buffer, size_t length)
 {
-    if (buffer == nullptr || length == 0) {
+    if (buffer == nullptr || length == 0 || _transport == nullptr) {
         return 0;
     }
 
-#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
-    // Arduino 平台 / Arduino platform
-    if (_serialPort != nullptr) {
-        return _serialPort->write(buffer, length);
-    }
-#endif
-    return 0;
+    return _transport->write(buffer, length);
 }
 
 #if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
@@ -122,429 +159,645 @@ size_t M5UnitFingerprint2::writeSerial(const uint8_t* buffer, size_t length)
 void M5UnitFingerprint2::parseDataTask(void* parameter)
 {
     M5UnitFingerprint2* instance = static_cast<M5UnitFingerprint2*>(parameter);
-    uint8_t buffer[256];
+
+    // 最早过期时间：上次清理的时间 + 剩余等待时间 / Earliest deadline: time of the last cleanup + remaining wait
+    uint32_t expiryWait      = UINT32_MAX;
+    unsigned long expiryBase = 0;
+    uint32_t expiryFrames    = 0;
+
+    // 在途异步命令的应答超时：上次处理的时间 + 剩余等待时间 / Acknowledge timeout of the asynchronous command in flight: time of the last pass + remaining wait
+    uint32_t commandWait      = UINT32_MAX;
+    unsigned long commandBase = 0;
 
     while (true) {
-        // 检查串口中断接收的数据 / Check data received by serial interrupt
-        if (instance->_serialPort != nullptr && instance->_serialPort->available()) {
-            size_t len = instance->readSerial(buffer, sizeof(buffer));
-            if (len > 0) {
-                // 直接处理接收到的数据，更新时间戳 / Process received data directly and update timestamp
-                instance->processReceivedData(buffer, len);
+        if (instance->_eventDrivenRx) {
+            // 阻塞等待 UART 接收事件，最多睡到最早过期时间或命令超时；都没有时不会定时唤醒 / Block until a UART RX event, sleeping at most until the earliest packet deadline or command timeout; no timed wakeups when there is neither
+            uint32_t waitMs = UINT32_MAX;
+            if (expiryWait != UINT32_MAX) {
+                unsigned long elapsed = millis() - expiryBase;
+                waitMs                = (elapsed >= expiryWait) ? 0 : expiryWait - elapsed;
             }
+            if (commandWait != UINT32_MAX) {
+                unsigned long elapsed = millis() - commandBase;
+                uint32_t remaining    = (elapsed >= commandWait) ? 0 : commandWait - elapsed;
+                if (remaining < waitMs) {
+                    waitMs = remaining;
+                }
+            }
+            ulTaskNotifyTake(pdTRUE, (waitMs == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(waitMs));
         }
+
+        // 读取串口中断接收的全部数据，块读取后立即送入分帧器 / Drain all data received by serial interrupt, framing each block right after it is read
+        // 环形缓冲区满时数据暂留在驱动中，消费后继续读取 / When the ring was full, data stayed in the driver; keep reading after consuming
+        size_t len;
+        do {
+            len = instance->receiveSerialData();
+            instance->checkAndParsePackets();
+        } while (len > 0 || instance->_rxStalled.exchange(false, std::memory_order_relaxed));
         
-        // 检查是否可以开始解析数据包（基于包间隔） / Check if packet parsing can start (based on packet interval)
-        instance->checkAndParsePackets();
-        
-        // 清理过期的解析包 / Clean up expired parsed packets
-        instance->cleanupExpiredPackets();
+        // 只在有新包、到达最早过期时间或生命周期变更时清理，空闲时不加锁 / Clean up only on new packets, a reached deadline or a lifetime change; idle loops take no lock
+        uint32_t frames = instance->_framer.getFrameCount();
+        if (frames != expiryFrames || instance->_expiryChanged.exchange(false, std::memory_order_relaxed) ||
+            (expiryWait != UINT32_MAX && millis() - expiryBase >= expiryWait)) {
+            expiryFrames = frames;
+            expiryBase   = millis();
+            expiryWait   = instance->cleanupExpiredPackets();
+        }
+
+        // 完成的异步命令在锁外回调，并发送下一条 / Call back completed asynchronous commands outside the lock and send the next one
+        commandBase = millis();
+        commandWait = instance->processCommands();
         
-        vTaskDelay(pdMS_TO_TICKS(1)); // 1ms检查间隔 / 1ms check interval
+        // 传输不支持数据到达通知时回退为轮询 / Fall back to polling when the transport cannot signal data arrival
+        if (!instance->_eventDrivenRx) {
+            vTaskDelay(pdMS_TO_TICKS(1)); // 1ms检查间隔 / 1ms check interval
+        }
+    }
+}
+
+// 数据到达回调，在 UART 事件任务中执行 / Data arrival callback, runs in the UART event task
+void M5UnitFingerprint2::onTransportReceive(void* context)
+{
+    M5UnitFingerprint2* self = static_cast<M5UnitFingerprint2*>(context);
+
+    // 尽快把数据移出驱动缓冲区，再唤醒解析任务 / Move data out of the driver buffer right away, then wake the parse task
+    self->receiveSerialData();
+    if (self->parseTaskHandle != nullptr) {
+        xTaskNotifyGive(self->parseTaskHandle);
     }
 }
 #endif
 
-// 处理接收到的数据 / Process received data
-void M5UnitFingerprint2::processReceivedData(uint8_t* data, size_t length)
+// 是否由调用者解析接收的数据 / Whether received data is parsed by the caller
+bool M5UnitFingerprint2::parsesInline() const
 {
-    // 获取互斥锁 / Acquire mutex lock
-    acquireMutex();
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    return parseTaskHandle == nullptr;
+#else
+    return true;
+#endif
+}
 
-#if defined M5_MODULE_DEBUG_SERIAL
-    serialPrintf("RX: %d bytes -> ", length);
-    //打印全部数据 / Print all data
-    for (size_t i = 0; i < length; i++) {
-        M5_MODULE_DEBUG_SERIAL.printf("%02X ", data[i]);
+// 内联模式下执行一次解析任务循环 / Run one pass of the parse task loop in inline mode
+uint32_t M5UnitFingerprint2::update()
+{
+    // 环形缓冲区满时数据暂留在驱动中，消费后继续读取 / When the ring was full, data stayed in the driver; keep reading after consuming
+    size_t len;
+    do {
+        len = receiveSerialData();
+        checkAndParsePackets();
+    } while (len > 0 || _rxStalled.exchange(false, std::memory_order_relaxed));
+
+    uint32_t expiryWait  = cleanupExpiredPackets();
+    uint32_t commandWait = processCommands();
+    return (commandWait < expiryWait) ? commandWait : expiryWait;
+}
+
+// 等待解析器处理待接收的响应 / Wait for the parser to make progress on a pending response
+void M5UnitFingerprint2::waitResponseEvent(uint32_t timeout_ms)
+{
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    // 解析任务交付后直接唤醒本任务 / The parse task wakes this task directly after the handoff
+    if (parseTaskHandle != nullptr) {
+        waitHandoffSignal(timeout_ms);
+        return;
     }
-    M5_MODULE_DEBUG_SERIAL.println("");
 #endif
+    // 没有解析任务：等待传输可读后在当前线程内解析。另一线程（如调用 processCommands() 的线程）可能先读走数据并完成交接，
+    // 因此分片等待，及时发现交接
+    // No parse task: wait for the transport to become readable and parse in this thread. Another thread (e.g. one
+    // calling processCommands()) may read the data first and complete the handoff, so wait in slices to notice it
+    if (timeout_ms > FINGERPRINT_NATIVE_WAIT_SLICE_MS) {
+        timeout_ms = FINGERPRINT_NATIVE_WAIT_SLICE_MS;
+    }
+    if (_transport != nullptr && _transport->waitReadable(timeout_ms)) {
+        receiveSerialData();
+        checkAndParsePackets();
+    } else {
+        cleanupExpiredPackets();
+    }
+}
 
-    // 将接收到的数据添加到缓冲区 / Add received data to buffer
-    for (size_t i = 0; i < length; i++) {
-        if (_recvIndex < sizeof(_recvBuffer)) {
-            _recvBuffer[_recvIndex++] = data[i];
-        } else {
-            // 缓冲区溢出，重置 / Buffer overflow, reset
-            serialPrintln("Receive buffer overflow, resetting");
-            _recvIndex = 0;
-            _recvBuffer[_recvIndex++] = data[i];
+// 从串口直接块读取到接收环形缓冲区（生产者端） / Block-read from serial port directly into the receive ring (producer side)
+size_t M5UnitFingerprint2::receiveSerialData()
+{
+    // 同一时刻只允许一个生产者（UART 事件回调或解析任务），无需互斥锁 / Only one producer at a time (UART event callback or parse task), no mutex needed
+    if (_rxProducerBusy.exchange(true, std::memory_order_acquire)) {
+        return 0;
+    }
+
+    size_t total = 0;
+    while (true) {
+        uint8_t* span;
+        size_t space = _rxRing.writeSpan(span);
+        if (space == 0) {
+            // 环形缓冲区已满：数据留在驱动缓冲区中，待分帧器消费后再读（背压），不丢弃已缓存数据 / Ring full: leave data in the driver buffer until the framer consumes some (back-pressure) instead of discarding buffered data
+            if (_transport != nullptr && _transport->available() > 0) {
+                _rxBackpressureCount++;
+                _rxStalled.store(true, std::memory_order_relaxed);
+            }
+            break;
+        }
+
+        size_t length = readSerial(span, space);
+        if (length == 0) {
+            break;
+        }
+
+#if defined M5_MODULE_DEBUG_SERIAL
+        serialPrintf("RX: %d bytes -> ", length);
+        //打印全部数据 / Print all data
+        for (size_t i = 0; i < length; i++) {
+            M5_MODULE_DEBUG_SERIAL.printf("%02X ", span[i]);
+        }
+        M5_MODULE_DEBUG_SERIAL.println("");
+#endif
+
+        _rxRing.commitWrite(length);
+        total += length;
+
+        // 驱动缓冲区已读空 / Driver buffer drained
+        if (length < space) {
+            break;
         }
     }
 
-    // 更新最后接收时间和新数据标志 / Update last receive time and new data flag
-    _lastReceiveTime = millis();
-    _hasNewData = true;
+    _rxBytesReceived += total;
+    _rxProducerBusy.store(false, std::memory_order_release);
+    return total;
+}
 
-    // 释放互斥锁 / Release mutex lock
-    releaseMutex();
+// 获取接收路径统计 / Get receive path statistics
+void M5UnitFingerprint2::getReceiveStats(fingerprint_rx_stats_t& stats) const
+{
+    stats.bytesReceived     = _rxBytesReceived;
+    stats.backpressureCount = _rxBackpressureCount;
+    stats.ringHighWatermark = _rxRing.highWatermark();
+    stats.framesParsed      = _framer.getFrameCount();
+    stats.checksumErrors    = _framer.getChecksumErrorCount();
+    stats.discardedBytes    = _framer.getDiscardedByteCount();
+    stats.packetsDropped    = _parsedPackets.droppedCount();
+    stats.packetsExpired    = _parsedPackets.expiredCount();
+    stats.staleReplies      = _staleReplies;
+    stats.mismatchedReplies = _mismatchedReplies;
+    stats.syncProbes        = _syncProbes;
+    stats.handoffCount          = _handoffCount.load(std::memory_order_relaxed);
+    stats.handoffLatencyLastUs  = _handoffLatencyLastUs.load(std::memory_order_relaxed);
+    stats.handoffLatencyMaxUs   = _handoffLatencyMaxUs.load(std::memory_order_relaxed);
+    stats.handoffLatencyTotalUs = _handoffLatencyTotalUs.load(std::memory_order_relaxed);
+    stats.bytesSent             = _bytesSent;
+    stats.rxLockContended       = _rxLockWait.contended;
+    stats.rxLockWaitMaxUs       = _rxLockWait.maxUs;
+    stats.rxLockWaitTotalUs     = _rxLockWait.totalUs;
+    stats.txLockContended       = _txLockWait.contended;
+    stats.txLockWaitMaxUs       = _txLockWait.maxUs;
+    stats.txLockWaitTotalUs     = _txLockWait.totalUs;
 }
 
-// 检查是否可以开始解析数据包（基于包间隔） / Check if packet parsing can start (based on packet interval)
+// 将环形缓冲区数据送入分帧器并分发完整数据包（消费者端） / Feed ring data to the framer and dispatch complete packets (consumer side)
 void M5UnitFingerprint2::checkAndParsePackets()
 {
-    // 获取互斥锁 / Acquire mutex lock
-    acquireMutex();
+    // 分片送入分帧器，每片之间释放锁，发送方最多等待一片的解析 / Feed the framer in slices and release the lock between them, so a sender waits for one slice at most
+    while (true) {
+        // 获取互斥锁（保护解析队列） / Acquire mutex lock (protects the parse queue)
+        acquireMutex();
 
-    // 检查是否有新数据且已超过包间隔时间 / Check if there is new data and packet interval time has passed
-    if (_hasNewData && (millis() - _lastReceiveTime >= PACKET_INTERVAL_MS)) {
-        _hasNewData = false; // 清除新数据标志 / Clear new data flag
-        
-        // 开始解析缓冲区中的所有完整数据包 / Start parsing all complete packets in the buffer
-        size_t processedBytes = 0;
-        while (processedBytes < _recvIndex) {
-            size_t packetLength = 0;
-            uint8_t* bufferStart = &_recvBuffer[processedBytes];
-            size_t remainingBytes = _recvIndex - processedBytes;
-            
-            // 尝试从当前位置提取一个完整的数据包 / Try to extract a complete packet from current position
-            if (extractSinglePacket(bufferStart, remainingBytes, packetLength)) {
-                // 检查是否为唤醒包，如果是则调用回调函数而不添加到解析队列 / Check if it's a wakeup packet, if so call callback instead of adding to parse queue
-                if (handleWakeupPacket(bufferStart, packetLength)) {
-                    // 是唤醒包，已经处理完毕，跳过addParsedPacket / It's a wakeup packet, processed, skip addParsedPacket
-                    processedBytes += packetLength;
-                } else {
-                    // 不是唤醒包，正常添加到解析队列 / Not a wakeup packet, add to parse queue normally
-                    addParsedPacket(bufferStart, packetLength);
-                    processedBytes += packetLength;
-                }
-                
-// #if defined M5_MODULE_DEBUG_SERIAL
-//                 serialPrintf("Extracted packet: %d bytes, total processed: %d/%d\r\n", 
-//                            packetLength, processedBytes, _recvIndex);
-// #endif
-            } else {
-                // 无法提取完整包，查找下一个可能的起始码 / Cannot extract complete packet, search for next possible start code
-                bool foundNextStart = false;
-                for (size_t i = 1; i < remainingBytes - 1; i++) {
-                    uint16_t startCode = (bufferStart[i] << 8) | bufferStart[i + 1];
-                    if (startCode == FINGERPRINT_STARTCODE) {
-                        processedBytes += i;
-                        foundNextStart = true;
-                        break;
-                    }
-                }
-                
-                if (!foundNextStart) {
-                    // 没有找到更多起始码，保留剩余数据等待下次接收 / No more start codes found, keep remaining data for next reception
-                    if (processedBytes < _recvIndex) {
-                        memmove(_recvBuffer, &_recvBuffer[processedBytes], _recvIndex - processedBytes);
-                        _recvIndex -= processedBytes;
-                    } else {
-                        _recvIndex = 0;
-                    }
-                    break;
-                }
+        // 分帧器保存跨批次的半包状态；回绕的数据分两段直接送入，无需拷贝 / The framer keeps partial-frame state across chunks; wrapped data is fed in place as two spans, no copy needed
+        const uint8_t* span;
+        size_t length;
+        size_t fed = 0;
+        while (fed < FINGERPRINT_PARSE_SLICE_BYTES && (length = _rxRing.readSpan(span)) > 0) {
+            if (length > FINGERPRINT_PARSE_SLICE_BYTES - fed) {
+                length = FINGERPRINT_PARSE_SLICE_BYTES - fed;
             }
+            _framer.feed(span, length);
+            _rxRing.commitRead(length);
+            fed += length;
         }
-        
-        // 如果所有数据都被处理完，清空缓冲区 / If all data has been processed, clear the buffer
-        if (processedBytes >= _recvIndex) {
-            _recvIndex = 0;
+
+        // 有等待者时把包直接交给它 / Hand the packet straight to the waiter, if any
+        deliverHandoff();
+
+        // 释放互斥锁 / Release mutex lock
+        releaseMutex();
+
+        if (fed < FINGERPRINT_PARSE_SLICE_BYTES) {
+            break;
         }
     }
+}
 
-    // 如果正在等待响应，检查解析队列中是否有匹配的包 / If waiting for response, check if there's a matching packet in parse queue
-    if (_waitingForResponse && _expectedPacket != nullptr) {
-        if (getMatchingPacket(*_expectedPacket)) {
-            _packetReceived = true;
-            _waitingForResponse = false;
+// 丢弃未完成的帧与环形缓冲区中尚未解析的字节 / Drop the partial frame and the bytes not yet parsed in the receive ring
+void M5UnitFingerprint2::resetReceiveLocked()
+{
+    const uint8_t* span;
+    size_t length;
+    while ((length = _rxRing.readSpan(span)) > 0) {
+        _rxRing.commitRead(length);
+    }
+    _framer.reset();
+}
 
-            // 通知等待的线程 / Notify waiting thread
-#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
-            if (responseSemaphore != nullptr) {
-                xSemaphoreGive(responseSemaphore);
-            }
+// 分帧器完整帧回调 / Framer complete frame callback
+void M5UnitFingerprint2::onFrameReceived(void* context, const uint8_t* frame, size_t length)
+{
+    M5UnitFingerprint2* self = static_cast<M5UnitFingerprint2*>(context);
+    self->_frameStamp        = static_cast<uint32_t>(micros());
+
+#if defined M5_MODULE_DEBUG_SERIAL
+    uint16_t dataLength      = (frame[7] << 8) | frame[8];
+    uint8_t confirmationCode = (dataLength > 2) ? frame[9] : 0x00;
+    serialPrintf("Valid packet found: type=0x%02X, len=%d, total=%d, confirm=0x%02X\r\n", frame[6], dataLength,
+                 length, confirmationCode);
 #endif
+
+    // 帧是否直接组装在预留的队列槽位中 / Whether the frame was assembled directly in the reserved queue slot
+    bool inSlot = self->_parsedPackets.isReserved(frame);
+
+    // 检查是否为唤醒包，如果是则调用回调函数而不添加到解析队列 / Check if it's a wakeup packet, if so call callback instead of adding to parse queue
+    if (self->handleWakeupPacket(frame, length)) {
+        if (inSlot) {
+            self->_parsedPackets.cancelReserved();
         }
+        return;
     }
 
-    // 释放互斥锁 / Release mutex lock
+    // 超时命令迟到的应答包直接丢弃，避免被当作后续命令的应答 / Late replies to timed-out commands are dropped so they are not taken as the reply to a later command
+    if (self->dropStaleReply(frame, length)) {
+        if (inSlot) {
+            self->_parsedPackets.cancelReserved();
+        }
+        return;
+    }
+
+    // 流式接收中的数据包直接写入目标缓冲区，不进入解析队列 / Data packets being streamed go straight to the destination buffer, bypassing the parse queue
+    if (self->sinkDataFrame(frame, length)) {
+        if (inSlot) {
+            self->_parsedPackets.cancelReserved();
+        }
+        return;
+    }
+
+    // 自动流程会话的阶段包直接交给会话，由其在锁外分发 / Stage packets of an auto flow session go straight to the session, which dispatches them outside the lock
+    Fingerprint_AutoFlowSession* session = self->_autoSession.load(std::memory_order_relaxed);
+    if (session != nullptr && session->onFrame(frame, length)) {
+        // 会话发出的命令已得到应答 / The command the session sent has its acknowledge
+        self->_lastCommand = 0;
+        if (inSlot) {
+            self->_parsedPackets.cancelReserved();
+        }
+        return;
+    }
+
+    // 异步命令的应答包直接完成对应命令，不进入解析队列 / The acknowledge of an asynchronous command completes it directly, bypassing the parse queue
+    if (self->completeCommand(frame, length)) {
+        if (inSlot) {
+            self->_parsedPackets.cancelReserved();
+        }
+        return;
+    }
+
+    // 进入队列的应答属于阻塞命令，之后超时不再留墓碑 / An acknowledge entering the queue belongs to the blocking command, so a later timeout leaves no tombstone
+    if (frame[6] == FINGERPRINT_PACKET_ACKPACKET) {
+        self->_lastCommand = 0;
+    }
+
+    if (inSlot) {
+        // 原地入队，无需拷贝 / Enqueue in place, no copy needed
+        if (!self->_parsedPackets.commitReserved(length, millis(), self->_frameStamp)) {
+#if defined M5_MODULE_DEBUG_SERIAL
+            serialPrintf("Ignored packet type 0x%02X\r\n", frame[6]);
+#endif
+        }
+    } else {
+        self->addParsedPacket(frame, length);
+    }
+}
+
+// 分帧器存储回调，为下一帧预留队列槽位 / Framer storage callback, reserves a queue slot for the next frame
+uint8_t* M5UnitFingerprint2::onFrameStorage(void* context)
+{
+    M5UnitFingerprint2* self = static_cast<M5UnitFingerprint2*>(context);
+
+    // 流式接收期间数据包不进入队列，使用分帧器内部缓冲即可 / While streaming, data packets never enter the queue, so the framer's internal buffer is enough
+    if (self->_dataSink.state == FINGERPRINT_SINK_STREAMING) {
+        return nullptr;
+    }
+    return self->_parsedPackets.reserve();
+}
+
+// 启用数据包流式接收 / Arm the data packet streaming sink
+void M5UnitFingerprint2::armDataSink(uint8_t* buffer, uint32_t capacity)
+{
+    acquireMutex();
+    _dataSink.buffer       = buffer;
+    _dataSink.capacity     = capacity;
+    _dataSink.length       = 0;
+    _dataSink.packets      = 0;
+    _dataSink.lastActivity = millis();
+    _dataSink.state        = FINGERPRINT_SINK_ARMED;
     releaseMutex();
 }
 
-// 从缓冲区中精确解析单个数据包 / Precisely parse a single packet from buffer
-bool M5UnitFingerprint2::extractSinglePacket(uint8_t* buffer, size_t bufferSize, size_t& packetLength)
+// 停用数据包流式接收 / Disarm the data packet streaming sink
+uint32_t M5UnitFingerprint2::disarmDataSink()
 {
-    packetLength = 0;
-    
-    // 检查是否有足够的数据用于最小包头 / Check if there's enough data for minimum packet header
-    if (bufferSize < 9) {
+    acquireMutex();
+    uint32_t length  = _dataSink.length;
+    _dataSink.state  = FINGERPRINT_SINK_IDLE;
+    _dataSink.buffer = nullptr;
+    releaseMutex();
+    return length;
+}
+
+// 由解析器调用，将数据包载荷写入目标缓冲区 / Called by the parser, writes data packet payloads to the destination buffer
+bool M5UnitFingerprint2::sinkDataFrame(const uint8_t* frame, size_t length)
+{
+    uint8_t packetType = frame[6];
+
+    if (_dataSink.state == FINGERPRINT_SINK_ARMED) {
+        // 应答包仍正常入队；确认码成功后开始流式接收 / The ACK is still queued as usual; streaming starts once it reports success
+        if (packetType == FINGERPRINT_PACKET_ACKPACKET) {
+            bool ok         = length > FINGERPRINT_PACKET_HEADER_SIZE + 2 && frame[9] == FINGERPRINT_OK;
+            _dataSink.state = ok ? FINGERPRINT_SINK_STREAMING : FINGERPRINT_SINK_IDLE;
+        }
         return false;
     }
-    
-    // 检查起始码 / Check start code
-    uint16_t startCode = (buffer[0] << 8) | buffer[1];
-    if (startCode != FINGERPRINT_STARTCODE) {
+
+    if (_dataSink.state != FINGERPRINT_SINK_STREAMING ||
+        (packetType != FINGERPRINT_PACKET_DATAPACKET && packetType != FINGERPRINT_PACKET_ENDDATAPACKET)) {
         return false;
     }
-    
-    // 解析地址（4字节） / Parse address (4 bytes)
-    uint32_t address = (buffer[2] << 24) | (buffer[3] << 16) | (buffer[4] << 8) | buffer[5];
-    
-    // 解析包类型（1字节） / Parse packet type (1 byte)
-    uint8_t packetType = buffer[6];
-    
-    // 解析包长度（2字节） / Parse packet length (2 bytes)
-    uint16_t dataLength = (buffer[7] << 8) | buffer[8];
-    
-    // 计算完整包的长度：起始码(2) + 地址(4) + 类型(1) + 长度(2) + 数据 + 校验和(2) / Calculate total packet length: start code(2) + address(4) + type(1) + length(2) + data + checksum(2)
-    size_t totalPacketLength = 9 + dataLength;
-    
-    // 检查缓冲区是否包含完整的包 / Check if buffer contains complete packet
-    if (bufferSize < totalPacketLength) {
-        return false;
+
+    size_t payloadLength = length - FINGERPRINT_PACKET_HEADER_SIZE - 2;
+    if (_dataSink.length + payloadLength > _dataSink.capacity) {
+        _dataSink.state = FINGERPRINT_SINK_OVERFLOW;
+        return true;
     }
-    
-    // 验证校验和 / Verify checksum
-    uint16_t receivedChecksum = (buffer[totalPacketLength - 2] << 8) | buffer[totalPacketLength - 1];
-    uint16_t calculatedChecksum = packetType + dataLength;
-    for (size_t i = 9; i < totalPacketLength - 2; i++) {
-        calculatedChecksum += buffer[i];
+
+    memcpy(_dataSink.buffer + _dataSink.length, frame + FINGERPRINT_PACKET_HEADER_SIZE, payloadLength);
+    _dataSink.length += payloadLength;
+    _dataSink.packets++;
+    _dataSink.lastActivity = millis();
+
+    if (packetType == FINGERPRINT_PACKET_ENDDATAPACKET) {
+        _dataSink.state = FINGERPRINT_SINK_DONE;
     }
-    calculatedChecksum &= 0xFFFF;
-    
-    if (receivedChecksum != calculatedChecksum) {
-#if defined M5_MODULE_DEBUG_SERIAL
-        serialPrintf("Checksum mismatch: expected 0x%04X, got 0x%04X\r\n", 
-                   calculatedChecksum, receivedChecksum);
-#endif
-        return false;
+    return true;
+}
+
+// 等待流式接收结束，只在结束或溢出时被唤醒一次 / Wait for streaming to finish; woken once on completion or overflow
+fingerprint_sink_state_t M5UnitFingerprint2::waitDataSink(uint32_t idle_timeout_ms)
+{
+    acquireMutex();
+    bool done = (_dataSink.state >= FINGERPRINT_SINK_DONE);
+    if (!done && !beginHandoff(nullptr)) {
+        releaseMutex();
+        serialPrintln("Another task is already waiting for a response");
+        return FINGERPRINT_SINK_STREAMING;
     }
-    
-    // 验证地址是否匹配（可选，根据需要启用） / Verify address match (optional, enable as needed)
-    if (address != _fp2_address) {
-#if defined M5_MODULE_DEBUG_SERIAL
-        serialPrintf("Address mismatch: expected 0x%08X, got 0x%08X\r\n", _fp2_address, address);
-#endif
-        // 对于某些情况可能需要接受不同地址的包，这里先接受 / For some cases may need to accept packets with different addresses, accept here first
+    releaseMutex();
+
+    // 以最近一次收到数据包的时间计算空闲超时 / Idle timeout is measured from the last data packet received
+    if (!done && !awaitHandoff(_dataSink.lastActivity, idle_timeout_ms, &_dataSink.lastActivity)) {
+        return FINGERPRINT_SINK_STREAMING;
     }
-    
-    packetLength = totalPacketLength;
-    
-#if defined M5_MODULE_DEBUG_SERIAL
-    // 获取确认码（数据部分的第一个字节，如果有数据的话） / Get confirmation code (first byte of data section, if data exists)
-    uint8_t confirmationCode = (dataLength > 2) ? buffer[9] : 0x00;
-    
-    // 获取校验和 / Get checksum
-    uint16_t checksum = (buffer[totalPacketLength - 2] << 8) | buffer[totalPacketLength - 1];
-    
-    serialPrintf("Valid packet found: type=0x%02X, addr=0x%08X, len=%d, total=%d, confirm=0x%02X, checksum=0x%04X\r\n", 
-               packetType, address, dataLength, totalPacketLength, confirmationCode, checksum);
-    
-    // // 打印前6字节数据（如果有足够的数据） / Print first 6 bytes of data (if enough data exists)
-    // if (dataLength > 2) {  // 减去2字节校验和 / Minus 2 bytes checksum
-    //     uint16_t actualDataLength = dataLength - 2;
-    //     M5_MODULE_DEBUG_SERIAL.print("Data: ");
-    //     for (int i = 0; i < 8 && i < actualDataLength; i++) {
-    //         M5_MODULE_DEBUG_SERIAL.printf("%02X ", buffer[9 + i]);
-    //     }
-    //     if (actualDataLength > 8) {
-    //         M5_MODULE_DEBUG_SERIAL.print("...");
-    //     }
-    //     M5_MODULE_DEBUG_SERIAL.println("");
-    // }
+
+    acquireMutex();
+    fingerprint_sink_state_t state = _dataSink.state;
+    releaseMutex();
+    return state;
+}
+
+// 登记为唯一的等待者 / Register as the single waiter
+bool M5UnitFingerprint2::beginHandoff(Fingerprint_PacketView* view)
+{
+    uint8_t expected = HANDOFF_IDLE;
+    if (!_handoff.compare_exchange_strong(expected, HANDOFF_WAITING, std::memory_order_acq_rel)) {
+        return false;
+    }
+    _handoffView = view;
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    armHandoffSignal();
 #endif
-    
     return true;
 }
 
-// 将解析好的包添加到解析队列 / Add parsed packet to parse queue
-void M5UnitFingerprint2::addParsedPacket(const uint8_t* packetData, size_t packetLength)
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+// 清除上次超时后才到达的残留信号 / Clear a stale signal that arrived after an earlier timeout
+void M5UnitFingerprint2::armHandoffSignal()
 {
-    if (packetLength > sizeof(_parsedPackets[0].data)) {
-        serialPrintf("Packet too large: %d bytes\r\n", packetLength);
-        return;
+#if FINGERPRINT_HANDOFF_INDEXED_NOTIFY
+    _handoffTask = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTakeIndexed(FINGERPRINT_HANDOFF_NOTIFY_INDEX, pdTRUE, 0);
+#else
+    if (_handoffSignal == nullptr) {
+        _handoffSignal = xSemaphoreCreateBinary();
     }
-    
-    // 如果队列已满，移除最老的包 / If queue is full, remove oldest packet
-    if (_parsedPacketCount >= MAX_PARSED_PACKETS) {
-        // 移动数组，删除最老的包 / Shift array, delete oldest packet
-        for (size_t i = 0; i < MAX_PARSED_PACKETS - 1; i++) {
-            _parsedPackets[i] = _parsedPackets[i + 1];
-        }
-        _parsedPacketIndex = MAX_PARSED_PACKETS - 1;
-        _parsedPacketCount = MAX_PARSED_PACKETS - 1;
+    if (_handoffSignal != nullptr) {
+        xSemaphoreTake(_handoffSignal, 0);
     }
-    
-    // 添加新包到队列 / Add new packet to queue
-    memcpy(_parsedPackets[_parsedPacketIndex].data, packetData, packetLength);
-    _parsedPackets[_parsedPacketIndex].length = packetLength;
-    _parsedPackets[_parsedPacketIndex].timestamp = millis();
-    
-    _parsedPacketIndex = (_parsedPacketIndex + 1) % MAX_PARSED_PACKETS;
-    if (_parsedPacketCount < MAX_PARSED_PACKETS) {
-        _parsedPacketCount++;
+#endif
+}
+
+void M5UnitFingerprint2::raiseHandoffSignal()
+{
+#if FINGERPRINT_HANDOFF_INDEXED_NOTIFY
+    xTaskNotifyGiveIndexed(_handoffTask, FINGERPRINT_HANDOFF_NOTIFY_INDEX);
+#else
+    if (_handoffSignal != nullptr) {
+        xSemaphoreGive(_handoffSignal);
     }
-    
-// #if defined M5_MODULE_DEBUG_SERIAL
-//     serialPrintf("Added parsed packet to queue: %d bytes, queue size: %d\r\n", 
-//                packetLength, _parsedPacketCount);
-// #endif
+#endif
 }
 
-// 从解析队列中获取匹配的包 / Get matching packet from parse queue
-bool M5UnitFingerprint2::getMatchingPacket(Fingerprint_Packet& packet)
+// 信号创建失败时退化为按时间片轮询 / Degrades to polling in slices if the signal could not be created
+void M5UnitFingerprint2::waitHandoffSignal(uint32_t timeout_ms)
 {
-    for (size_t i = 0; i < _parsedPacketCount; i++) {
-        const ParsedPacket& parsedPkt = _parsedPackets[i];
-        
-        // 解析包头信息 / Parse packet header info
-        if (parsedPkt.length < 9) continue;
-        
-        uint16_t startCode = (parsedPkt.data[0] << 8) | parsedPkt.data[1];
-        uint32_t address = (parsedPkt.data[2] << 24) | (parsedPkt.data[3] << 16) | 
-                          (parsedPkt.data[4] << 8) | parsedPkt.data[5];
-        uint8_t packetType = parsedPkt.data[6];
-        uint16_t dataLength = (parsedPkt.data[7] << 8) | parsedPkt.data[8];
-        
-        // 检查是否是我们期望的包类型（通常是ACK包或数据包） / Check if it's the expected packet type (usually ACK or data packet)
-        if (startCode == FINGERPRINT_STARTCODE && 
-            (packetType == FINGERPRINT_PACKET_ACKPACKET || 
-             packetType == FINGERPRINT_PACKET_DATAPACKET ||
-             packetType == FINGERPRINT_PACKET_ENDDATAPACKET)) {
-            
-            // 构建Fingerprint_Packet对象 / Build Fingerprint_Packet object
-            uint16_t actualDataLength = dataLength - 2; // 减去校验和长度 / Minus checksum length
-            packet = Fingerprint_Packet(startCode, address, packetType, 
-                                       &parsedPkt.data[9], actualDataLength);
-            
-            // 从队列中移除这个包 / Remove this packet from queue
-            for (size_t j = i; j < _parsedPacketCount - 1; j++) {
-                _parsedPackets[j] = _parsedPackets[j + 1];
-            }
-            _parsedPacketCount--;
-            if (_parsedPacketIndex > 0) {
-                _parsedPacketIndex--;
-            } else {
-                _parsedPacketIndex = MAX_PARSED_PACKETS - 1;
-            }
-            
-// #if defined M5_MODULE_DEBUG_SERIAL
-//             serialPrintf("Found matching packet: type=0x%02X, data_len=%d\r\n", 
-//                        packetType, actualDataLength);
-// #endif
-            return true;
-        }
+#if FINGERPRINT_HANDOFF_INDEXED_NOTIFY
+    ulTaskNotifyTakeIndexed(FINGERPRINT_HANDOFF_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+#else
+    if (_handoffSignal != nullptr) {
+        xSemaphoreTake(_handoffSignal, pdMS_TO_TICKS(timeout_ms));
+    } else {
+        vTaskDelay(1);
     }
-    
-    return false;
+#endif
 }
+#endif
 
-// 清理过期的解析包 / Clean up expired parsed packets
-void M5UnitFingerprint2::cleanupExpiredPackets()
+// 等待解析器交付，超时后在锁内撤销等待 / Wait for the parser to deliver; on timeout withdraw the wait under the lock
+bool M5UnitFingerprint2::awaitHandoff(unsigned long startTime, uint32_t timeout_ms, const volatile unsigned long* activity)
 {
-    const unsigned long PACKET_TIMEOUT_MS = 5000; // 5秒超时 / 5 second timeout
-    unsigned long currentTime = millis();
-    
-    acquireMutex();
-    
-    size_t validPackets = 0;
-    for (size_t i = 0; i < _parsedPacketCount; i++) {
-        if (currentTime - _parsedPackets[i].timestamp < PACKET_TIMEOUT_MS) {
-            if (validPackets != i) {
-                _parsedPackets[validPackets] = _parsedPackets[i];
-            }
-            validPackets++;
+    while (_handoff.load(std::memory_order_acquire) != HANDOFF_DELIVERED) {
+        if (activity != nullptr) {
+            startTime = *activity;
         }
+        unsigned long elapsed = millis() - startTime;
+        if (elapsed >= timeout_ms) {
+            // 与交付互斥：解析器只在持锁时交付 / Exclusive with delivery: the parser only delivers while holding the lock
+            acquireMutex();
+            bool delivered = (_handoff.load(std::memory_order_relaxed) == HANDOFF_DELIVERED);
+            _handoffView   = nullptr;
+            _handoff.store(HANDOFF_IDLE, std::memory_order_release);
+            releaseMutex();
+            return delivered;
+        }
+        waitResponseEvent(timeout_ms - elapsed);
     }
-    
-    if (validPackets != _parsedPacketCount) {
-        _parsedPacketCount = validPackets;
-        _parsedPacketIndex = validPackets % MAX_PARSED_PACKETS;
-#if defined M5_MODULE_DEBUG_SERIAL
-        serialPrintf("Cleaned up expired packets, remaining: %d\r\n", _parsedPacketCount);
-#endif
+
+    // 从解析出校验和字节到本任务被唤醒 / From the checksum byte being parsed to this task waking up
+    // 同一时刻只有一个等待者写入，无需加锁 / Only one waiter writes at a time, so no lock is needed
+    uint32_t latency = static_cast<uint32_t>(micros()) - _handoffStamp;
+    _handoffCount.fetch_add(1, std::memory_order_relaxed);
+    _handoffLatencyLastUs.store(latency, std::memory_order_relaxed);
+    _handoffLatencyTotalUs.fetch_add(latency, std::memory_order_relaxed);
+    if (latency > _handoffLatencyMaxUs.load(std::memory_order_relaxed)) {
+        _handoffLatencyMaxUs.store(latency, std::memory_order_relaxed);
     }
-    
-    releaseMutex();
+    _handoff.store(HANDOFF_IDLE, std::memory_order_release);
+    return true;
 }
 
-// 尝试解析完整的数据包 / Try to parse complete packet
-bool M5UnitFingerprint2::tryParsePacket()
+// 由解析器调用，把包放入等待者的视图后再通知 / Called by the parser; places the packet in the waiter's view, then notifies
+void M5UnitFingerprint2::deliverHandoff()
 {
-    if (_recvIndex < 9) {  // 最小包头长度 / Minimum packet header length
-        return false;
+    if (_handoff.load(std::memory_order_acquire) != HANDOFF_WAITING) {
+        return;
     }
-
-    // 查找起始码 / Find start code
-    size_t startPos = 0;
-    bool foundStart = false;
-    for (size_t i = 0; i <= _recvIndex - 2; i++) {
-        uint16_t startCode = (_recvBuffer[i] << 8) | _recvBuffer[i + 1];
-        if (startCode == FINGERPRINT_STARTCODE) {
-            startPos   = i;
-            foundStart = true;
-            break;
+    // 取出的包可能早于最近一帧到达，延迟从它自己解析完成时算起 / The claimed packet may predate the latest frame, so the latency counts from its own parse time
+    if (_handoffView != nullptr) {
+        if (!claimResponse(*_handoffView)) {
+            return;
         }
+        _handoffStamp = _parsedPackets.slot(_handoffView->_slot).stampUs;
+    } else if (_dataSink.state < FINGERPRINT_SINK_DONE) {
+        return;
+    } else {
+        _handoffStamp = _frameStamp;
     }
 
-    if (!foundStart) {
-        // 没有找到起始码，清空缓冲区 / No start code found, clear buffer
-        _recvIndex = 0;
+    _handoffView = nullptr;
+    _handoff.store(HANDOFF_DELIVERED, std::memory_order_release);
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    raiseHandoffSignal();
+#endif
+}
+
+// 取出最早的包作为响应 / Claim the oldest packet as a response
+bool M5UnitFingerprint2::claimResponse(Fingerprint_PacketView& view)
+{
+    if (!claimPacket(view)) {
         return false;
     }
-
-    // 如果起始码不在开头，移动数据 / If start code is not at beginning, move data
-    if (startPos > 0) {
-        memmove(_recvBuffer, _recvBuffer + startPos, _recvIndex - startPos);
-        _recvIndex -= startPos;
+    // 命令已得到应答，之后等待数据包超时不再留墓碑 / The command has its acknowledge; a later timeout waiting for data packets leaves no tombstone
+    if (view.get_type() == FINGERPRINT_PACKET_ACKPACKET) {
+        _lastCommand = 0;
     }
+    return true;
+}
 
-    // 检查是否有足够的数据解析包头 / Check if there's enough data to parse packet header
-    if (_recvIndex < 9) {
-        return false;
+// 将解析好的包添加到解析队列 / Add parsed packet to parse queue
+void M5UnitFingerprint2::addParsedPacket(const uint8_t* packetData, size_t packetLength)
+{
+    if (packetLength > FINGERPRINT_MAX_FRAME_SIZE) {
+        serialPrintf("Packet too large: %d bytes\r\n", packetLength);
+        return;
     }
 
-    // 解析包长度 / Parse packet length
-    uint16_t dataLength    = (_recvBuffer[7] << 8) | _recvBuffer[8];
-    size_t totalPacketSize = 9 + dataLength;
+    // 按包类型放入对应通道，队列满时淘汰最早到达的包 / Put into the lane for its type; when full the earliest arrival is evicted
+    if (!_parsedPackets.push(packetData, packetLength, millis(), _frameStamp)) {
+#if defined M5_MODULE_DEBUG_SERIAL
+        serialPrintf("Ignored packet type 0x%02X\r\n", packetData[6]);
+#endif
+    }
+}
 
-    // 检查是否接收到完整的数据包 / Check if complete packet is received
-    if (_recvIndex < totalPacketSize) {
+// 从解析队列中取出最早到达的包，以视图引用 / Claim the earliest-arrived packet from the parse queue as a view
+bool M5UnitFingerprint2::claimPacket(Fingerprint_PacketView& view)
+{
+    // 取所有通道中最早到达的包（O(1)），包保留在槽位中 / Take the earliest arrival across all lanes (O(1)); the packet stays in its slot
+    uint16_t slot = _parsedPackets.claim(FINGERPRINT_LANE_ANY);
+    if (slot == Fingerprint_PacketQueue<MAX_PARSED_PACKETS>::INVALID_INDEX) {
         return false;
     }
 
-    // 构建数据包 / Build data packet
-    uint32_t address    = (_recvBuffer[2] << 24) | (_recvBuffer[3] << 16) | (_recvBuffer[4] << 8) | _recvBuffer[5];
-    uint8_t type        = _recvBuffer[6];
-    uint8_t* packetData = &_recvBuffer[9];
-    uint16_t actualDataLength = dataLength - 2;  // 减去校验和长度 / Minus checksum length
+    view._owner = this;
+    view._frame = _parsedPackets.slot(slot).data;
+    view._slot  = slot;
+    return true;
+}
+
+// 归还视图持有的槽位 / Return the slot held by a view
+void M5UnitFingerprint2::releasePacketView(uint16_t slot)
+{
+    acquireMutex();
+    _parsedPackets.release(slot);
+    releaseMutex();
+}
 
-    // 验证校验和 / Verify checksum
-    uint16_t receivedChecksum   = (_recvBuffer[totalPacketSize - 2] << 8) | _recvBuffer[totalPacketSize - 1];
-    uint16_t calculatedChecksum = type + dataLength;
-    for (uint16_t i = 0; i < actualDataLength; i++) {
-        calculatedChecksum += packetData[i];
+// 释放视图，归还槽位 / Release view, returning its slot
+void Fingerprint_PacketView::release()
+{
+    if (_owner != nullptr && _frame != nullptr) {
+        _owner->releasePacketView(_slot);
     }
-    calculatedChecksum &= 0xFFFF;
+    _owner = nullptr;
+    _frame = nullptr;
+}
 
-    if (receivedChecksum != calculatedChecksum) {
-        serialPrintln("Checksum mismatch");
-        _recvIndex = 0;
-        return false;
+// 清理过期的解析包，返回距下一个包过期的时间 / Clean up expired parsed packets, returning the time until the next one expires
+uint32_t M5UnitFingerprint2::cleanupExpiredPackets()
+{
+    acquireMutex();
+
+    // 各通道按过期时间排列，只需检查队首 / Lanes are in deadline order, so only the heads are checked
+    unsigned long now = millis();
+    size_t removed    = _parsedPackets.expire(now);
+    if (removed > 0) {
+#if defined M5_MODULE_DEBUG_SERIAL
+        serialPrintf("Expired %d unclaimed packets, remaining: %d\r\n", removed, _parsedPackets.size());
+#endif
     }
+    uint32_t wait = _parsedPackets.nextExpiry(now);
 
-    // 构建响应包 / Build response packet
-    *_expectedPacket = Fingerprint_Packet(FINGERPRINT_STARTCODE, address, type, packetData, actualDataLength);
+    releaseMutex();
+    return wait;
+}
 
-    // serialPrintf("Parsed complete packet, type: 0x%02X, data length: %d\r\n",
-    //             type, actualDataLength);
+// 设置通道包生存时间 / Set lane packet lifetime
+void M5UnitFingerprint2::setPacketLifetime(fingerprint_lane_t lane, uint32_t lifetime_ms)
+{
+    acquireMutex();
+    _parsedPackets.setLifetime(lane, lifetime_ms);
+    releaseMutex();
 
-    // 移除已处理的数据包 / Remove processed packet
-    if (_recvIndex > totalPacketSize) {
-        memmove(_recvBuffer, _recvBuffer + totalPacketSize, _recvIndex - totalPacketSize);
-        _recvIndex -= totalPacketSize;
-    } else {
-        _recvIndex = 0;
+    // 唤醒解析任务，按新的生存时间重新计算过期时间 / Wake the parse task to recompute the next deadline with the new lifetime
+    _expiryChanged.store(true, std::memory_order_relaxed);
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    if (parseTaskHandle != nullptr) {
+        xTaskNotifyGive(parseTaskHandle);
     }
+#endif
+}
 
-    return true;
+// 获取通道包生存时间 / Get lane packet lifetime
+uint32_t M5UnitFingerprint2::getPacketLifetime(fingerprint_lane_t lane) const
+{
+    return _parsedPackets.lifetime(lane);
 }
 
-// 初始化模块 / Initialize module
+// 以默认的解析任务配置初始化模块 / Initialize the module with the default parse task configuration
 bool M5UnitFingerprint2::begin()
 {
+    return begin(fingerprint_task_config_t());
+}
+
+// 初始化模块 / Initialize module
+bool M5UnitFingerprint2::begin(const fingerprint_task_config_t& taskConfig)
+{
+    _taskConfig = taskConfig;
+
 #if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
     // 创建互斥锁 / Create mutex lock
     if (mutexLock == NULL) {
@@ -556,72 +809,76 @@ bool M5UnitFingerprint2::begin()
             serialPrintln("Mutex lock created successfully.");
         }
     }
+    if (txMutexLock == NULL) {
+        txMutexLock = xSemaphoreCreateMutex();
+        if (txMutexLock == NULL) {
+            serialPrintln("Failed to create send mutex lock.");
+            return false;
+        }
+    }
 
     // 获取互斥锁 / Acquire mutex lock
     acquireMutex();
 
-    // Arduino 平台串口初始化 / Arduino platform serial initialization
-    if (_serialPort != nullptr) {
-        // 检查串口是否已经初始化且波特率为115200 / Check if serial port is already initialized at 115200 baud rate
-        bool needsInitialization = true;
-
-        // 尝试检查当前波特率（ESP32平台支持） / Try to check current baud rate (supported on ESP32 platform)
-#if defined(ESP32)
-        // ESP32可以检查串口状态 / ESP32 can check serial port status
-        if (_serialPort->baudRate() == 115200) {
-            needsInitialization = false;
-            serialPrintln("Serial port already initialized at 115200 baud rate, skipping initialization.");
-        }
-#endif
-
-        if (needsInitialization) {
-            // 配置UART引脚（如果提供了有效的引脚号） / Configure UART pins (if valid pin numbers are provided)
-            if (_txPin != -1 && _rxPin != -1) {
-                _serialPort->begin(115200, SERIAL_8N1, _rxPin, _txPin);  // 设置波特率和引脚 / Set baud rate and pins
-                serialPrintf("Arduino serial port initialized with TX pin %d, RX pin %d, baud rate 115200.\r\n", _txPin,
-                             _rxPin);
-            } else {
-                _serialPort->begin(115200);  // 使用默认引脚设置波特率为115200 / Use default pins, set baud rate to 115200
-                serialPrintln("Arduino serial port initialized with default pins, baud rate 115200.");
-            }
-        } else {
-            // 串口已初始化，但仍需要检查引脚配置 / Serial port already initialized, but still need to check pin configuration
-            if (_txPin != -1 && _rxPin != -1) {
-                // 如果需要特定引脚，重新配置 / If specific pins are needed, reconfigure
-                _serialPort->end();                                      // 先关闭当前配置 / First close current configuration
-                _serialPort->begin(115200, SERIAL_8N1, _rxPin, _txPin);  // 重新设置引脚 / Reset pins
-                serialPrintf("Serial port reconfigured with TX pin %d, RX pin %d.\r\n", _txPin, _rxPin);
-            } else {
-                serialPrintln("Serial port already configured, using existing pin configuration.");
-            }
+    // 打开传输（Arduino 平台上配置串口） / Open the transport (configures the serial port on Arduino)
+    if (_transport != nullptr) {
+        if (!_transport->begin()) {
+            serialPrintln("Failed to open transport.");
+            releaseMutex();
+            return false;
         }
 
-        _serialPort->setTimeout(1000);
-
-        // 创建数据队列 / Create data queue
-        if (dataQueue == nullptr) {
-            dataQueue = xQueueCreate(10, sizeof(uint8_t) * 256);
-            if (dataQueue == nullptr) {
-                serialPrintln("Failed to create data queue.");
+        // 重新初始化前收到的半帧不能与之后的数据拼在一起 / A partial frame received before re-initialization must not be joined with later data
+        resetReceiveLocked();
+
+        // 创建本实例的数据解析任务；内联模式下由应用调用 update() / Create this instance's data parsing task; in inline mode the application calls update() instead
+        if (!_taskConfig.useTask) {
+            serialPrintln("Inline mode: no parse task, call update() from the application loop.");
+        } else if (parseTaskHandle == nullptr) {
+#if defined(ARDUINO_ARCH_ESP32)
+            BaseType_t core = (_taskConfig.core < 0) ? tskNO_AFFINITY : _taskConfig.core;
+            xTaskCreatePinnedToCore(parseDataTask, "ParseDataTask", _taskConfig.stackSize, this, _taskConfig.priority,
+                                    &parseTaskHandle, core);
+#else
+            xTaskCreate(parseDataTask, "ParseDataTask", _taskConfig.stackSize, this, _taskConfig.priority,
+                        &parseTaskHandle);
+#endif
+            if (parseTaskHandle == nullptr) {
+                serialPrintln("Failed to create parse task.");
                 releaseMutex();
                 return false;
             }
         }
 
-        // 创建数据解析任务 / Create data parsing task
-        if (parseTaskHandle == nullptr) {
-            xTaskCreate(parseDataTask, "ParseDataTask", 8096, this, 5, &parseTaskHandle);
-            if (parseTaskHandle == nullptr) {
-                serialPrintln("Failed to create parse task.");
-                releaseMutex();
-                return false;
+        // 由 RX FIFO 阈值或接收超时事件唤醒解析任务，空闲时不再轮询 / Wake the parse task on RX FIFO threshold or RX timeout events instead of polling while idle
+        if (parseTaskHandle != nullptr) {
+            _eventDrivenRx = _transport->setReceiveCallback(onTransportReceive, this);
+            if (_eventDrivenRx) {
+                serialPrintln("Event-driven serial reception enabled.");
             }
         }
     }
 
     // 释放互斥锁 / Release mutex lock
     releaseMutex();
+#else
+    // 原生平台没有解析任务，等待响应时在调用线程内解析 / No parse task on native platforms; responses are parsed in the calling thread while waiting
+    if (_transport == nullptr || !_transport->begin()) {
+        serialPrintln("Failed to open transport.");
+        return false;
+    }
 
+    // 重新初始化前收到的半帧不能与之后的数据拼在一起 / A partial frame received before re-initialization must not be joined with later data
+    acquireMutex();
+    resetReceiveLocked();
+    releaseMutex();
+#endif
+
+#if FINGERPRINT_QUERY_PACKET_SIZE_AT_BEGIN
+    // 读取并缓存模组的包大小；模组未响应时留到第一次批量传输 / Read and cache the module's packet size; if the module does not answer, this is left to the first bulk transfer
+    if (_transferProfile != FINGERPRINT_TRANSFER_AS_CONFIGURED) {
+        refreshPacketSize();
+    }
 #endif
 
     serialPrintln("M5UnitFingerprint2 initialized successfully.");
@@ -631,15 +888,56 @@ bool M5UnitFingerprint2::begin()
 // 发送数据包 / Send packet data
 bool M5UnitFingerprint2::sendPacketData(const Fingerprint_Packet& packet)
 {
+    // 先取发送锁再取 RX 锁：命令按记录的顺序写出 / Take the send lock before the RX lock, so commands are written in the order they are recorded
+    acquireTxMutex();
+    if (packet.get_type() == FINGERPRINT_PACKET_COMMANDPACKET) {
+        acquireMutex();
+        beginCommandLocked(packet.get_data()[0]);
+        releaseMutex();
+    }
+    bool written = writePacketLocked(packet);
+    releaseTxMutex();
+    return written;
+}
+
+// 发送编码好的命令帧 / Send an encoded command frame
+bool M5UnitFingerprint2::sendCommandFrame(const uint8_t* frame, size_t length)
+{
+    acquireTxMutex();
     acquireMutex();
+    beginCommandLocked(frame[FINGERPRINT_PACKET_HEADER_SIZE]);
+    releaseMutex();
+    bool written = writeBytesLocked(frame, length);
+    releaseTxMutex();
+    return written;
+}
 
+// 记录即将发送的阻塞命令 / Record a blocking command about to be sent
+void M5UnitFingerprint2::beginCommandLocked(uint8_t command)
+{
+    // 新命令发出前仍未取走的包不可能属于它 / Packets still unclaimed before a new command is sent cannot belong to it
+    while (_parsedPackets.size(FINGERPRINT_LANE_ACK) > 0) {
+        _parsedPackets.pop(FINGERPRINT_LANE_ACK);
+        _staleReplies++;
+    }
+    while (_parsedPackets.size(FINGERPRINT_LANE_DATA) > 0) {
+        _parsedPackets.pop(FINGERPRINT_LANE_DATA);
+        _staleReplies++;
+    }
+    sendSyncProbeLocked();
+    _lastCommand    = command;
+    _lastCommandSeq = nextCommandSequence();
+}
+
+// 序列化并写出数据包，不获取 RX 锁，写出不受解析影响 / Serialize and write out a packet without the RX lock, so writes are not held up by parsing
+bool M5UnitFingerprint2::writePacketLocked(const Fingerprint_Packet& packet)
+{
     // 构建要发送的数据 / Build data to send
-    uint8_t sendBuffer[FINGERPRINT_MAX_PACKET_SIZE + 10];  // 额外空间用于包头 / Extra space for packet header
+    uint8_t sendBuffer[FINGERPRINT_PACKET_HEADER_SIZE + FINGERPRINT_MAX_PACKET_SIZE + 2];  // 包头 + 数据 + 校验和 / Header + data + checksum
 
     // 使用 Fingerprint_Packet 的序列化方法 / Use Fingerprint_Packet serialization method
     size_t packetSize = packet.serialize(sendBuffer, sizeof(sendBuffer));
     if (packetSize == 0) {
-        releaseMutex();
         serialPrintln("Failed to serialize packet");
         return false;
     }
@@ -657,8 +955,7 @@ bool M5UnitFingerprint2::sendPacketData(const Fingerprint_Packet& packet)
 
     // 发送数据 / Send data
     size_t bytesWritten = writeSerial(sendBuffer, packetSize);
-
-    releaseMutex();
+    _bytesSent += bytesWritten;
 
 #if defined M5_MODULE_DEBUG_SERIAL
     serialPrintf("Sent %d bytes", bytesWritten);
@@ -694,94 +991,118 @@ bool M5UnitFingerprint2::sendPacketData(const Fingerprint_Packet& packet)
     return (bytesWritten == packetSize);
 }
 
-// 接收数据包 - 使用新的解析队列机制 / Receive packet data - using new parse queue mechanism
-bool M5UnitFingerprint2::receivePacketData(Fingerprint_Packet& packet, uint32_t timeout_ms)
+// 原样写出编码好的帧 / Write out an encoded frame as is
+bool M5UnitFingerprint2::writeBytesLocked(const uint8_t* frame, size_t length)
 {
-    acquireMutex();
+#if defined M5_MODULE_DEBUG_SERIAL && M5_MODULE_DEBUG_SERIAL_ENABLED
+    FingerprintDebugUtils::printPacketHex("TX: ", frame, length);
+#endif
+    size_t bytesWritten = writeSerial(frame, length);
+    _bytesSent += bytesWritten;
 
-    // 设置等待状态 / Set waiting state
-    _waitingForResponse = true;
-    _packetReceived = false;
-    _expectedPacket = &packet;
+    serialPrintf("Sent %d bytes (command 0x%02X)\r\n", bytesWritten, frame[FINGERPRINT_PACKET_HEADER_SIZE]);
+    return (bytesWritten == length);
+}
 
-    releaseMutex();
+// 写出包头、短参数与原地的负载，边写边累加校验和 / Write the header, the short head and the payload in place, summing the checksum on the way
+bool M5UnitFingerprint2::writeFrameLocked(uint8_t type, const uint8_t* head, uint8_t headLength,
+                                          const uint8_t* payload, uint16_t payloadLength)
+{
+    uint8_t frameHead[FINGERPRINT_PACKET_HEADER_SIZE + 8];
+    uint32_t dataLength = static_cast<uint32_t>(headLength) + payloadLength;
+    if (headLength > 8 || dataLength > FINGERPRINT_MAX_PACKET_SIZE) {
+        serialPrintln("Failed to serialize packet");
+        return false;
+    }
 
-#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
-    // 创建响应信号量（如果还没有创建） / Create response semaphore (if not created yet)
-    if (responseSemaphore == nullptr) {
-        responseSemaphore = xSemaphoreCreateBinary();
-        if (responseSemaphore == nullptr) {
-            serialPrintln("Failed to create response semaphore");
-            _waitingForResponse = false;
-            return false;
-        }
+    // 包长度 = 数据长度 + 校验和(2字节) / Packet length = data length + checksum (2 bytes)
+    uint16_t packetLength = static_cast<uint16_t>(dataLength + 2);
+    frameHead[0]          = (FINGERPRINT_STARTCODE >> 8) & 0xFF;
+    frameHead[1]          = FINGERPRINT_STARTCODE & 0xFF;
+    frameHead[2]          = (_fp2_address >> 24) & 0xFF;
+    frameHead[3]          = (_fp2_address >> 16) & 0xFF;
+    frameHead[4]          = (_fp2_address >> 8) & 0xFF;
+    frameHead[5]          = _fp2_address & 0xFF;
+    frameHead[6]          = type;
+    frameHead[7]          = (packetLength >> 8) & 0xFF;
+    frameHead[8]          = packetLength & 0xFF;
+
+    uint16_t sum = type + frameHead[7] + frameHead[8];
+    for (uint8_t i = 0; i < headLength; i++) {
+        frameHead[FINGERPRINT_PACKET_HEADER_SIZE + i] = head[i];
+        sum += head[i];
+    }
+    for (uint16_t i = 0; i < payloadLength; i++) {
+        sum += payload[i];
     }
+    uint8_t checksum[2] = {static_cast<uint8_t>(sum >> 8), static_cast<uint8_t>(sum & 0xFF)};
 
-    // 等待响应信号量 / Wait for response semaphore
-    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
-    if (xSemaphoreTake(responseSemaphore, timeout_ticks) == pdTRUE) {
-        // 成功接收到响应 / Successfully received response
-        acquireMutex();
-        bool success = _packetReceived;
-        
-        _waitingForResponse = false;
-        _expectedPacket = nullptr;
+    // 负载直接从调用者的缓冲区写入传输 / The payload goes from the caller's buffer straight to the transport
+    size_t expected     = FINGERPRINT_PACKET_HEADER_SIZE + dataLength + 2;
+    size_t bytesWritten = writeSerial(frameHead, FINGERPRINT_PACKET_HEADER_SIZE + headLength);
+    if (payloadLength > 0) {
+        bytesWritten += writeSerial(payload, payloadLength);
+    }
+    bytesWritten += writeSerial(checksum, sizeof(checksum));
+    _bytesSent += bytesWritten;
+
+    serialPrintf("Sent %d bytes (type 0x%02X, %d payload bytes in place)\r\n", bytesWritten, type, payloadLength);
+    return (bytesWritten == expected);
+}
+
+// 接收数据包 - 使用新的解析队列机制，以视图返回不拷贝 / Receive packet data - using new parse queue mechanism, returned as a view without copying
+bool M5UnitFingerprint2::receivePacketData(Fingerprint_PacketView& view, uint32_t timeout_ms)
+{
+    view.release();
+
+    unsigned long startTime = millis();
+    acquireMutex();
+
+    // 数据包可能在开始等待之前已经解析完成（例如连续的数据包），因此先检查队列 / The packet may already be parsed before waiting starts (e.g. back-to-back data packets), so check the queue first
+    bool claimed = claimResponse(view);
+    if (!claimed && !beginHandoff(&view)) {
         releaseMutex();
+        serialPrintln("Another task is already waiting for a response");
+        return false;
+    }
+    releaseMutex();
 
-        if (success) {
-#if defined M5_MODULE_DEBUG_SERIAL
-#if M5_MODULE_COMMAND_PARSING_ENABLED
-            serialPrintln("=== RECEIVED PACKET ===");
-            FingerprintDebugUtils::printPacketStructure("RX ", packet);
-            serialPrintln("Successfully received response packet");
-#endif
-#endif
-            return true;
-        } else {
-            serialPrintln("Response received but parsing failed");
-            return false;
-        }
-    } else {
-        // 超时 / Timeout
+    // 解析器直接把包放入 view / The parser places the packet straight into view
+    if (!claimed && !awaitHandoff(startTime, timeout_ms)) {
+        // 超时，为仍在等待应答的命令留下墓碑 / Timeout; leave a tombstone for the command still awaiting its acknowledge
         acquireMutex();
-        _waitingForResponse = false;
-        _expectedPacket = nullptr;
+        if (_lastCommand != 0) {
+            retireCommand(_lastCommand, _lastCommandSeq);
+            _lastCommand = 0;
+        }
         releaseMutex();
-
         serialPrintln("Timeout waiting for response packet");
         return false;
     }
-#else
-    // 非 FreeRTOS 平台，使用简单的轮询 / Non-FreeRTOS platform, use simple polling
-    unsigned long startTime = millis();
-    while (millis() - startTime < timeout_ms) {
-        // 主动检查解析队列 / Actively check parse queue
-        acquireMutex();
-        if (getMatchingPacket(packet)) {
-            _waitingForResponse = false;
-            _expectedPacket = nullptr;
-            _packetReceived = true;
-            releaseMutex();
-            
+
 #if defined M5_MODULE_DEBUG_SERIAL
-            serialPrintln("=== RECEIVED PACKET ===");
 #if M5_MODULE_COMMAND_PARSING_ENABLED
-            FingerprintDebugUtils::printPacketStructure("RX ", packet);
+    serialPrintln("=== RECEIVED PACKET ===");
+    FingerprintDebugUtils::printPacketStructure(
+        "RX ", Fingerprint_Packet(view.get_start_code(), view.get_address(), view.get_type(), view.get_data(),
+                                  view.get_actual_data_length()));
+    serialPrintln("Successfully received response packet");
 #endif
-            serialPrintln("Successfully received response packet");
 #endif
-            return true;
-        }
-        releaseMutex();
-        
-        delay(1);
+    return true;
+}
+
+// 接收数据包并拷贝到 Fingerprint_Packet / Receive packet data and copy it into a Fingerprint_Packet
+bool M5UnitFingerprint2::receivePacketData(Fingerprint_Packet& packet, uint32_t timeout_ms)
+{
+    Fingerprint_PacketView view;
+    if (!receivePacketData(view, timeout_ms)) {
+        return false;
     }
 
-    _waitingForResponse = false;
-    _expectedPacket = nullptr;
-    serialPrintln("Timeout waiting for response packet");
-    return false;
-#endif
+    packet = Fingerprint_Packet(view.get_start_code(), view.get_address(), view.get_type(), view.get_data(),
+                                view.get_actual_data_length());
+    return true;
 }
 
 // 设置唤醒回调函数 / Set wakeup callback function
@@ -817,6 +1138,14 @@ bool M5UnitFingerprint2::handleWakeupPacket(const uint8_t* packetData, size_t pa
         }
     }
     
+    // 模组重新上电，包大小寄存器恢复为存储值，缓存失效 / The module powered up again and its packet size register is back to the stored value, so the cache is stale
+    _packetSize.store(FINGERPRINT_PACKET_SIZE_UNKNOWN);
+    // 重新上电后固件可能已更新，下一次上传重新读取版本 / The firmware may have been updated across the power cycle, so the next upload reads the version again
+    _firmwareVersion.store(FINGERPRINT_FIRMWARE_VERSION_UNKNOWN);
+    // 重新上电前发出的命令都不会再应答 / Commands sent before the power cycle will never answer
+    _staleCount  = 0;
+    _syncCommand = 0;
+
     // 确认是唤醒包，调用回调函数 / Confirmed as wakeup packet, call callback function
 #if defined M5_MODULE_DEBUG_SERIAL
     serialPrintln("Wakeup packet detected, calling callback function");
@@ -845,7 +1174,11 @@ void M5UnitFingerprint2::defaultWakeupCallback(const uint8_t* wakeupPacket, size
     M5_MODULE_DEBUG_SERIAL.println("");
     serialPrintf("==============================\r\n");
 #else
-    // 如果没有调试串口，仍然可以通过默认串口打印基本信息 / If no debug serial, can still print basic info through default serial
+    // 如果没有调试串口，仍然可以通过默认串口打印基本信息；原生平台上库不写标准输出 / If no debug serial, can still print basic info through default serial; on native platforms the library does not write to stdout
+    (void)wakeupPacket;
+    (void)packetLength;
+#if defined(ARDUINO)
     Serial.println("Fingerprint module wakeup detected!");
 #endif
+#endif
 }
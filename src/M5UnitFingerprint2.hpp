@@ -7,16 +7,31 @@
 #ifndef __M5_UNIT_FINGERPRINT2_H
 #define __M5_UNIT_FINGERPRINT2_H
 
-#include "Arduino.h"
+#include "M5UnitFingerprint2_platform.hpp"
 #include <cstring>
 #include "M5UnitFingerprint2_defs.hpp"
 #include "M5UnitFingerprint2_debug.hpp"
+#include "M5UnitFingerprint2_encoder.hpp"
+#include "M5UnitFingerprint2_framer.hpp"
+#include "M5UnitFingerprint2_ringbuffer.hpp"
+#include "M5UnitFingerprint2_queue.hpp"
+#include "M5UnitFingerprint2_transport.hpp"
 
 #if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
+
+// 任务通知数组足够大时以专用下标交接，否则用二值信号量 / Hand off through a dedicated notification index when the task notification array is large enough, otherwise through a binary semaphore
+#if defined(configTASK_NOTIFICATION_ARRAY_ENTRIES) && (FINGERPRINT_HANDOFF_NOTIFY_INDEX > 0) && \
+    (configTASK_NOTIFICATION_ARRAY_ENTRIES > FINGERPRINT_HANDOFF_NOTIFY_INDEX)
+#define FINGERPRINT_HANDOFF_INDEXED_NOTIFY 1
+#else
+#define FINGERPRINT_HANDOFF_INDEXED_NOTIFY 0
+#endif
+#else
+#include <mutex>
 #endif
 
 class Fingerprint_Packet {
@@ -121,7 +136,7 @@ public:
 private:
     uint16_t calculate_checksum() const {
         // 校验和计算：包标识 + 包长度 + 实际数据内容 / Checksum calculation: packet identifier + packet length + actual data content
-        uint16_t sum = type + data_length;
+        uint16_t sum = type + ((data_length >> 8) & 0xFF) + (data_length & 0xFF); // 包长度按两个字节累加 / The packet length is summed as its two bytes
         for (uint16_t i = 0; i < actual_data_length; ++i) {
             sum += data[i];
         }
@@ -138,6 +153,77 @@ private:
     uint16_t checksum;
 };
 
+class M5UnitFingerprint2;
+class Fingerprint_AutoFlowSession;
+
+/**
+ * @brief 非拥有型数据包视图 / Non-owning packet view
+ *
+ * 直接引用接收队列槽位中的完整帧，不拷贝包内容。访问方法与 Fingerprint_Packet 相同。
+ * 视图持有槽位直到 release() 或析构，期间槽位不会被复用；应尽快释放以免占满接收队列。
+ *
+ * References a complete frame in a receive queue slot without copying the packet contents. Accessors match
+ * Fingerprint_Packet. The view holds the slot until release() or destruction, and the slot is not reused meanwhile;
+ * release it promptly so the receive queue does not fill up.
+ */
+class Fingerprint_PacketView {
+public:
+    Fingerprint_PacketView() = default;
+    ~Fingerprint_PacketView() { release(); }
+
+    Fingerprint_PacketView(const Fingerprint_PacketView&) = delete;
+    Fingerprint_PacketView& operator=(const Fingerprint_PacketView&) = delete;
+
+    Fingerprint_PacketView(Fingerprint_PacketView&& other) noexcept
+        : _owner(other._owner), _frame(other._frame), _slot(other._slot) {
+        other._owner = nullptr;
+        other._frame = nullptr;
+    }
+
+    Fingerprint_PacketView& operator=(Fingerprint_PacketView&& other) noexcept {
+        if (this != &other) {
+            release();
+            _owner       = other._owner;
+            _frame       = other._frame;
+            _slot        = other._slot;
+            other._owner = nullptr;
+            other._frame = nullptr;
+        }
+        return *this;
+    }
+
+    bool is_valid() const { return _frame != nullptr; }
+    uint16_t get_start_code() const { return _frame ? static_cast<uint16_t>((_frame[0] << 8) | _frame[1]) : 0; }
+    uint32_t get_address() const {
+        return _frame ? (static_cast<uint32_t>(_frame[2]) << 24) |
+                        (static_cast<uint32_t>(_frame[3]) << 16) |
+                        (static_cast<uint32_t>(_frame[4]) << 8) |
+                        static_cast<uint32_t>(_frame[5])
+                      : 0;
+    }
+    uint8_t get_type() const { return _frame ? _frame[6] : 0; }
+    uint16_t get_data_length() const { return _frame ? static_cast<uint16_t>((_frame[7] << 8) | _frame[8]) : 0; } // 包长度（含校验和） / Packet length (including checksum)
+    uint16_t get_actual_data_length() const { return _frame ? get_data_length() - 2 : 0; } // 实际数据长度 / Actual data length
+    uint16_t get_packet_size() const { return _frame ? FINGERPRINT_PACKET_HEADER_SIZE + get_data_length() : 0; } // 整个数据包的大小 / Total packet size
+    const uint8_t* get_data() const { return _frame ? &_frame[FINGERPRINT_PACKET_HEADER_SIZE] : nullptr; }
+    uint16_t get_checksum() const {
+        return _frame ? static_cast<uint16_t>((_frame[get_packet_size() - 2] << 8) | _frame[get_packet_size() - 1]) : 0;
+    }
+    const uint8_t* get_frame() const { return _frame; } // 完整帧（起始码到校验和） / Complete frame (start code to checksum)
+
+    /**
+     * @brief 释放所引用的槽位，之后视图无效 / Release the referenced slot, the view is invalid afterwards
+     */
+    void release();
+
+private:
+    friend class M5UnitFingerprint2;
+
+    M5UnitFingerprint2* _owner = nullptr;
+    const uint8_t* _frame      = nullptr;
+    uint16_t _slot             = 0;
+};
+
 
 typedef enum {
     FINGERPRINT_LED_BREATHING = 1,  // 普通呼吸灯 / Normal breathing light
@@ -252,7 +338,21 @@ public:
      * @param rxPin The RX pin number for serial communication (default: -1, use default pin).
      * @param address The address for the fingerprint module (default: 0xFFFFFFFF).
      */
+#if defined(ARDUINO)
     M5UnitFingerprint2(HardwareSerial* serialPort = nullptr, int txPin = -1, int rxPin = -1, uint32_t address = 0xFFFFFFFF);
+#endif
+
+    /**
+     * @brief Constructs a new M5UnitFingerprint2 object on top of a transport.
+     *
+     * The protocol engine only talks to the module through the transport, so the same
+     * engine runs over Arduino HardwareSerial, a Linux serial device (Fingerprint_TermiosTransport)
+     * or a loopback (Fingerprint_PtyTransport, Fingerprint_FdTransport::createSocketPair()).
+     * The transport must outlive this object; begin() calls its begin().
+     * @param transport The transport to use for communication.
+     * @param address The address for the fingerprint module (default: 0xFFFFFFFF).
+     */
+    explicit M5UnitFingerprint2(Fingerprint_Transport* transport, uint32_t address = 0xFFFFFFFF);
 
 
 
@@ -273,12 +373,36 @@ public:
      */
     bool begin();
 
+    /**
+     * @brief Initializes the module with an explicit parse task configuration.
+     *
+     * On ESP32 the parse task can be pinned to a core (e.g. core 1, away from Wi-Fi) and given its own
+     * priority and stack size. With useTask set to false no task is created at all (inline mode): the
+     * application drives reception by calling update() from its own loop, and blocking PS_* calls
+     * parse responses in the calling task while they wait. Native platforms never create a task.
+     *
+     * @param taskConfig Parse task configuration.
+     * @return true if initialization succeeded, false if any step failed.
+     */
+    bool begin(const fingerprint_task_config_t& taskConfig);
+
+    /**
+     * @brief Runs one pass of the parse task in the calling task (inline mode).
+     *
+     * Reads and parses arrived data, expires unclaimed packets and advances asynchronous commands
+     * and auto flow sessions. Never blocks.
+     *
+     * @return Milliseconds until the next deadline (packet expiry, command or session timeout), or
+     *         UINT32_MAX if there is none; the caller may sleep that long when no data arrives.
+     */
+    uint32_t update();
+
     /**
      * @brief Reads data from the serial port.
      *
-     * This function reads data from the configured serial port (Arduino HardwareSerial)
-     * and stores it in the provided buffer. The function is platform-aware and uses the appropriate
-     * serial interface based on the platform configuration.
+     * This function reads data from the configured transport and stores it in the provided
+     * buffer. Data is read with a single block read sized to the bytes currently available,
+     * so it never blocks waiting for more.
      * @param buffer The buffer to store the read data.
      * @param length The maximum number of bytes to read.
      * @return The number of bytes actually read (0 if no data available or error).
@@ -288,8 +412,7 @@ public:
     /**
      * @brief Writes data to the serial port.
      *
-     * This function writes data to the configured serial port (Arduino HardwareSerial).
-     * The function is platform-aware and uses the appropriate serial interface based on the platform configuration.
+     * This function writes data to the configured transport.
      * @param buffer The buffer containing the data to write.
      * @param length The number of bytes to write.
      * @return The number of bytes actually written (0 if error occurred).
@@ -325,6 +448,215 @@ public:
      *                             nullptr meaning the default will be used.
      */
     PS_WakeupCallback_t getWakeupCallback() const;
+
+    /**
+     * @brief Get receive path statistics.
+     *
+     * Reports bytes read from the serial port, how often the receive ring was
+     * full (data is then left in the UART driver buffer until the framer catches
+     * up, instead of being discarded), the ring high watermark, and framer
+     * counters for parsed frames, checksum errors and bytes dropped while
+     * resynchronizing, plus packets evicted from a full parse queue and packets
+     * that expired without being claimed. The handoff counters measure the time
+     * from the checksum byte being parsed to the waiting caller waking up.
+     *
+     * @param stats Structure that receives the statistics.
+     */
+    void getReceiveStats(fingerprint_rx_stats_t& stats) const;
+
+    /**
+     * @brief Sets how long unclaimed packets of a lane stay in the parse queue.
+     *
+     * FINGERPRINT_LANE_ACK covers acknowledge packets, FINGERPRINT_LANE_DATA covers
+     * data and end-of-data packets. Defaults are FINGERPRINT_ACK_PACKET_LIFETIME_MS
+     * and FINGERPRINT_DATA_PACKET_LIFETIME_MS.
+     *
+     * @param lane Packet lane.
+     * @param lifetime_ms Lifetime in milliseconds.
+     */
+    void setPacketLifetime(fingerprint_lane_t lane, uint32_t lifetime_ms);
+
+    /**
+     * @brief Gets the lifetime of unclaimed packets of a lane.
+     *
+     * @param lane Packet lane.
+     * @return Lifetime in milliseconds.
+     */
+    uint32_t getPacketLifetime(fingerprint_lane_t lane) const;
+
+    // 传输包大小 / Transfer packet size
+    /**
+     * @brief Sets how bulk transfers (PS_UpImage, PS_ReadINFpage) choose their packet size.
+     *
+     * With FINGERPRINT_TRANSFER_BULK (the default) the packet size register is raised to
+     * FINGERPRINT_BULK_PACKET_SIZE (256 bytes unless FINGERPRINT_RX_MAX_PAYLOAD_SIZE is smaller) before
+     * the transfer and kept there: the module keeps sending data packets of that size, to this host
+     * or any other, until it powers up again or the register is written. FINGERPRINT_TRANSFER_BULK_RESTORE
+     * writes the previous size back afterwards, at the cost of one more register write per transfer.
+     * The active size is cached, so the register is only written when it differs and no query is
+     * needed per transfer.
+     *
+     * @param profile Packet size policy.
+     */
+    void setTransferProfile(fingerprint_transfer_profile_t profile);
+
+    /**
+     * @brief Gets the bulk transfer packet size policy.
+     *
+     * @return Packet size policy.
+     */
+    fingerprint_transfer_profile_t getTransferProfile() const;
+
+    /**
+     * @brief Gets the cached packet size of the module.
+     *
+     * The cache is filled by the first bulk transfer (or in begin() when FINGERPRINT_QUERY_PACKET_SIZE_AT_BEGIN
+     * is 1), by PS_ReadSysPara and
+     * PS_WriteReg(FP_REG_PACKET_SIZE, ...), and cleared when the module sends a wakeup packet,
+     * since the register returns to its stored value on power-up.
+     *
+     * @return FINGERPRINT_PACKET_SIZE_32 ... FINGERPRINT_PACKET_SIZE_256, or FINGERPRINT_PACKET_SIZE_UNKNOWN.
+     */
+    uint8_t getPacketSize() const;
+
+    /**
+     * @brief Sets the packet size register of the module, skipping the write if the cached size already matches.
+     *
+     * @param sizeCode FINGERPRINT_PACKET_SIZE_32 ... FINGERPRINT_PACKET_SIZE_256.
+     * @return FINGERPRINT_OK on success, FINGERPRINT_PARAM_ERROR for an invalid code, otherwise the PS_WriteReg result.
+     */
+    fingerprint_status_t setPacketSize(uint8_t sizeCode);
+
+    /**
+     * @brief Reads the packet size from the module with PS_ReadSysPara and caches it.
+     *
+     * @return The PS_ReadSysPara result.
+     */
+    fingerprint_status_t refreshPacketSize();
+
+    /**
+     * @brief Converts a packet size code to bytes.
+     *
+     * @param sizeCode FINGERPRINT_PACKET_SIZE_32 ... FINGERPRINT_PACKET_SIZE_256.
+     * @return Data bytes per packet.
+     */
+    static uint16_t packetSizeBytes(uint8_t sizeCode) { return static_cast<uint16_t>(32u << (sizeCode & 0x03)); }
+
+    /**
+     * @brief Gets whether the module supports template upload/download (PS_UpChar/PS_DownChar).
+     *
+     * PS_UploadTemplateAuto and PS_DownloadTemplateAuto probe this on their first call: an
+     * acknowledged 08H/09H marks it supported, whatever the confirmation code, and the template then
+     * moves as one command followed by a data packet burst. The invalid-command confirmation code
+     * (FINGERPRINT_CHAR_TRANSFER_INVALID_CODE), or FINGERPRINT_CHAR_TRANSFER_SILENT_LIMIT unanswered
+     * calls in a row, marks it unsupported and the 7AH/7BH chunked path is used from then on. A call
+     * that is not answered falls back to 7AH/7BH either way.
+     *
+     * @return FINGERPRINT_CHAR_TRANSFER_UNKNOWN, _SUPPORTED or _UNSUPPORTED.
+     */
+    fingerprint_char_transfer_t getCharTransferSupport() const;
+
+    /**
+     * @brief Overrides the template upload/download support, e.g. for a known firmware.
+     *
+     * @param support FINGERPRINT_CHAR_TRANSFER_UNKNOWN probes again on the next automatic transfer.
+     */
+    void setCharTransferSupport(fingerprint_char_transfer_t support);
+
+    /**
+     * @brief Gets the 7AH chunk size learned for the current firmware.
+     *
+     * Without 08H support PS_UploadTemplateAuto requests 7AH chunks. The first upload tries
+     * FINGERPRINT_TEMPLATE_CHUNK_MAX, halves it while the module rejects it, and notes a smaller
+     * size the module caps replies at. The result is cached with the firmware version (D7H); later
+     * uploads keep FINGERPRINT_TEMPLATE_PIPELINE_DEPTH requests in flight, so the next reply is already
+     * being sent while the previous one is copied. A wakeup packet makes the next upload read the version again.
+     *
+     * @return Chunk size in bytes, or 0 if not learned yet.
+     */
+    uint16_t getTemplateChunkSize() const;
+
+    /**
+     * @brief Gets the 7BH chunk size learned for the current firmware.
+     *
+     * Without 09H support PS_DownloadTemplateAuto sends 7BH chunks. The first download starts at
+     * FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_START and doubles the chunk after each accepted one, up to
+     * FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX; a rejected chunk is sent again at the last accepted size,
+     * which then stays. The result is cached with the firmware version (D7H) like the 7AH chunk size,
+     * and later downloads keep FINGERPRINT_TEMPLATE_PIPELINE_DEPTH chunks in flight.
+     *
+     * @return Chunk size in bytes, or 0 if not learned yet.
+     */
+    uint16_t getTemplateDownloadChunkSize() const;
+
+    // 异步命令 / Asynchronous commands
+    /**
+     * @brief Submits a command without waiting for its acknowledge packet.
+     *
+     * Commands are sent by priority class and then in submission order, up to
+     * FINGERPRINT_MAX_COMMANDS_IN_FLIGHT at a time. Cancel-class commands jump the queue, ignore
+     * the pipeline depth and have a table entry of their own; background commands wait until no
+     * command is in flight. The module queues them and replies in order, so the parser routes each acknowledge
+     * packet to the earliest sent command after checking its shape, and the caller never blocks
+     * on the response. Late replies to timed-out commands are dropped. Completion is reported through the callback or
+     * collected with pollCommand(). Only commands answered by a single acknowledge packet
+     * with at most FINGERPRINT_ASYNC_PAYLOAD_SIZE bytes are supported (e.g. PS_GetImage,
+     * PS_GenChar, PS_Search, PS_StoreChar, PS_ValidTemplateNum). Do not call blocking PS_*
+     * functions while asynchronous commands are outstanding.
+     *
+     * On FreeRTOS platforms the parse task sends, times out and completes commands. On native
+     * platforms the application drives them by calling processCommands() periodically.
+     *
+     * @param command Command code, e.g. FINGERPRINT_SEARCH.
+     * @param params Command parameters (may be nullptr).
+     * @param paramLength Parameter length, at most FINGERPRINT_ASYNC_PAYLOAD_SIZE.
+     * @param timeout_ms Time to wait for the acknowledge packet after the command is sent (default: 1000ms).
+     * @param callback Completion callback, or nullptr to collect the result with pollCommand().
+     * @param context Context pointer passed to the callback.
+     * @param priority Priority class (default: FINGERPRINT_PRIORITY_INTERACTIVE).
+     * @return Non-zero command handle, or 0 if all FINGERPRINT_MAX_PENDING_COMMANDS entries of the class are in use or the parameters are too long.
+     */
+    uint32_t submitCommand(uint8_t command, const uint8_t* params, uint16_t paramLength, uint32_t timeout_ms = 1000,
+                           PS_CommandCallback_t callback = nullptr, void* context = nullptr,
+                           fingerprint_command_priority_t priority = FINGERPRINT_PRIORITY_INTERACTIVE);
+
+    /**
+     * @brief Polls an asynchronous command submitted without a callback.
+     *
+     * When the command is done its result is copied out and the handle is released, so later
+     * polls return FINGERPRINT_COMMAND_INVALID.
+     *
+     * @param handle Handle returned by submitCommand().
+     * @param status Receives the confirmation code when the command is done.
+     * @param response Optional buffer receiving the acknowledge data following the confirmation code.
+     * @param responseLength In: size of response. Out: acknowledge data length.
+     * @return Current command state.
+     */
+    fingerprint_command_state_t pollCommand(uint32_t handle, fingerprint_status_t& status, uint8_t* response = nullptr,
+                                            uint16_t* responseLength = nullptr);
+
+    /**
+     * @brief Cancels an asynchronous command.
+     *
+     * A queued command is never sent. A command already sent cannot be recalled from the
+     * module; its acknowledge packet is still consumed but the callback is not invoked.
+     *
+     * @param handle Handle returned by submitCommand().
+     * @return true if the handle was pending or done and has been released.
+     */
+    bool cancelCommand(uint32_t handle);
+
+    /**
+     * @brief Advances asynchronous commands.
+     *
+     * Times out commands in flight, invokes completion callbacks outside the mutex and sends
+     * queued commands. Called by the parse task on FreeRTOS platforms; without a parse task (native
+     * platforms, inline mode) it also reads and parses pending transport data, and the application
+     * must call it from a single thread, e.g. its main loop.
+     *
+     * @return Milliseconds until the earliest command in flight times out, or UINT32_MAX if none is in flight.
+     */
+    uint32_t processCommands();
     
     //MCU命令 / MCU commands
     fingerprint_status_t PS_SetSleepTime(uint8_t SleepTime) const;                      //D0H 设置休眠时间 10-254范围 单位：秒 / Set sleep time, range 10-254, unit: seconds
@@ -346,6 +678,10 @@ public:
     fingerprint_status_t PS_RegModel(void) const;                                       //05H 合并特征（生成模板） / Merge characteristics (generate template)
     fingerprint_status_t PS_StoreChar(uint8_t BufferID, uint16_t PageID) const;         //06H 储存模板 输入：BufferID 默认为1，PageID 指纹库的位置号 / Store template, Input: BufferID default 1, PageID fingerprint library location number
     fingerprint_status_t PS_LoadChar(uint8_t BufferID, uint16_t PageID) const;          //07H 读取模板 输入：BufferID 默认为2，PageID:指纹库的模板号 / Read template, Input: BufferID default 2, PageID: fingerprint library template number
+    // ↓ 08H 上传特征 输入：BufferID 特征缓冲区，templateBuffer:模板数据缓冲区，bufferSize:缓冲区大小 返回：actualSize 实际的模板大小 / Upload template, Input: BufferID template buffer, templateBuffer: template data buffer, bufferSize: buffer size, Return: actualSize actual template size
+    fingerprint_status_t PS_UpChar(uint8_t BufferID, uint8_t* templateBuffer, uint32_t bufferSize, uint32_t& actualSize) const;
+    // ↓ 09H 下载特征 输入：BufferID 特征缓冲区，templateData:模板数据，templateSize:模板大小（按包大小拆分为数据包） / Download template, Input: BufferID template buffer, templateData: template data, templateSize: template size (split into data packets of the packet size)
+    fingerprint_status_t PS_DownChar(uint8_t BufferID, const uint8_t* templateData, uint32_t templateSize) const;
     // ↓ 0AH 上传图像 输入：imageBuffer:图像数据缓冲区，bufferSize:缓冲区大小，actualImageSize:实际上传的图像大小 / Upload image, Input: imageBuffer: image data buffer, bufferSize: buffer size, actualImageSize: actual uploaded image size
     fingerprint_status_t PS_UpImage(uint8_t* imageBuffer, uint32_t bufferSize, uint32_t& actualImageSize) const; 
     fingerprint_status_t PS_DeletChar(uint16_t PageID, uint16_t Num) const;             //0CH 删除模板 输入：PageID 指纹库的模板号，Num 删除数量 / Delete template, Input: PageID fingerprint library template number, Num delete quantity
@@ -371,23 +707,27 @@ public:
     fingerprint_status_t PS_SearchNow(uint16_t StartPage, uint16_t PageNum, uint16_t &PageID, uint16_t &MatchScore) const;
     // ↓ 7AH 特殊上传模板 输入：模板偏移地址，指定的上传模板大小 返回：实际的上传模板大小，模板数据  （实际的上传模板大小 小于 指定的上传模板大小 或为0时，即为最后一个包） / Special upload template, Input: template offset address, specified upload template size, Return: actual upload template size, template data (when actual upload template size is less than specified upload template size or 0, it is the last packet)
     fingerprint_status_t PS_UploadTemplate(uint16_t offset, uint16_t uploadSize, uint16_t &actualSize, uint8_t* templateData) const;
-    // ↓ 7AH 特殊上传模板 自动上传函数 输入：模板上传缓冲区，回调函数 返回：模板实际大小 / Special upload template auto upload function, Input: template upload buffer, callback function, Return: template actual size
+    // ↓ 08H/7AH 自动上传模板 输入：模板上传缓冲区，回调函数 返回：模板实际大小；模组支持时用 PS_UpChar 一次传完，否则 7AH 分段 / Auto template upload, Input: template upload buffer, callback function, Return: template actual size; uses PS_UpChar in one transfer when supported, otherwise 7AH chunks
     fingerprint_status_t PS_UploadTemplateAuto(
         uint8_t* templateBuffer,                                            // 上传缓冲区 / Upload buffer
         uint32_t bufferSize,                                                // 缓冲区大小 / Buffer size
         uint32_t& actualSize,                                               // 返回的实际上传大小 / Returned actual upload size
         PS_UploadTemplateCallback_t callback = nullptr                      // 每接收一段数据时的回调 / Callback when receiving each data segment
     ) const;
+    // ↓ 08H/7AH 自动上传模板（计时回调），回调另外收到经过的微秒数，完成时即为整个模板的传输时间 / Auto template upload with a timed callback, which also receives the elapsed microseconds; on completion, the transfer time of the whole template
+    fingerprint_status_t PS_UploadTemplateAuto(uint8_t* templateBuffer, uint32_t bufferSize, uint32_t& actualSize,
+                                               PS_UploadTemplateTimedCallback_t callback, void* context) const;
     // ↓ 7BH 特殊下载模板 输入：模板偏移地址，指定的下载模板大小，模板数据 / Special download template, Input: template offset address, specified download template size, template data
     fingerprint_status_t PS_DownloadTemplate(uint16_t offset, uint16_t downloadSize, const uint8_t* templateData) const;
-    // ↓ 7BH 特殊下载模板 自动下载函数 输入：模板缓冲区，实际下载的模板大小，回调函数 返回：无 / Special download template auto download function, Input: template buffer, actual download template size, callback function, Return: none
+    // ↓ 09H/7BH 自动下载模板 输入：模板缓冲区，实际下载的模板大小，回调函数 返回：无；模组支持时用 PS_DownChar 一次传完，否则 7BH 分段 / Auto template download, Input: template buffer, actual download template size, callback function, Return: none; uses PS_DownChar in one transfer when supported, otherwise 7BH chunks
     fingerprint_status_t PS_DownloadTemplateAuto(
         const uint8_t* templateBuffer,                                      // 模板缓冲区 / Template buffer
         uint32_t actualSize,                                                // 实际下载的模板大小 / Actual download template size
         PS_DownloadTemplateCallback_t callback = nullptr                    // 每发送一段数据时的回调 / Callback when sending each data segment
     ) const;
     // 模块化指令 / Modular commands
-    fingerprint_status_t PS_Cancel(void) const;                             // 30H 取消指令 / Cancel command
+    // ↓ 30H 取消指令，PS_AutoEnroll/PS_AutoIdentify 进行中时（由其它任务调用）立即发送并中止该流程 / Cancel command; while PS_AutoEnroll/PS_AutoIdentify runs (called from another task) it is sent at once and aborts that flow
+    fingerprint_status_t PS_Cancel(void) const;
     // ↓ 31H 自动注册模板 输入：ID号，录入次数，输入参数（2byte） 返回：返回参数1（1byte） 返回参数2（1byte） / Auto enroll template, Input: ID number, enrollment count, input parameters (2 bytes), Return: return parameter 1 (1 byte), return parameter 2 (1 byte)
     fingerprint_status_t PS_AutoEnroll(uint16_t ID, uint8_t enrollCount, fingerprint_auto_enroll_flags_t flags,
                                        uint8_t* param1 = nullptr, uint8_t* param2 = nullptr,
@@ -398,63 +738,238 @@ public:
 
 
 private:
-    // 静态实例指针，用于在回调函数中访问类成员 / Static instance pointer for accessing class members in callbacks
-    static M5UnitFingerprint2* instance;
+    friend class Fingerprint_PacketView;
+    friend struct Fingerprint_Footprint;
+    friend class Fingerprint_AutoFlowSession;
+
+#if defined(ARDUINO)
+    // 由 HardwareSerial 构造函数使用的内置传输 / Built-in transport used by the HardwareSerial constructor
+    Fingerprint_ArduinoTransport _arduinoTransport;
+#endif
 
-    // 串口对象 (Arduino) / Serial port object (Arduino)
-    HardwareSerial* _serialPort = nullptr;
+    // 传输接口 / Transport
+    Fingerprint_Transport* _transport = nullptr;
 
     // 默认地址 / Default address
     uint32_t _fp2_address = 0xFFFFFFFF;
 
-    int _txPin = -1; // TX引脚编号 / TX pin number
-    int _rxPin = -1; // RX引脚编号 / RX pin number
+    // 解析任务配置 / Parse task configuration
+    fingerprint_task_config_t _taskConfig;
+
+    // 批量传输包大小策略与缓存的模组包大小 / Bulk transfer packet size policy and the cached module packet size
+    fingerprint_transfer_profile_t _transferProfile = FINGERPRINT_DEFAULT_TRANSFER_PROFILE;
+    std::atomic<uint8_t> _packetSize{FINGERPRINT_PACKET_SIZE_UNKNOWN};
+    std::atomic<uint8_t> _charTransfer{FINGERPRINT_CHAR_TRANSFER_UNKNOWN}; // 08H/09H 支持情况 / 08H/09H support
+    std::atomic<uint8_t> _charTransferSilences{0}; // 08H/09H 连续无应答次数 / Consecutive unanswered 08H/09H commands
+
+    // 7AH/7BH 段长按固件版本缓存 / 7AH/7BH chunk sizes cached per firmware version
+    std::atomic<uint16_t> _firmwareVersion{FINGERPRINT_FIRMWARE_VERSION_UNKNOWN};
+    uint16_t _templateChunkSize     = 0; // 0 表示尚未学习 / 0 if not learned yet
+    uint16_t _templateChunkFirmware = FINGERPRINT_FIRMWARE_VERSION_UNKNOWN;
+    uint16_t _downloadChunkSize     = 0; // 0 表示尚未学习 / 0 if not learned yet
+    uint16_t _downloadChunkFirmware = FINGERPRINT_FIRMWARE_VERSION_UNKNOWN;
 
     // 数据包接收相关 / Packet reception related
-    uint8_t _recvBuffer[FINGERPRINT_RECV_BUFFER_SIZE]; // 接收缓冲区，使用更大的缓冲区 / Receive buffer, using larger buffer
-    size_t _recvIndex = 0; // 当前接收索引 / Current receive index
-    bool _waitingForResponse = false; // 是否在等待响应 / Whether waiting for response
-    Fingerprint_Packet* _expectedPacket = nullptr; // 期望的响应包 / Expected response packet
-    bool _packetReceived = false; // 是否已收到完整包 / Whether complete packet received
+    Fingerprint_RingBuffer<FINGERPRINT_RECV_BUFFER_SIZE> _rxRing; // 接收环形缓冲区（串口读取 -> 分帧器） / Receive ring buffer (serial reader -> framer)
+    std::atomic<bool> _rxProducerBusy{false}; // 生产者占用标志 / Producer busy flag
+    std::atomic<bool> _rxStalled{false}; // 环形缓冲区满、驱动中仍有数据 / Ring was full while the driver still had data
+    uint32_t _rxBytesReceived = 0; // 接收总字节数 / Total bytes received
+    uint32_t _rxBackpressureCount = 0; // 背压次数 / Back-pressure count
+
+    // 单一等待者交接：等待者以 CAS 占用，解析器先把包放入等待者的视图再通知，等待者被唤醒后无需再加锁
+    // Single-waiter handoff: the waiter claims it with a CAS; the parser places the packet in the waiter's view before
+    // notifying, so the woken waiter needs no further locking
+    enum HandoffState : uint8_t { HANDOFF_IDLE = 0, HANDOFF_WAITING = 1, HANDOFF_DELIVERED = 2 };
+    std::atomic<uint8_t> _handoff{HANDOFF_IDLE};
+    Fingerprint_PacketView* _handoffView = nullptr; // 等待者提供的视图，nullptr 表示等待流式接收结束 / View supplied by the waiter, nullptr when waiting for streaming to finish
+    uint32_t _frameStamp   = 0; // 最近一帧解析完成的时间（微秒） / Time the last frame was parsed (microseconds)
+    uint32_t _handoffStamp = 0; // 交付的包解析完成的时间（微秒） / Time the delivered packet was parsed (microseconds)
+
+    // 等待者在锁外更新，getReceiveStats() 可在任意任务中读取 / Updated by the waiter outside the lock; getReceiveStats() may read them from any task
+    std::atomic<uint32_t> _handoffCount{0};          // 交接次数 / Handoffs
+    std::atomic<uint32_t> _handoffLatencyLastUs{0};  // 最近一次交接延迟 / Last handoff latency
+    std::atomic<uint32_t> _handoffLatencyMaxUs{0};   // 最大交接延迟 / Maximum handoff latency
+    std::atomic<uint32_t> _handoffLatencyTotalUs{0}; // 交接延迟累计 / Accumulated handoff latency
+
+    // 锁等待统计，持有对应的锁时更新 / Lock wait statistics, updated while holding the corresponding lock
+    struct LockWaitStats {
+        uint32_t contended = 0; // 需要等待的次数 / Acquisitions that had to wait
+        uint32_t maxUs     = 0; // 最长等待 / Longest wait
+        uint32_t totalUs   = 0; // 累计等待 / Accumulated wait
+    };
+    LockWaitStats _rxLockWait;
+    LockWaitStats _txLockWait;
+    uint32_t _bytesSent = 0; // 写入总字节数，持 TX 锁更新 / Total bytes written, updated under the TX lock
+    std::atomic<bool> _expiryChanged{false}; // 包生存时间已修改，需重新计算过期时间 / Packet lifetime changed, the next deadline must be recomputed
+
+    // 流式分帧器，收到最后一个校验和字节即输出完整包 / Streaming framer, emits each packet on its last checksum byte
+    Fingerprint_Framer _framer;
     
-    // 新的包间隔检测和解析机制 / New packet interval detection and parsing mechanism
-    unsigned long _lastReceiveTime = 0; // 最后接收到数据的时间 / Last data receive time
-    bool _hasNewData = false; // 是否有新数据需要解析 / Whether there's new data to parse
+    // 解析队列 - 存储完整的数据包，按 ACK / DATA-END 分通道 O(1) 分发；分帧器直接在槽位中组帧 / Parse queue - stores complete packets, O(1) dispatch by ACK / DATA-END lane; the framer assembles frames directly in its slots
+    Fingerprint_PacketQueue<MAX_PARSED_PACKETS> _parsedPackets;
     
-    // 解析队列 - 存储完整的数据包 / Parse queue - stores complete packets
-    struct ParsedPacket {
-        uint8_t data[FINGERPRINT_MAX_PACKET_SIZE]; // 完整包数据 / Complete packet data
-        size_t length; // 包长度 / Packet length
-        unsigned long timestamp; // 接收时间戳 / Receive timestamp
+    // 数据包流式接收（PS_UpImage） / Data packet streaming sink (PS_UpImage)
+    struct {
+        uint8_t* buffer                    = nullptr;               // 目标缓冲区 / Destination buffer
+        uint32_t capacity                  = 0;                     // 目标缓冲区大小 / Destination buffer size
+        uint32_t length                    = 0;                     // 已写入字节数 / Bytes written
+        uint32_t packets                   = 0;                     // 已接收数据包数 / Data packets received
+        unsigned long lastActivity         = 0;                     // 最近一次收到数据包的时间 / Time of the last data packet
+        volatile fingerprint_sink_state_t state = FINGERPRINT_SINK_IDLE;
+    } _dataSink;
+
+    // 异步命令表，按优先级和句柄顺序发送，应答按发送顺序关联 / Asynchronous command table; sent by priority and handle order, replies correlated in send order
+    struct PendingCommand {
+        uint32_t handle                     = 0;                           // 命令句柄，0 表示空闲 / Command handle, 0 when free
+        fingerprint_command_state_t state   = FINGERPRINT_COMMAND_INVALID;
+        fingerprint_command_priority_t priority = FINGERPRINT_PRIORITY_INTERACTIVE;  // 优先级 / Priority class
+        uint8_t command                     = 0;                           // 命令码 / Command code
+        uint16_t length                     = 0;                           // 参数长度，完成后为应答数据长度 / Parameter length, acknowledge data length once done
+        uint8_t data[FINGERPRINT_ASYNC_PAYLOAD_SIZE];                      // 发送前存放参数，完成后存放应答数据 / Parameters before sending, acknowledge data once done
+        fingerprint_status_t status         = FINGERPRINT_OK;              // 确认码 / Confirmation code
+        uint32_t timeout                    = 0;                           // 应答超时（毫秒） / Acknowledge timeout (milliseconds)
+        unsigned long sentAt                = 0;                           // 发送时间 / Time sent
+        uint32_t sentSeq                    = 0;                           // 发送序号，与阻塞命令共用计数 / Send sequence number, counted together with blocking commands
+        PS_CommandCallback_t callback       = nullptr;                     // 完成回调 / Completion callback
+        void* context                       = nullptr;                     // 回调上下文 / Callback context
+        bool cancelled                      = false;                       // 已取消，完成时直接释放 / Cancelled, released on completion
     };
-    ParsedPacket _parsedPackets[MAX_PARSED_PACKETS];
-    size_t _parsedPacketIndex = 0; // 当前解析包索引 / Current parsed packet index
-    size_t _parsedPacketCount = 0; // 已解析包数量 / Parsed packet count
-    
+    PendingCommand _commands[FINGERPRINT_COMMAND_TABLE_SIZE];
+    uint8_t _commandsInFlight   = 0;             // 已发送、等待应答的命令数 / Commands sent and awaiting their acknowledge
+    uint32_t _nextCommandHandle = 1;             // 下一个命令序号（异步命令的句柄） / Next command sequence number (handle of asynchronous commands)
+    std::atomic<uint8_t> _pendingCommands{0};    // 已占用的命令表项数 / Command table entries in use
+
+    // 阻塞式自动流程（PS_AutoEnroll/PS_AutoIdentify）正在接收应答时，PS_Cancel 立即发出取消命令，由流程循环代收其应答
+    // While a blocking auto flow (PS_AutoEnroll/PS_AutoIdentify) is receiving, PS_Cancel sends the cancel command right
+    // away and the flow's loop collects its reply
+    enum CancelState : uint8_t { CANCEL_IDLE = 0, CANCEL_PENDING = 1, CANCEL_DONE = 2 };
+    uint8_t _autoFlowCommand          = 0;                  // 进行中的自动流程命令码，0 表示无 / Command code of the running auto flow, 0 if none
+    std::atomic<CancelState> _cancelState{CANCEL_IDLE};     // 注入的取消命令状态，置为 CANCEL_DONE 时以 release 发布 _cancelResult / State of the injected cancel command; setting CANCEL_DONE publishes _cancelResult with release
+    fingerprint_status_t _cancelResult = FINGERPRINT_OK;    // 取消命令的确认码 / Confirmation code of the cancel command
+
+    // 已注册的非阻塞自动流程会话，阶段包由解析器直接交给它 / Registered non-blocking auto flow session; the parser hands stage packets straight to it
+    std::atomic<Fingerprint_AutoFlowSession*> _autoSession{nullptr};
+
+    // 超时命令墓碑，按发送顺序排列：协议帧不带序号，超时后发出一条探测命令，其应答之前到达的应答按发送顺序和形状
+    // 归属墓碑或仍在等待的命令
+    // Timed-out command tombstones in send order: frames carry no sequence number, so after a timeout a probe command is
+    // sent, and replies arriving before the probe's reply are attributed by send order and shape to tombstones or to
+    // commands still waiting
+    struct StaleCommand {
+        uint8_t command = 0;  // 命令码 / Command code
+        uint32_t seq    = 0;  // 发送序号 / Send sequence number
+    };
+    StaleCommand _staleCommands[FINGERPRINT_MAX_STALE_COMMANDS];
+    uint8_t _staleHead       = 0;
+    uint8_t _staleCount      = 0;
+    uint8_t _syncCommand     = 0;      // 等待应答的探测命令码，0 表示没有 / Command code of the probe awaiting its reply, 0 if none
+    uint32_t _syncSeq        = 0;      // 探测命令的发送序号 / Send sequence number of the probe
+    uint32_t _syncProbes     = 0;      // 发出的探测命令数 / Probe commands sent
+    uint8_t _lastCommand     = 0;      // 阻塞调用最近发送的命令码，0 表示未在等待 / Command code last sent by a blocking call, 0 when not waiting
+    uint32_t _lastCommandSeq = 0;      // 阻塞调用最近发送的命令序号 / Sequence number of the command last sent by a blocking call
+    uint32_t _staleReplies      = 0;   // 丢弃的迟到应答数 / Late replies dropped
+    uint32_t _mismatchedReplies = 0;   // 形状不符的应答数 / Replies of the wrong shape
+
     // 唤醒回调函数相关 / Wakeup callback related
     PS_WakeupCallback_t _wakeupCallback = nullptr; // 用户设置的唤醒回调函数 / User-set wakeup callback function
 
 #if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
-    /** FreeRTOS 互斥锁句柄 / FreeRTOS mutex lock handle */
-    static SemaphoreHandle_t mutexLock;
+    /** FreeRTOS 互斥锁句柄，保护接收状态 / FreeRTOS mutex lock handle, protects the receive state */
+    SemaphoreHandle_t mutexLock = nullptr;
+
+    /** 发送互斥锁句柄，只串行化串口写出 / Send mutex handle, only serializes serial writes */
+    SemaphoreHandle_t txMutexLock = nullptr;
     
-    /** 响应信号量 / Response semaphore */
-    static SemaphoreHandle_t responseSemaphore;
+#if FINGERPRINT_HANDOFF_INDEXED_NOTIFY
+    /** 等待交接的任务 / Task awaiting the handoff */
+    TaskHandle_t _handoffTask = nullptr;
+#else
+    /** 交接信号，任务通知数组没有空余下标时使用 / Handoff signal, used when the task notification array has no spare index */
+    SemaphoreHandle_t _handoffSignal = nullptr;
+#endif
+
+    // 交接信号：登记等待者并清除残留信号、唤醒等待者、等待唤醒 / Handoff signal: register the waiter and clear a stale signal, wake the waiter, wait to be woken
+    void armHandoffSignal();
+    void raiseHandoffSignal();
+    void waitHandoffSignal(uint32_t timeout_ms);
 
-    /** 队列相关静态变量 / Queue-related static variables */
-    static QueueHandle_t dataQueue;
-    static TaskHandle_t parseTaskHandle;
+    /** 本实例的解析任务句柄 / This instance's parse task handle */
+    TaskHandle_t parseTaskHandle = nullptr;
 
     /** 队列相关方法 / Queue-related methods */
     static void parseDataTask(void* parameter);
+
+    /**
+     * @brief Data arrival callback registered with Fingerprint_Transport::setReceiveCallback().
+     * 
+     * Runs in the UART event task on RX FIFO threshold or RX timeout events and
+     * notifies the parse task, which otherwise stays blocked while the line is idle.
+     * 
+     * @param context Pointer to the owning M5UnitFingerprint2 instance.
+     */
+    static void onTransportReceive(void* context);
+
+    // 传输是否支持数据到达通知 / Whether the transport signals data arrival
+    std::atomic<bool> _eventDrivenRx{false};
+#else
+    /** 原生平台互斥锁，保护接收状态 / Native platform mutex, protects the receive state */
+    std::mutex _mutex;
+
+    /** 原生平台发送互斥锁 / Native platform send mutex */
+    std::mutex _txMutex;
 #endif
 
+    /**
+     * @brief Waits for the parser to make progress on a pending response.
+     * 
+     * On FreeRTOS platforms this blocks on a direct task notification sent by the parse
+     * task after the handoff. Elsewhere there is no parse task, so it waits for the
+     * transport to become readable (poll() on Linux) and parses the received data inline.
+     * 
+     * @param timeout_ms Maximum time to wait in milliseconds.
+     */
+    void waitResponseEvent(uint32_t timeout_ms);
+
+    /**
+     * @brief Registers the calling task as the single handoff waiter. Must be called with the mutex held.
+     * 
+     * @param view View that receives the packet, or nullptr to wait for the data sink to finish.
+     * @return false if another task is already waiting.
+     */
+    bool beginHandoff(Fingerprint_PacketView* view);
+
+    /**
+     * @brief Waits for the parser to deliver to the registered waiter.
+     * 
+     * On timeout the wait is withdrawn under the mutex, so it cannot race a delivery; a packet
+     * delivered in the meantime still counts.
+     * 
+     * @param startTime millis() value the timeout is measured from.
+     * @param timeout_ms Timeout in milliseconds.
+     * @param activity Optional activity time that restarts the timeout when it advances (data sink idle timeout).
+     * @return true if the parser delivered.
+     */
+    bool awaitHandoff(unsigned long startTime, uint32_t timeout_ms, const volatile unsigned long* activity = nullptr);
+
+    /**
+     * @brief Delivers to the registered waiter once its packet or the end of streaming is available. Must be called with the mutex held.
+     */
+    void deliverHandoff();
+
+    /**
+     * @brief Claims the oldest parsed packet as a response and updates the command bookkeeping. Must be called with the mutex held.
+     * 
+     * @param view View that receives the packet.
+     * @return true if a packet was claimed.
+     */
+    bool claimResponse(Fingerprint_PacketView& view);
+
     /**
      * @brief Acquires the mutex lock for thread-safe operations.
      * 
-     * This function acquires the FreeRTOS mutex lock to ensure thread-safe access to shared resources.
-     * Creates the mutex if it doesn't exist. Blocks until the lock is acquired.
-     * Only effective on ESP32/ESP8266 platforms with FreeRTOS support.
+     * This function acquires the FreeRTOS mutex lock to ensure thread-safe access to the receive state
+     * (framer, parse queue, command table). Creates the mutex if it doesn't exist. Blocks until the lock
+     * is acquired, recording the wait when the lock was busy. Uses std::mutex on native platforms.
      */
     void acquireMutex();
 
@@ -463,52 +978,84 @@ private:
      * 
      * This function releases the previously acquired FreeRTOS mutex lock, allowing other tasks
      * to access the shared resources. Should be called after acquireMutex() and corresponding operations.
-     * Only effective on ESP32/ESP8266 platforms with FreeRTOS support.
      */
     void releaseMutex();
+
+    /**
+     * @brief Whether received data is parsed by the calling task rather than a parse task.
+     * 
+     * @return true on native platforms and in inline mode.
+     */
+    bool parsesInline() const;
+
+    /**
+     * @brief Acquires the send lock, which only serializes writes to the transport.
+     * 
+     * The parser never takes it, so a write never waits on receive-side processing. When both locks are
+     * needed the send lock is taken first.
+     */
+    void acquireTxMutex();
+
+    /**
+     * @brief Releases the send lock.
+     */
+    void releaseTxMutex();
+
+    /**
+     * @brief Records the time spent waiting for a busy lock. Called while holding that lock.
+     * 
+     * @param stats Statistics of the lock.
+     * @param waitedUs Time spent waiting, in microseconds.
+     */
+    static void recordLockWait(LockWaitStats& stats, uint32_t waitedUs);
     
     /**
-     * @brief Processes received serial data and adds it to the receive buffer.
+     * @brief Reads pending serial data directly into the receive ring (producer side).
      * 
-     * This function handles incoming serial data by adding it to the internal receive buffer,
-     * updating timestamps for packet interval detection, and setting flags for packet parsing.
-     * Includes debug output when enabled and handles buffer overflow protection.
+     * This function performs bulk reads sized to the bytes available on the serial port,
+     * writing straight into the free spans of the lock-free receive ring for the framer to
+     * consume, so no intermediate copy is made and no mutex is taken. When the ring is full
+     * the remaining data is left in the UART driver buffer (back-pressure) and counted.
+     * May be called from the UART event callback or the parse task; an atomic flag ensures
+     * only one of them produces at a time. Includes debug output when enabled.
      * 
-     * @param data Pointer to the received data buffer.
-     * @param length Number of bytes received.
+     * @return Number of bytes read (0 if nothing was available, the ring is full or another producer is active).
      */
-    void processReceivedData(uint8_t* data, size_t length);
+    size_t receiveSerialData();
     
     /**
-     * @brief Checks for packet interval timeout and parses complete packets.
+     * @brief Feeds buffered serial data to the framer and dispatches complete packets.
      * 
-     * This function implements packet interval-based parsing by checking if enough time has passed
-     * since the last data reception. When the interval timeout is reached, it attempts to parse
-     * all complete packets from the receive buffer and adds them to the parsed packet queue.
-     * Also handles response matching for waiting operations.
+     * This function passes every byte in the receive ring to the streaming framer, which emits each packet
+     * as soon as its last checksum byte arrives (see onFrameReceived()). No idle gap on the line
+     * is required. Also handles response matching for waiting operations.
      */
     void checkAndParsePackets();
+
+    /**
+     * @brief Drops a partially parsed frame and the bytes still buffered in the receive ring.
+     *        Must be called with the mutex held.
+     */
+    void resetReceiveLocked();
     
     /**
-     * @brief Extracts a single complete packet from the buffer.
+     * @brief Framer callback invoked for each complete, checksum-verified packet.
      * 
-     * This function precisely parses one complete fingerprint packet from the given buffer,
-     * validating the start code, packet structure, checksum, and address. Returns the exact
-     * packet length if a valid packet is found.
+     * Wakeup packets are routed to the wakeup callback; all other packets are added to the
+     * parsed packet queue, in place when the frame was assembled in a reserved slot.
      * 
-     * @param buffer Pointer to the data buffer to parse.
-     * @param bufferSize Size of the data buffer.
-     * @param packetLength Reference to store the length of the extracted packet.
-     * @return true if a valid packet was extracted, false otherwise.
+     * @param context Pointer to the owning M5UnitFingerprint2 instance.
+     * @param frame Pointer to the complete packet data.
+     * @param length Length of the packet data.
      */
-    bool extractSinglePacket(uint8_t* buffer, size_t bufferSize, size_t& packetLength);
+    static void onFrameReceived(void* context, const uint8_t* frame, size_t length);
     
     /**
      * @brief Adds a parsed packet to the internal packet queue.
      * 
-     * This function adds a complete, validated packet to the internal queue for later retrieval.
-     * Manages queue overflow by removing the oldest packet when the queue is full.
-     * Each packet is timestamped for expiration tracking.
+     * This function adds a complete, validated packet to the lane for its packet type
+     * (ACK or DATA/END) in O(1). Manages queue overflow by evicting the earliest arrival
+     * when all slots are in use. Each packet is timestamped for expiration tracking.
      * 
      * @param packetData Pointer to the complete packet data.
      * @param packetLength Length of the packet data.
@@ -516,25 +1063,353 @@ private:
     void addParsedPacket(const uint8_t* packetData, size_t packetLength);
     
     /**
-     * @brief Retrieves a matching packet from the parsed packet queue.
+     * @brief Claims the earliest-arrived packet from the parsed packet queue into a view.
      * 
-     * This function searches the internal packet queue for a packet matching the expected
-     * criteria (typically ACK, DATA, or END_DATA packets). When found, constructs a
-     * Fingerprint_Packet object and removes the packet from the queue.
+     * This function takes the earliest-arrived ACK, DATA, or END_DATA packet by comparing
+     * the heads of the dispatch lanes, which is O(1). The packet stays in its slot and the
+     * view references it there; the slot returns to the free list when the view is released.
+     * Must be called with the mutex held.
      * 
-     * @param packet Reference to a Fingerprint_Packet object to store the found packet.
-     * @return true if a matching packet was found and retrieved, false otherwise.
+     * @param view Reference to a Fingerprint_PacketView that receives the packet.
+     * @return true if a packet was claimed, false if the queue is empty.
      */
-    bool getMatchingPacket(Fingerprint_Packet& packet);
+    bool claimPacket(Fingerprint_PacketView& view);
+
+    /**
+     * @brief Returns a slot held by a Fingerprint_PacketView to the parsed packet queue.
+     * 
+     * @param slot Slot index held by the view.
+     */
+    void releasePacketView(uint16_t slot);
+
+    /**
+     * @brief Framer storage callback that reserves a parse queue slot for the next frame.
+     * 
+     * Lets the framer assemble each frame directly in the slot it will be dispatched from,
+     * so complete packets are not copied again when queued.
+     * 
+     * @param context Pointer to the owning M5UnitFingerprint2 instance.
+     * @return Slot storage, or nullptr if every slot is held by a view.
+     */
+    static uint8_t* onFrameStorage(void* context);
     
+    /**
+     * @brief Arms the data packet streaming sink before a data-returning command is sent.
+     * 
+     * Once the parser sees a successful ACK, the payloads of the following DATA/END packets
+     * are copied straight into the destination buffer from the parser instead of going
+     * through the parsed packet queue. The ACK itself is still queued as usual.
+     * 
+     * @param buffer Destination buffer.
+     * @param capacity Destination buffer size in bytes.
+     */
+    void armDataSink(uint8_t* buffer, uint32_t capacity);
+
+    /**
+     * @brief Raises the packet size for one bulk transfer according to the transfer profile.
+     *
+     * The constructor raises the size before the command is sent; the destructor restores the
+     * previous size when the profile is FINGERPRINT_TRANSFER_BULK_RESTORE.
+     */
+    class BulkTransfer {
+    public:
+        explicit BulkTransfer(M5UnitFingerprint2& device);
+        ~BulkTransfer();
+
+    private:
+        M5UnitFingerprint2& _device;
+        uint8_t _restoreSize = FINGERPRINT_PACKET_SIZE_UNKNOWN;
+    };
+
+    /**
+     * @brief Records the outcome of a PS_UpChar/PS_DownChar command for getCharTransferSupport().
+     *
+     * @param answered true if a well-formed acknowledge arrived.
+     * @param confirmationCode The acknowledge's confirmation code, ignored when not answered.
+     */
+    void noteCharTransfer(bool answered, uint8_t confirmationCode);
+
+    // 模板上传进度，普通回调与计时回调共用 / Template upload progress, shared by the plain and timed callbacks
+    struct TemplateProgress {
+        PS_UploadTemplateCallback_t callback           = nullptr;
+        PS_UploadTemplateTimedCallback_t timedCallback = nullptr;
+        void* context                                  = nullptr;
+        uint32_t startUs                               = 0;
+
+        bool report(uint16_t currentSize, uint32_t totalSize, int packetCount, bool isComplete) const;
+    };
+
+    /**
+     * @brief Uploads the template, through PS_UpChar when supported and 7AH chunks otherwise.
+     */
+    fingerprint_status_t uploadTemplate(uint8_t* templateBuffer, uint32_t bufferSize, uint32_t& actualSize,
+                                        const TemplateProgress& progress);
+
+    /**
+     * @brief Uploads the template in 7AH chunks, learning the chunk size or pipelining requests once it is known.
+     */
+    fingerprint_status_t uploadTemplateChunks(uint8_t* templateBuffer, uint32_t bufferSize, uint32_t& actualSize,
+                                              const TemplateProgress& progress);
+
+    /**
+     * @brief Sends one 7AH request. The first request of a transfer clears unclaimed replies as usual;
+     *        later ones leave them, since they belong to the requests still in flight.
+     *
+     * @param seq Output: command sequence number, used for a tombstone if the reply never arrives.
+     */
+    bool sendTemplateRequest(uint16_t offset, uint16_t size, bool first, uint32_t& seq);
+
+    /**
+     * @brief Downloads the template in 7BH chunks, learning the chunk size or pipelining chunks once it is known.
+     */
+    fingerprint_status_t downloadTemplateChunks(const uint8_t* templateData, uint32_t templateSize,
+                                                PS_DownloadTemplateCallback_t callback);
+
+    /**
+     * @brief Sends one 7BH chunk straight from the caller's buffer, without copying it into a packet.
+     *        The first chunk of a transfer clears unclaimed replies as usual; later ones leave them.
+     *
+     * @param seq Output: command sequence number, used for a tombstone if the acknowledge never arrives.
+     */
+    bool sendTemplateChunk(uint16_t offset, const uint8_t* data, uint16_t size, bool first, uint32_t& seq);
+
+    /**
+     * @brief Tells whether a reply was dropped as the late reply of a timed-out command since the stale reply
+     *        count was read. A transfer that times out right after such a drop lost its own reply to the tombstone.
+     *
+     * @param dropped Stale reply count read under the mutex before waiting.
+     */
+    bool droppedStaleReply(uint32_t dropped);
+
+    /**
+     * @brief Disarms the data packet streaming sink.
+     * 
+     * @return Number of payload bytes written to the destination buffer.
+     */
+    uint32_t disarmDataSink();
+
+    /**
+     * @brief Waits until the streaming sink has received the END packet or overflowed.
+     * 
+     * @param idle_timeout_ms Maximum time without a new data packet before giving up.
+     * @return Final sink state, or FINGERPRINT_SINK_STREAMING on timeout.
+     */
+    fingerprint_sink_state_t waitDataSink(uint32_t idle_timeout_ms);
+
+    /**
+     * @brief Offers a complete frame to the streaming sink. Called from the parser with the mutex held.
+     * 
+     * @param frame Complete packet data.
+     * @param length Length of the packet data.
+     * @return true if the sink consumed the frame, false if it should be queued as usual.
+     */
+    bool sinkDataFrame(const uint8_t* frame, size_t length);
+
+    /**
+     * @brief Looks up a pending command by handle. Must be called with the mutex held.
+     * 
+     * @param handle Command handle.
+     * @return Command table entry, or nullptr if the handle is unknown.
+     */
+    PendingCommand* findCommand(uint32_t handle);
+
+    /**
+     * @brief Returns the earliest sent command still awaiting its acknowledge. Must be called with the mutex held.
+     * 
+     * The module answers commands in the order they were sent, so the next acknowledge
+     * packet that is not a late reply belongs to this command.
+     * 
+     * @return Command table entry, or nullptr if no command is in flight.
+     */
+    PendingCommand* oldestSentCommand();
+
+    /**
+     * @brief Allocates the next command sequence number. Must be called with the mutex held.
+     * 
+     * @return Non-zero sequence number.
+     */
+    uint32_t nextCommandSequence();
+
+    /**
+     * @brief Records the result of a command. Must be called with the mutex held.
+     * 
+     * @param entry Command table entry.
+     * @param status Confirmation code.
+     * @param data Acknowledge data following the confirmation code.
+     * @param length Acknowledge data length.
+     */
+    void finishCommand(PendingCommand* entry, fingerprint_status_t status, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Leaves a tombstone for a command whose acknowledge timed out. Must be called with the mutex held.
+     * 
+     * The next command sent is preceded by a probe (see sendSyncProbeLocked()). Until the probe's reply arrives, a
+     * reply that reaches the tombstone first in send order and fits its shape is dropped instead of being handed to a
+     * later command.
+     * 
+     * @param command Command code.
+     * @param seq Send sequence number.
+     */
+    void retireCommand(uint8_t command, uint32_t seq);
+
+    /**
+     * @brief Sends a probe command ahead of the next command when tombstones are pending. Must be called with both
+     *        the send lock and the mutex held.
+     * 
+     * The probe's reply has a shape no tombstone or waiting command can produce. Once it arrives, every command sent
+     * before it has answered or never will, so the tombstones are cleared.
+     */
+    void sendSyncProbeLocked();
+
+    /**
+     * @brief Tells whether a command still awaiting its acknowledge was sent before seq. Must be called with the
+     *        mutex held.
+     */
+    bool waitingCommandSentBefore(uint32_t seq);
+
+    /**
+     * @brief Drops a late reply to a timed-out command, or the probe's reply. Called from the parser with the mutex
+     *        held.
+     * 
+     * @param frame Complete packet data.
+     * @param length Length of the packet data.
+     * @return true if the packet was a late reply or the probe's reply and has been dropped.
+     */
+    bool dropStaleReply(const uint8_t* frame, size_t length);
+
+    /**
+     * @brief Marks a blocking auto flow as running so PS_Cancel can preempt it.
+     * 
+     * @param command Auto flow command code (FINGERPRINT_AUTO_ENROLL or FINGERPRINT_AUTO_IDENTIFY).
+     */
+    void beginAutoFlow(uint8_t command);
+
+    /**
+     * @brief Ends a blocking auto flow, first collecting the reply of an injected cancel command.
+     */
+    void endAutoFlow();
+
+    /**
+     * @brief Sends the cancel command at once if an auto flow is running, without waiting for its reply.
+     * 
+     * @return true if an auto flow was running and the cancel command has been sent (or already was).
+     */
+    bool injectCancel();
+
+    /**
+     * @brief Sends the cancel command at once if an auto flow is running, then waits for the flow to collect its reply.
+     * 
+     * @param result Receives the confirmation code of the cancel command.
+     * @return true if an auto flow was running and has been cancelled, false if none was running.
+     */
+    bool cancelAutoFlow(fingerprint_status_t& result);
+
+    /**
+     * @brief Dispatches the stage packets of the registered auto flow session outside the lock.
+     * 
+     * @return Milliseconds until the session's next timeout check, UINT32_MAX if no session is registered.
+     */
+    uint32_t dispatchSession();
+
+    /**
+     * @brief Claims a packet received by an auto flow as the reply to an injected cancel command.
+     * 
+     * The cancel reply carries only the confirmation code, while auto flow replies carry parameters.
+     * 
+     * @param packet Packet received by the auto flow.
+     * @return true if the packet was the cancel reply; the auto flow should stop.
+     */
+    bool takeCancelReply(const Fingerprint_PacketView& packet);
+
+    /**
+     * @brief Records the result of an injected cancel command and marks it done. Call with the RX mutex held.
+     *
+     * The state is stored with release ordering after the result, so cancelAutoFlow(), which polls the
+     * state without the lock, sees the result once it sees CANCEL_DONE.
+     */
+    void finishCancelLocked(fingerprint_status_t result);
+
+    /**
+     * @brief Checks whether an acknowledge payload has the shape expected for a command.
+     * 
+     * @param command Command code.
+     * @param payload Acknowledge payload, starting with the confirmation code.
+     * @param length Payload length.
+     * @return true if the payload length matches the command, or is shorter and reports an error.
+     */
+    static bool replyShapeFits(uint8_t command, const uint8_t* payload, size_t length);
+
+    /**
+     * @brief Serializes and writes a packet to the transport. Must be called with the send lock held.
+     * 
+     * @param packet The Fingerprint_Packet object to send.
+     * @return true if every byte was written.
+     */
+    bool writePacketLocked(const Fingerprint_Packet& packet);
+
+    /**
+     * @brief Writes an encoded frame as is. Must be called with the send lock held.
+     *
+     * @param frame Encoded frame.
+     * @param length Frame length.
+     * @return true if every byte was written.
+     */
+    bool writeBytesLocked(const uint8_t* frame, size_t length);
+
+    /**
+     * @brief Writes a frame from a short head and a payload left in place, summing the checksum as the
+     *        bytes go out. Must be called with the send lock held.
+     *
+     * @param type Packet identifier.
+     * @param head Leading data bytes (command code and parameters), at most 8.
+     * @param payload Trailing data bytes, written straight from the caller's buffer.
+     * @return true if every byte was written.
+     */
+    bool writeFrameLocked(uint8_t type, const uint8_t* head, uint8_t headLength, const uint8_t* payload,
+                          uint16_t payloadLength);
+
+    /**
+     * @brief Records a blocking command about to be sent: drops unclaimed replies, sends a probe if tombstones are
+     *        pending and sets the last command. Must be called with both the send lock and the mutex held.
+     */
+    void beginCommandLocked(uint8_t command);
+
+    /**
+     * @brief Releases a command table entry. Must be called with the mutex held.
+     * 
+     * @param entry Command table entry.
+     */
+    void freeCommand(PendingCommand* entry);
+
+    /**
+     * @brief Sends queued commands in submission order while fewer than FINGERPRINT_MAX_COMMANDS_IN_FLIGHT are in flight.
+     * 
+     * Takes the mutex itself; each packet is sent after its entry is marked as in flight, so an
+     * early acknowledge packet is still routed to it.
+     */
+    void startNextCommand();
+
+    /**
+     * @brief Offers an acknowledge packet to the earliest sent command. Called from the parser with the mutex held.
+     * 
+     * A reply whose shape does not fit the command completes it with FINGERPRINT_PACKET_BADPACKET.
+     * 
+     * @param frame Complete packet data.
+     * @param length Length of the packet data.
+     * @return true if the packet completed a command, false if it should be queued as usual.
+     */
+    bool completeCommand(const uint8_t* frame, size_t length);
+
     /**
      * @brief Removes expired packets from the internal queue.
      * 
      * This function performs housekeeping by removing packets that have exceeded the
-     * timeout threshold (typically 5 seconds) from the internal packet queue.
-     * Prevents memory leaks and ensures the queue doesn't grow indefinitely.
+     * lifetime of their lane from the internal packet queue. Since each lane is in
+     * deadline order, only lane heads are examined and the cost is O(expired).
+     * 
+     * @return Milliseconds until the next packet expires, or UINT32_MAX if the queue is empty.
      */
-    void cleanupExpiredPackets();
+    uint32_t cleanupExpiredPackets();
     
     /**
      * @brief Checks if a packet is a wakeup packet and handles it accordingly.
@@ -561,35 +1436,64 @@ private:
      */
     static void defaultWakeupCallback(const uint8_t* wakeupPacket, size_t packetLength);
     
-    /**
-     * @brief Legacy packet parsing method (simplified version).
-     * 
-     * This function provides a simpler packet parsing approach for compatibility.
-     * Searches for start codes, validates packet structure, and constructs response packets.
-     * Less robust than the interval-based parsing but useful for fallback scenarios.
-     * 
-     * @return true if a complete packet was parsed successfully, false otherwise.
-     */
-    bool tryParsePacket();
-    
     /**
      * @brief Sends a packet through the serial interface.
      * 
      * This function serializes a Fingerprint_Packet object and transmits it via the
      * configured serial port (Arduino HardwareSerial). Includes
      * debug output when enabled and mutex protection for thread safety.
+     * Before a command packet, unclaimed packets are discarded as stale and the
+     * command is recorded so a timeout can leave a tombstone for its late reply.
      * 
      * @param packet The Fingerprint_Packet object to send.
      * @return true if the packet was sent successfully, false otherwise.
      */
     bool sendPacketData(const Fingerprint_Packet& packet);
 
+    /**
+     * @brief Encodes a command with Fingerprint_CommandEncoder into a frame on the stack and sends it
+     *        like sendPacketData().
+     *
+     * @tparam Command Command code.
+     * @tparam ParamLength Parameter bytes.
+     * @param params ParamLength parameter bytes, may be nullptr without parameters.
+     * @return true if every byte was written.
+     */
+    template <uint8_t Command, uint16_t ParamLength = 0>
+    bool sendCommand(const uint8_t* params = nullptr) {
+        uint8_t frame[Fingerprint_CommandEncoder<Command, ParamLength>::frameSize];
+        return sendCommandFrame(frame, Fingerprint_CommandEncoder<Command, ParamLength>::encode(frame, _fp2_address, params));
+    }
+
+    /**
+     * @brief Sends an encoded command frame. Like sendPacketData(), unclaimed packets are discarded
+     *        as stale and the command is recorded first.
+     *
+     * @param frame Command frame from Fingerprint_CommandFrame or Fingerprint_CommandEncoder.
+     * @param length Frame length.
+     * @return true if every byte was written.
+     */
+    bool sendCommandFrame(const uint8_t* frame, size_t length);
+
+    /**
+     * @brief Receives a packet from the serial interface with timeout, without copying it.
+     * 
+     * This function waits for a response packet using the parsed packet queue mechanism and
+     * hands it out as a view into receive storage. Any packet the view already held is
+     * released first. On FreeRTOS platforms, uses semaphores for efficient waiting. On other
+     * platforms, uses polling with the specified timeout.
+     * 
+     * @param view Reference to a Fingerprint_PacketView that receives the packet.
+     * @param timeout_ms Timeout in milliseconds to wait for the packet (default: 1000ms).
+     * @return true if a packet was received within the timeout, false otherwise.
+     */
+    bool receivePacketData(Fingerprint_PacketView& view, uint32_t timeout_ms = 1000);
+
     /**
      * @brief Receives a packet from the serial interface with timeout.
      * 
-     * This function waits for a response packet using the parsed packet queue mechanism.
-     * On FreeRTOS platforms, uses semaphores for efficient waiting. On other platforms,
-     * uses polling with the specified timeout. Handles response matching and cleanup.
+     * Same as the Fingerprint_PacketView overload, but copies the packet into a
+     * Fingerprint_Packet object.
      * 
      * @param packet Reference to a Fingerprint_Packet object to store the received packet.
      * @param timeout_ms Timeout in milliseconds to wait for the packet (default: 1000ms).
@@ -598,6 +1502,41 @@ private:
     bool receivePacketData(Fingerprint_Packet& packet, uint32_t timeout_ms = 1000);
 };
 
+/**
+ * @brief 编译期内存占用报告 / Compile-time memory footprint report
+ *
+ * 各项为当前配置下对应缓冲区的 sizeof，可用于在编译期规划 RAM，例如
+ * static_assert(Fingerprint_Footprint::instance <= 8192, "...")。
+ * 默认配置下单个实例约 93 KB（64 位主机），其中解析队列约 75 KB、接收环形缓冲区 16 KB。每个队列槽位保存整帧
+ * （含包头与校验和）及到达序号和时间，因此比只保存 256 字节数据时多约 7 KB。
+ *
+ * Each member is the sizeof of the corresponding buffer under the current configuration, for budgeting RAM at build
+ * time, e.g. static_assert(Fingerprint_Footprint::instance <= 8192, "...").
+ * With the defaults one instance takes about 93 KB on a 64-bit host, of which the parse queue is about 75 KB and the
+ * receive ring 16 KB. Each queue slot holds a whole frame (header and checksum included) plus its arrival sequence
+ * and stamps, which costs about 7 KB more than slots holding only 256 payload bytes.
+ */
+struct Fingerprint_Footprint {
+    static constexpr size_t rxRing      = sizeof(Fingerprint_RingBuffer<FINGERPRINT_RECV_BUFFER_SIZE>); // 接收环形缓冲区 / Receive ring buffer
+    static constexpr size_t framer      = sizeof(Fingerprint_Framer); // 分帧器 / Framer
+    static constexpr size_t packetQueue = sizeof(Fingerprint_PacketQueue<MAX_PARSED_PACKETS>); // 解析队列 / Parse queue
+    static constexpr size_t commands    = sizeof(M5UnitFingerprint2::_commands); // 异步命令表 / Asynchronous command table
+    static constexpr size_t instance    = sizeof(M5UnitFingerprint2); // 单个实例总计 / Whole instance
+};
+
+// 应答包最大为读索引表（确认码 + 32 字节） / The largest acknowledge payload is the index table (confirmation code + 32 bytes)
+static_assert(FINGERPRINT_RX_MAX_PAYLOAD_SIZE >= 33 && FINGERPRINT_RX_MAX_PAYLOAD_SIZE <= FINGERPRINT_MAX_PACKET_SIZE,
+              "FINGERPRINT_RX_MAX_PAYLOAD_SIZE must be between 33 and FINGERPRINT_MAX_PACKET_SIZE");
+
+#if defined(FINGERPRINT_PROFILE_LEAN) && FINGERPRINT_PROFILE_LEAN
+static_assert(Fingerprint_Footprint::instance < 4096, "Lean profile M5UnitFingerprint2 instance must stay under 4 KB");
+#endif
+
+#ifdef FINGERPRINT_RAM_BUDGET
+static_assert(Fingerprint_Footprint::instance <= FINGERPRINT_RAM_BUDGET,
+              "M5UnitFingerprint2 instance exceeds FINGERPRINT_RAM_BUDGET");
+#endif
+
 
 
 
@@ -0,0 +1,624 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "M5UnitFingerprint2.hpp"
+
+// 各命令成功时的应答数据长度（含确认码），0 表示长度可变 / Acknowledge payload length of each command on success (including the confirmation code), 0 if variable
+static uint8_t expectedReplyLength(uint8_t command)
+{
+    switch (command) {
+        case FINGERPRINT_MATCH:
+        case FINGERPRINT_VALID_MODEL_COUNT:
+        case FINGERPRINT_GET_IMAGE_INFO:
+        case FINGERPRINT_AUTO_ENROLL:
+            return 3;
+        case FINGERPRINT_SEARCH:
+        case FINGERPRINT_SEARCH_NOW:
+        case FINGERPRINT_GET_RANDOM_CODE:
+            return 5;
+        case FINGERPRINT_READ_SYSTEM_PARAM:
+            return 17;
+        case FINGERPRINT_READ_NOTEPAD:
+        case FINGERPRINT_READ_INDEX_TABLE:
+        case FINGERPRINT_CHIP_SN:
+            return 33;
+        case FINGERPRINT_GET_SLEEP_TIME:
+        case FINGERPRINT_GET_WORK_MODE:
+        case FINGERPRINT_GET_MODULE_STATUS:
+        case FINGERPRINT_GET_FINGERPRINT_VERSION:
+            return 2;
+        case FINGERPRINT_GET_IMAGE:
+        case FINGERPRINT_GET_ENROLL_IMAGE:
+        case FINGERPRINT_GENERATE_CHARACTER:
+        case FINGERPRINT_REG_MODEL:
+        case FINGERPRINT_STORE:
+        case FINGERPRINT_LOAD_MODEL:
+        case FINGERPRINT_UPLOAD_MODEL:
+        case FINGERPRINT_DOWNLOAD_MODEL:
+        case FINGERPRINT_UPLOAD_IMAGE:
+        case FINGERPRINT_DELETE_MODEL:
+        case FINGERPRINT_EMPTY:
+        case FINGERPRINT_WRITE_REG:
+        case FINGERPRINT_READ_INFO_PAGE:
+        case FINGERPRINT_WRITE_NOTEPAD:
+        case FINGERPRINT_HAND_SHAKE:
+        case FINGERPRINT_CHECK_SENSOR:
+        case FINGERPRINT_CONTROL_LED:
+        case FINGERPRINT_CANCEL_AUTO_FLOW:
+        case FINGERPRINT_DOWN_TEMPLATE:
+        case FINGERPRINT_SET_SLEEP_TIME:
+        case FINGERPRINT_SET_WORK_MODE:
+        case FINGERPRINT_ACTIVATE_MODULE:
+        case FINGERPRINT_SAVE_CONF_TO_FLASH:
+            return 1;
+        default:
+            // 特殊上传模板、自动识别等应答长度随阶段变化 / Special template upload, auto identify etc. vary by stage
+            return 0;
+    }
+}
+
+// 按发送序号回绕安全地比较 / Compare send sequence numbers with a wrap-safe difference
+static inline bool sentBefore(uint32_t a, uint32_t b)
+{
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+// 应答形状是否符合命令：成功时长度须一致，失败时可以更短 / Whether a reply fits the command: exact length on success, possibly shorter on failure
+bool M5UnitFingerprint2::replyShapeFits(uint8_t command, const uint8_t* payload, size_t length)
+{
+    if (length < 1) {
+        return false;
+    }
+    uint8_t expected = expectedReplyLength(command);
+    if (expected == 0) {
+        return true;
+    }
+    return (length == expected) || (payload[0] != FINGERPRINT_OK && length < expected);
+}
+
+// 提交异步命令 / Submit an asynchronous command
+uint32_t M5UnitFingerprint2::submitCommand(uint8_t command, const uint8_t* params, uint16_t paramLength,
+                                           uint32_t timeout_ms, PS_CommandCallback_t callback, void* context,
+                                           fingerprint_command_priority_t priority)
+{
+    if (paramLength > FINGERPRINT_ASYNC_PAYLOAD_SIZE || (params == nullptr && paramLength > 0)) {
+        serialPrintln("Invalid asynchronous command parameters");
+        return 0;
+    }
+
+    acquireMutex();
+
+    // 保留表项只给取消类命令，表满时也能中止进行中的流程 / The reserved entry is only for the cancel class, so a running flow can be aborted even when the table is full
+    PendingCommand* entry = nullptr;
+    size_t used           = 0;
+    for (size_t i = 0; i < FINGERPRINT_COMMAND_TABLE_SIZE; i++) {
+        if (_commands[i].handle == 0) {
+            if (entry == nullptr) {
+                entry = &_commands[i];
+            }
+        } else if (_commands[i].priority != FINGERPRINT_PRIORITY_CANCEL) {
+            used++;
+        }
+    }
+    if (entry == nullptr || (priority != FINGERPRINT_PRIORITY_CANCEL && used >= FINGERPRINT_MAX_PENDING_COMMANDS)) {
+        releaseMutex();
+        serialPrintln("Asynchronous command table full");
+        return 0;
+    }
+
+    entry->handle    = nextCommandSequence();
+    entry->state     = FINGERPRINT_COMMAND_QUEUED;
+    entry->priority  = priority;
+    entry->command   = command;
+    entry->length    = paramLength;
+    entry->status    = FINGERPRINT_OK;
+    entry->timeout   = timeout_ms;
+    entry->callback  = callback;
+    entry->context   = context;
+    entry->cancelled = false;
+    if (paramLength > 0) {
+        memcpy(entry->data, params, paramLength);
+    }
+    uint32_t handle = entry->handle;
+    _pendingCommands.fetch_add(1, std::memory_order_relaxed);
+
+    releaseMutex();
+
+    // 流水线未满时立即在调用者上下文中发送，无需等待解析任务 / Send right away from the caller while the pipeline has room, without waiting for the parse task
+    startNextCommand();
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    // 唤醒解析任务，按新的应答超时重新计算等待时间 / Wake the parse task to recompute its wait with the new acknowledge timeout
+    if (parseTaskHandle != nullptr) {
+        xTaskNotifyGive(parseTaskHandle);
+    }
+#endif
+    return handle;
+}
+
+// 查询异步命令状态，完成时取走结果 / Poll an asynchronous command, collecting the result when done
+fingerprint_command_state_t M5UnitFingerprint2::pollCommand(uint32_t handle, fingerprint_status_t& status,
+                                                            uint8_t* response, uint16_t* responseLength)
+{
+    acquireMutex();
+
+    PendingCommand* entry = findCommand(handle);
+    if (entry == nullptr) {
+        releaseMutex();
+        return FINGERPRINT_COMMAND_INVALID;
+    }
+
+    fingerprint_command_state_t state = entry->state;
+    // 设置了回调的命令由回调取走结果 / Commands with a callback hand their result to the callback instead
+    if (state == FINGERPRINT_COMMAND_DONE && entry->callback == nullptr) {
+        status = entry->status;
+        if (responseLength != nullptr) {
+            uint16_t length = entry->length;
+            if (response != nullptr) {
+                if (length > *responseLength) {
+                    length = *responseLength;
+                }
+                memcpy(response, entry->data, length);
+            }
+            *responseLength = length;
+        }
+        freeCommand(entry);
+    }
+
+    releaseMutex();
+    return state;
+}
+
+// 取消异步命令 / Cancel an asynchronous command
+bool M5UnitFingerprint2::cancelCommand(uint32_t handle)
+{
+    acquireMutex();
+
+    PendingCommand* entry = findCommand(handle);
+    if (entry == nullptr) {
+        releaseMutex();
+        return false;
+    }
+
+    if (entry->state == FINGERPRINT_COMMAND_SENT) {
+        // 已发送的命令仍占据应答顺序中的位置，需消费其应答包，完成时直接释放 / A sent command still holds its place in reply order and must consume its acknowledge; it is released on completion
+        entry->cancelled = true;
+        entry->callback  = nullptr;
+    } else {
+        freeCommand(entry);
+    }
+
+    releaseMutex();
+    return true;
+}
+
+// 推进异步命令：超时、回调、发送下一条 / Advance asynchronous commands: timeouts, callbacks, next send
+uint32_t M5UnitFingerprint2::processCommands()
+{
+    // 没有解析任务时（原生平台、内联模式）在此读取并解析已到达的数据 / Without a parse task (native platforms, inline mode) read and parse arrived data here
+    if (parsesInline()) {
+        receiveSerialData();
+        checkAndParsePackets();
+    }
+
+    // 自动流程会话的阶段包在锁外分发 / Stage packets of an auto flow session are dispatched outside the lock
+    uint32_t sessionWait = dispatchSession();
+
+    // 没有挂起命令时不加锁 / No lock taken while nothing is pending
+    if (_pendingCommands.load(std::memory_order_relaxed) == 0) {
+        return sessionWait;
+    }
+
+    while (true) {
+        acquireMutex();
+
+        // 应答超时的命令留下墓碑，其迟到的应答不会交给后续命令 / Commands whose acknowledge timed out leave a tombstone so their late reply is not handed to a later command
+        unsigned long now = millis();
+        for (size_t i = 0; i < FINGERPRINT_COMMAND_TABLE_SIZE; i++) {
+            PendingCommand& entry = _commands[i];
+            if (entry.handle != 0 && entry.state == FINGERPRINT_COMMAND_SENT && now - entry.sentAt >= entry.timeout) {
+#if defined M5_MODULE_DEBUG_SERIAL
+                serialPrintf("Asynchronous command 0x%02X #%u timed out\r\n", entry.command, (unsigned)entry.handle);
+#endif
+                retireCommand(entry.command, entry.sentSeq);
+                finishCommand(&entry, FINGERPRINT_PACKET_TIMEOUT, nullptr, 0);
+            }
+        }
+
+        // 取出一个待回调的命令，释放表项后在锁外回调，回调中可以提交新命令 / Take one command awaiting its callback and free its entry, then call back outside the lock so the callback may submit new commands
+        PendingCommand* done = nullptr;
+        for (size_t i = 0; i < FINGERPRINT_COMMAND_TABLE_SIZE; i++) {
+            if (_commands[i].handle != 0 && _commands[i].state == FINGERPRINT_COMMAND_DONE &&
+                _commands[i].callback != nullptr) {
+                done = &_commands[i];
+                break;
+            }
+        }
+        if (done == nullptr) {
+            releaseMutex();
+            break;
+        }
+
+        uint32_t handle               = done->handle;
+        fingerprint_status_t status   = done->status;
+        uint16_t length               = done->length;
+        PS_CommandCallback_t callback = done->callback;
+        void* context                 = done->context;
+        uint8_t response[FINGERPRINT_ASYNC_PAYLOAD_SIZE];
+        memcpy(response, done->data, length);
+        freeCommand(done);
+
+        releaseMutex();
+
+        callback(handle, status, response, length, context);
+    }
+
+    startNextCommand();
+
+    // 距最早的应答超时的时间 / Time until the earliest acknowledge timeout
+    uint32_t wait = UINT32_MAX;
+    acquireMutex();
+    unsigned long now = millis();
+    for (size_t i = 0; i < FINGERPRINT_COMMAND_TABLE_SIZE; i++) {
+        const PendingCommand& entry = _commands[i];
+        if (entry.handle != 0 && entry.state == FINGERPRINT_COMMAND_SENT) {
+            unsigned long elapsed = now - entry.sentAt;
+            uint32_t remaining    = (elapsed >= entry.timeout) ? 0 : entry.timeout - elapsed;
+            if (remaining < wait) {
+                wait = remaining;
+            }
+        }
+    }
+    releaseMutex();
+    return (sessionWait < wait) ? sessionWait : wait;
+}
+
+// 按句柄查找命令表项 / Look up a command table entry by handle
+M5UnitFingerprint2::PendingCommand* M5UnitFingerprint2::findCommand(uint32_t handle)
+{
+    if (handle == 0) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < FINGERPRINT_COMMAND_TABLE_SIZE; i++) {
+        if (_commands[i].handle == handle) {
+            return &_commands[i];
+        }
+    }
+    return nullptr;
+}
+
+// 最早发送、仍在等待应答的命令：模组按顺序应答，下一个应答包属于它 / The earliest sent command still awaiting its acknowledge: the module replies in order, so the next reply belongs to it
+M5UnitFingerprint2::PendingCommand* M5UnitFingerprint2::oldestSentCommand()
+{
+    PendingCommand* oldest = nullptr;
+    for (size_t i = 0; i < FINGERPRINT_COMMAND_TABLE_SIZE; i++) {
+        PendingCommand& entry = _commands[i];
+        if (entry.handle != 0 && entry.state == FINGERPRINT_COMMAND_SENT &&
+            (oldest == nullptr || sentBefore(entry.sentSeq, oldest->sentSeq))) {
+            oldest = &entry;
+        }
+    }
+    return oldest;
+}
+
+// 分配命令序号，单调递增并跳过 0 / Allocate a command sequence number, increasing monotonically and skipping 0
+uint32_t M5UnitFingerprint2::nextCommandSequence()
+{
+    uint32_t seq = _nextCommandHandle++;
+    if (_nextCommandHandle == 0) {
+        _nextCommandHandle = 1;
+    }
+    return seq;
+}
+
+// 记录命令结果；已取消的命令直接释放 / Record a command result; cancelled commands are released right away
+void M5UnitFingerprint2::finishCommand(PendingCommand* entry, fingerprint_status_t status, const uint8_t* data,
+                                       size_t length)
+{
+    if (entry->state == FINGERPRINT_COMMAND_SENT) {
+        _commandsInFlight--;
+    }
+    if (length > FINGERPRINT_ASYNC_PAYLOAD_SIZE) {
+        length = FINGERPRINT_ASYNC_PAYLOAD_SIZE;
+    }
+    if (length > 0) {
+        memcpy(entry->data, data, length);
+    }
+    entry->length = static_cast<uint16_t>(length);
+    entry->status = status;
+    entry->state  = FINGERPRINT_COMMAND_DONE;
+    if (entry->cancelled) {
+        freeCommand(entry);
+    }
+}
+
+// 释放命令表项 / Release a command table entry
+void M5UnitFingerprint2::freeCommand(PendingCommand* entry)
+{
+    if (entry->state == FINGERPRINT_COMMAND_SENT) {
+        _commandsInFlight--;
+    }
+    entry->handle   = 0;
+    entry->state    = FINGERPRINT_COMMAND_INVALID;
+    entry->callback = nullptr;
+    entry->context  = nullptr;
+    _pendingCommands.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// 流水线未满时按优先级和提交顺序发送排队的命令 / Send queued commands by priority and submission order while the pipeline has room
+void M5UnitFingerprint2::startNextCommand()
+{
+    while (true) {
+        // 先取发送锁：命令按标记为在途的顺序写出 / Take the send lock first, so commands are written in the order they are marked in flight
+        acquireTxMutex();
+        acquireMutex();
+
+        // 先按优先级，同级按句柄（提交顺序）回绕安全地比较 / Priority first, then handle (submission order) compared with a wrap-safe difference
+        PendingCommand* next = nullptr;
+        for (size_t i = 0; i < FINGERPRINT_COMMAND_TABLE_SIZE; i++) {
+            PendingCommand& entry = _commands[i];
+            if (entry.handle != 0 && entry.state == FINGERPRINT_COMMAND_QUEUED &&
+                (next == nullptr || entry.priority < next->priority ||
+                 (entry.priority == next->priority && static_cast<int32_t>(entry.handle - next->handle) < 0))) {
+                next = &entry;
+            }
+        }
+
+        // 取消类不受流水线深度限制；后台命令只在线路空闲时发送 / The cancel class ignores the pipeline depth; background commands are only sent on an idle line
+        bool room = false;
+        if (next != nullptr) {
+            switch (next->priority) {
+                case FINGERPRINT_PRIORITY_CANCEL:
+                    room = true;
+                    break;
+                case FINGERPRINT_PRIORITY_BACKGROUND:
+                    room = (_commandsInFlight == 0);
+                    break;
+                default:
+                    room = (_commandsInFlight < FINGERPRINT_MAX_COMMANDS_IN_FLIGHT);
+                    break;
+            }
+        }
+        if (!room) {
+            releaseMutex();
+            releaseTxMutex();
+            return;
+        }
+
+        // 有墓碑时先发探测命令 / With tombstones pending, send the probe first
+        sendSyncProbeLocked();
+
+        // 先标记为在途再发送，应答包即使先于发送返回到达也能被匹配 / Mark in flight before sending, so an acknowledge that arrives before the send returns is still matched
+        uint8_t frame[Fingerprint_CommandFrame::size(FINGERPRINT_ASYNC_PAYLOAD_SIZE)];
+        size_t length   = Fingerprint_CommandFrame::encode(frame, _fp2_address, next->command, next->data, next->length);
+        uint32_t handle = next->handle;
+        next->state     = FINGERPRINT_COMMAND_SENT;
+        next->sentAt    = millis();
+        next->sentSeq   = nextCommandSequence();
+        _commandsInFlight++;
+
+        releaseMutex();
+
+        bool written = writeBytesLocked(frame, length);
+        releaseTxMutex();
+        if (written) {
+            continue;
+        }
+
+        // 发送失败按收包超时完成 / A failed send completes as a receive timeout
+        serialPrintln("Failed to send asynchronous command");
+        acquireMutex();
+        if (next->handle == handle && next->state == FINGERPRINT_COMMAND_SENT) {
+            finishCommand(next, FINGERPRINT_PACKET_TIMEOUT, nullptr, 0);
+        }
+        releaseMutex();
+    }
+}
+
+// 为超时的命令留下墓碑，墓碑按发送顺序排列 / Leave a tombstone for a timed-out command; tombstones are kept in send order
+void M5UnitFingerprint2::retireCommand(uint8_t command, uint32_t seq)
+{
+    if (_staleCount == FINGERPRINT_MAX_STALE_COMMANDS) {
+        _staleHead = (_staleHead + 1) % FINGERPRINT_MAX_STALE_COMMANDS;
+        _staleCount--;
+    }
+
+    // 超时顺序未必是发送顺序：从尾部向前插入 / Timeouts need not come in send order: insert from the tail backwards
+    size_t position = _staleCount;
+    while (position > 0) {
+        StaleCommand& previous = _staleCommands[(_staleHead + position - 1) % FINGERPRINT_MAX_STALE_COMMANDS];
+        if (!sentBefore(seq, previous.seq)) {
+            break;
+        }
+        _staleCommands[(_staleHead + position) % FINGERPRINT_MAX_STALE_COMMANDS] = previous;
+        position--;
+    }
+    StaleCommand& stale = _staleCommands[(_staleHead + position) % FINGERPRINT_MAX_STALE_COMMANDS];
+    stale.command       = command;
+    stale.seq           = seq;
+    _staleCount++;
+}
+
+// 是否有更早发出、仍在等待应答的命令 / Whether a command sent earlier is still awaiting its acknowledge
+bool M5UnitFingerprint2::waitingCommandSentBefore(uint32_t seq)
+{
+    if (_lastCommand != 0 && sentBefore(_lastCommandSeq, seq)) {
+        return true;
+    }
+    PendingCommand* head = oldestSentCommand();
+    return head != nullptr && sentBefore(head->sentSeq, seq);
+}
+
+// 探测命令：只读，应答形状各不相同 / Probe commands: read-only, each with a distinct reply shape
+static const uint8_t syncProbeCommands[] = {FINGERPRINT_READ_SYSTEM_PARAM, FINGERPRINT_GET_RANDOM_CODE,
+                                            FINGERPRINT_READ_INDEX_TABLE};
+
+// 有墓碑时在下一条命令前发出探测命令 / With tombstones pending, send a probe ahead of the next command
+void M5UnitFingerprint2::sendSyncProbeLocked()
+{
+    if (_staleCount == 0) {
+        return;
+    }
+    // 等待中的探测命令已排在所有墓碑之后 / The pending probe already follows every tombstone
+    const StaleCommand& newest = _staleCommands[(_staleHead + _staleCount - 1) % FINGERPRINT_MAX_STALE_COMMANDS];
+    if (_syncCommand != 0 && sentBefore(newest.seq, _syncSeq)) {
+        return;
+    }
+    // 探测命令之后又有命令超时，说明它的应答也没有到达：它本身也成为墓碑 / A command timed out after the probe, so the probe's reply did not arrive either: it becomes a tombstone itself
+    if (_syncCommand != 0) {
+        retireCommand(_syncCommand, _syncSeq);
+        _syncCommand = 0;
+    }
+
+    // 选一条应答形状与墓碑和等待中命令都不同的探测命令 / Pick a probe whose reply shape differs from every tombstone and waiting command
+    uint8_t probe = syncProbeCommands[0];
+    for (size_t c = 0; c < sizeof(syncProbeCommands); c++) {
+        uint8_t shape = expectedReplyLength(syncProbeCommands[c]);
+        bool taken    = (_lastCommand != 0 && expectedReplyLength(_lastCommand) == shape);
+        for (size_t i = 0; i < _staleCount && !taken; i++) {
+            taken = expectedReplyLength(_staleCommands[(_staleHead + i) % FINGERPRINT_MAX_STALE_COMMANDS].command) == shape;
+        }
+        for (size_t i = 0; i < FINGERPRINT_COMMAND_TABLE_SIZE && !taken; i++) {
+            taken = _commands[i].handle != 0 && _commands[i].state == FINGERPRINT_COMMAND_SENT &&
+                    expectedReplyLength(_commands[i].command) == shape;
+        }
+        if (!taken) {
+            probe = syncProbeCommands[c];
+            break;
+        }
+    }
+
+    // 读索引表需要页码参数 / Reading the index table takes a page number
+    uint8_t page = 0;
+    uint8_t frame[Fingerprint_CommandFrame::size(1)];
+    size_t length = Fingerprint_CommandFrame::encode(frame, _fp2_address, probe, &page,
+                                                     (probe == FINGERPRINT_READ_INDEX_TABLE) ? 1 : 0);
+    if (!writeBytesLocked(frame, length)) {
+        return;
+    }
+    _syncCommand = probe;
+    _syncSeq     = nextCommandSequence();
+    _syncProbes++;
+}
+
+// 由解析器调用，丢弃超时命令迟到的应答包和探测命令的应答 / Called by the parser, drops late replies to timed-out commands and the probe's reply
+bool M5UnitFingerprint2::dropStaleReply(const uint8_t* frame, size_t length)
+{
+    if ((_staleCount == 0 && _syncCommand == 0) || frame[6] != FINGERPRINT_PACKET_ACKPACKET ||
+        length <= FINGERPRINT_PACKET_HEADER_SIZE + 2) {
+        return false;
+    }
+
+    const uint8_t* payload = frame + FINGERPRINT_PACKET_HEADER_SIZE;
+    size_t payloadLength   = length - FINGERPRINT_PACKET_HEADER_SIZE - 2;
+
+    // 探测命令成功的应答不会与其它应答混淆；读系统参数时还须带有模组地址 / The probe's successful reply cannot be confused with another one; for the system parameters it must also carry the module address
+    bool syncReply = _syncCommand != 0 && payload[0] == FINGERPRINT_OK &&
+                     payloadLength == expectedReplyLength(_syncCommand) &&
+                     (_syncCommand != FINGERPRINT_READ_SYSTEM_PARAM || memcmp(&payload[9], &frame[2], 4) == 0);
+
+    // 其余应答按发送顺序：最早的是仍在等待的命令时交给它，是墓碑且形状相符时丢弃 / Other replies go by send order: to the earliest command if it is still waiting, dropped if the earliest is a tombstone that fits
+    while (!syncReply && _staleCount > 0) {
+        const StaleCommand& stale = _staleCommands[_staleHead];
+        if (waitingCommandSentBefore(stale.seq)) {
+            return false;
+        }
+        _staleHead = (_staleHead + 1) % FINGERPRINT_MAX_STALE_COMMANDS;
+        _staleCount--;
+
+        // 形状不符：按顺序应答的模组不会再为该命令应答 / Shape mismatch: a module replying in order will not answer that command any more
+        if (replyShapeFits(stale.command, payload, payloadLength)) {
+#if defined M5_MODULE_DEBUG_SERIAL
+            serialPrintf("Dropped late reply to command 0x%02X #%u\r\n", stale.command, (unsigned)stale.seq);
+#endif
+            _staleReplies++;
+            return true;
+        }
+    }
+
+    // 探测命令之前没有命令在等待时，形状相符的应答就是它的（例如失败的应答），否则它的应答已丢失 / With no command
+    // waiting ahead of the probe, a reply that fits its shape is the probe's (a failed one, say); otherwise its reply
+    // was lost
+    if (!syncReply && (_syncCommand == 0 || waitingCommandSentBefore(_syncSeq))) {
+        return false;
+    }
+    syncReply = syncReply || replyShapeFits(_syncCommand, payload, payloadLength);
+
+    // 探测命令之前发出的命令都已应答或不会再应答 / Every command sent before the probe has answered or never will
+    _staleCount = 0;
+    if (_lastCommand != 0 && sentBefore(_lastCommandSeq, _syncSeq)) {
+        _lastCommand = 0;
+    }
+    for (size_t i = 0; i < FINGERPRINT_COMMAND_TABLE_SIZE; i++) {
+        PendingCommand& entry = _commands[i];
+        if (entry.handle != 0 && entry.state == FINGERPRINT_COMMAND_SENT && sentBefore(entry.sentSeq, _syncSeq)) {
+#if defined M5_MODULE_DEBUG_SERIAL
+            serialPrintf("Command 0x%02X #%u got no reply\r\n", entry.command, (unsigned)entry.handle);
+#endif
+            _mismatchedReplies++;
+            finishCommand(&entry, FINGERPRINT_PACKET_TIMEOUT, nullptr, 0);
+        }
+    }
+    _syncCommand = 0;
+    return syncReply;
+}
+
+// 由解析器调用，以应答包完成最早发送的命令 / Called by the parser, completes the earliest sent command with an acknowledge packet
+bool M5UnitFingerprint2::completeCommand(const uint8_t* frame, size_t length)
+{
+    if (frame[6] != FINGERPRINT_PACKET_ACKPACKET || length <= FINGERPRINT_PACKET_HEADER_SIZE + 2) {
+        return false;
+    }
+    PendingCommand* head = oldestSentCommand();
+    if (head == nullptr) {
+        return false;
+    }
+
+    const uint8_t* payload = frame + FINGERPRINT_PACKET_HEADER_SIZE;
+    size_t payloadLength   = length - FINGERPRINT_PACKET_HEADER_SIZE - 2;
+
+    // 按发送顺序找第一个形状相符的命令，它之前的命令显然没有应答 / Find the first command in send order whose shape fits; the ones before it evidently never replied
+    PendingCommand* owner = head;
+    while (owner != nullptr && !replyShapeFits(owner->command, payload, payloadLength)) {
+        PendingCommand* later = nullptr;
+        for (size_t i = 0; i < FINGERPRINT_COMMAND_TABLE_SIZE; i++) {
+            PendingCommand& entry = _commands[i];
+            if (entry.handle != 0 && entry.state == FINGERPRINT_COMMAND_SENT &&
+                sentBefore(owner->sentSeq, entry.sentSeq) && (later == nullptr || sentBefore(entry.sentSeq, later->sentSeq))) {
+                later = &entry;
+            }
+        }
+        owner = later;
+    }
+
+    // 更早发出的阻塞命令仍在等待且形状相符：应答属于它，进入解析队列 / A blocking command sent earlier is still waiting and fits: the reply is its, so it goes to the parse queue
+    if (_lastCommand != 0 && (owner == nullptr || sentBefore(_lastCommandSeq, owner->sentSeq)) &&
+        replyShapeFits(_lastCommand, payload, payloadLength)) {
+        return false;
+    }
+
+    // 没有相符的命令：应答无法确认属于哪个命令，以错误完成最早的命令 / No command fits: the reply cannot be attributed, so the earliest command completes with an error
+    if (owner == nullptr) {
+#if defined M5_MODULE_DEBUG_SERIAL
+        serialPrintf("Reply of %d bytes does not fit command 0x%02X\r\n", (int)payloadLength, head->command);
+#endif
+        _mismatchedReplies++;
+        finishCommand(head, FINGERPRINT_PACKET_BADPACKET, nullptr, 0);
+        return true;
+    }
+
+    while ((head = oldestSentCommand()) != owner) {
+#if defined M5_MODULE_DEBUG_SERIAL
+        serialPrintf("Command 0x%02X #%u got no reply\r\n", head->command, (unsigned)head->handle);
+#endif
+        _mismatchedReplies++;
+        finishCommand(head, FINGERPRINT_PACKET_TIMEOUT, nullptr, 0);
+    }
+
+    // 确认码之后的数据 / Data following the confirmation code
+    finishCommand(owner, static_cast<fingerprint_status_t>(payload[0]), payload + 1, payloadLength - 1);
+    return true;
+}
@@ -12,19 +12,15 @@
 // 验证用获取图像 / Get image for verification
 fingerprint_status_t M5UnitFingerprint2::PS_GetImage(void) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_GET_IMAGE, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_GET_IMAGE>()) {
         serialPrintln("Failed to send PS_GetImage command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_GetImage response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -56,19 +52,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_GetImage(void) const
 // 注册用获取图像 / Get image for enrollment
 fingerprint_status_t M5UnitFingerprint2::PS_GetEnrollImage(void) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_GET_ENROLL_IMAGE, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_GET_ENROLL_IMAGE>()) {
         serialPrintln("Failed to send PS_GetEnrollImage command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_GetEnrollImage response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -102,18 +94,16 @@ fingerprint_status_t M5UnitFingerprint2::PS_GenChar(uint8_t BufferID) const
 {
     // 创建命令数据包 / Create command packet
     uint8_t params[] = {BufferID};
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_GENERATE_CHARACTER, params, 1);
 
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_GENERATE_CHARACTER, 1>(params)) {
         serialPrintln("Failed to send PS_GenChar command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_GenChar response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -145,19 +135,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_GenChar(uint8_t BufferID) const
 // 精确比对两枚指纹特征 / Match two fingerprint characteristics precisely
 fingerprint_status_t M5UnitFingerprint2::PS_Match(uint16_t& compareScores) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_MATCH, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_MATCH>()) {
         serialPrintln("Failed to send PS_Match command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_Match response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -200,18 +186,16 @@ fingerprint_status_t M5UnitFingerprint2::PS_Search(uint8_t BufferID, uint16_t St
     uint8_t params[] = {BufferID, 
                         static_cast<uint8_t>((StartPage >> 8) & 0xFF), static_cast<uint8_t>(StartPage & 0xFF),
                         static_cast<uint8_t>((PageNum >> 8) & 0xFF), static_cast<uint8_t>(PageNum & 0xFF)};
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_SEARCH, params, 5);
 
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_SEARCH, 5>(params)) {
         serialPrintln("Failed to send PS_Search command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_Search response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -251,19 +235,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_Search(uint8_t BufferID, uint16_t St
 // 合并特征文件生成模板 / Merge character files to generate template
 fingerprint_status_t M5UnitFingerprint2::PS_RegModel(void) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_REG_MODEL, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_REG_MODEL>()) {
         serialPrintln("Failed to send PS_RegModel command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_RegModel response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -303,18 +283,16 @@ fingerprint_status_t M5UnitFingerprint2::PS_StoreChar(uint8_t BufferID, uint16_t
 
     // 创建命令数据包 / Create command packet
     uint8_t params[] = {BufferID, static_cast<uint8_t>((PageID >> 8) & 0xFF), static_cast<uint8_t>(PageID & 0xFF)};
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_STORE, params, 3);
 
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_STORE, 3>(params)) {
         serialPrintln("Failed to send PS_StoreChar command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_StoreChar response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -355,18 +333,16 @@ fingerprint_status_t M5UnitFingerprint2::PS_LoadChar(uint8_t BufferID, uint16_t
 
     // 创建命令数据包 / Create command packet
     uint8_t params[] = {BufferID, static_cast<uint8_t>((PageID >> 8) & 0xFF), static_cast<uint8_t>(PageID & 0xFF)};
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_LOAD_MODEL, params, 3);
 
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_LOAD_MODEL, 3>(params)) {
         serialPrintln("Failed to send PS_LoadChar command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_LoadChar response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -396,6 +372,170 @@ fingerprint_status_t M5UnitFingerprint2::PS_LoadChar(uint8_t BufferID, uint16_t
     return static_cast<fingerprint_status_t>(confirmationCode);
 }
 
+// 上传特征 - 将特征缓冲区中的模板以一条命令加数据包连发上传到主控 / Upload template - Upload the template in a template buffer to the MCU as one command followed by a data packet burst
+fingerprint_status_t M5UnitFingerprint2::PS_UpChar(uint8_t BufferID, uint8_t* templateBuffer, uint32_t bufferSize, uint32_t& actualSize) const
+{
+    // 参数检查 / Parameter check
+    if (templateBuffer == nullptr || bufferSize == 0) {
+        serialPrintln("Invalid parameters for PS_UpChar");
+        return FINGERPRINT_PARAM_ERROR;
+    }
+
+    actualSize = 0; // 初始化实际模板大小 / Initialize actual template size
+
+    // 按传输策略提升包大小，须在启用流式接收前完成 / Raise the packet size per the transfer profile; must happen before the streaming sink is armed
+    M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
+    BulkTransfer bulk(*nonConstThis);
+
+    // 发送命令前启用流式接收 / Arm the streaming sink before sending
+    nonConstThis->armDataSink(templateBuffer, bufferSize);
+
+    // 发送命令包 / Send command packet
+    if (!nonConstThis->sendCommand<FINGERPRINT_UPLOAD_MODEL, 1>(&BufferID)) {
+        nonConstThis->disarmDataSink();
+        serialPrintln("Failed to send PS_UpChar command");
+        return FINGERPRINT_PACKET_TIMEOUT;
+    }
+
+    // 接收ACK响应包，不支持该命令的固件可能不应答 / Receive ACK response packet; firmware without this command may not answer
+    Fingerprint_PacketView ackPacket;
+    if (!nonConstThis->receivePacketData(ackPacket, FINGERPRINT_CHAR_TRANSFER_ACK_TIMEOUT_MS)) {
+        nonConstThis->disarmDataSink();
+        nonConstThis->noteCharTransfer(false, 0);
+        serialPrintln("Failed to receive PS_UpChar ACK response");
+        return FINGERPRINT_PACKET_TIMEOUT;
+    }
+
+    // 检查ACK响应包类型 / Check ACK response packet type
+    if (ackPacket.get_type() != FINGERPRINT_PACKET_ACKPACKET) {
+        nonConstThis->disarmDataSink();
+        serialPrintln("Invalid ACK packet type for PS_UpChar");
+        return FINGERPRINT_PACKET_BADPACKET;
+    }
+
+    // 检查ACK数据长度 / Check ACK data length
+    if (ackPacket.get_actual_data_length() < 1) {
+        nonConstThis->disarmDataSink();
+        serialPrintln("Invalid ACK data length for PS_UpChar");
+        return FINGERPRINT_PACKET_OVERFLOW;
+    }
+
+    // 获取ACK响应数据 / Get ACK response data
+    uint8_t confirmationCode = ackPacket.get_data()[0];
+    ackPacket.release();
+    nonConstThis->noteCharTransfer(true, confirmationCode);
+
+    // 检查命令执行状态 / Check command execution status
+    if (confirmationCode != FINGERPRINT_OK) {
+        nonConstThis->disarmDataSink();
+        serialPrintf("PS_UpChar command failed [confirmation: %s]\r\n",
+                     FingerprintDebugUtils::getStatusName(confirmationCode).c_str());
+        return static_cast<fingerprint_status_t>(confirmationCode);
+    }
+
+    // 解析器将数据包直接写入 templateBuffer / The parser writes data packets straight into templateBuffer
+    fingerprint_sink_state_t sinkState = nonConstThis->waitDataSink(FINGERPRINT_CHAR_TRANSFER_ACK_TIMEOUT_MS);
+    uint32_t totalBytesReceived        = nonConstThis->disarmDataSink();
+
+    if (sinkState == FINGERPRINT_SINK_OVERFLOW) {
+        serialPrintf("Template data exceeds provided buffer size (%d bytes)\r\n", bufferSize);
+        return FINGERPRINT_PACKET_OVERFLOW;
+    }
+    if (sinkState != FINGERPRINT_SINK_DONE) {
+        serialPrintf("Failed to receive template data packet #%d\r\n", (int)_dataSink.packets + 1);
+        return FINGERPRINT_PACKET_TIMEOUT;
+    }
+
+    actualSize = totalBytesReceived;
+    serialPrintf("PS_UpChar completed: %d bytes in %d packets\r\n", actualSize, (int)_dataSink.packets);
+    return FINGERPRINT_OK;
+}
+
+// 下载特征 - 以一条命令加数据包连发将模板下载到特征缓冲区 / Download template - Download a template into a template buffer as one command followed by a data packet burst
+fingerprint_status_t M5UnitFingerprint2::PS_DownChar(uint8_t BufferID, const uint8_t* templateData, uint32_t templateSize) const
+{
+    // 参数检查 / Parameter check
+    if (templateData == nullptr || templateSize == 0) {
+        serialPrintln("Invalid parameters for PS_DownChar");
+        return FINGERPRINT_PARAM_ERROR;
+    }
+
+    // 按传输策略提升包大小；数据包须按模组当前的包大小拆分 / Raise the packet size per the transfer profile; data packets must be split at the module's current size
+    M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
+    BulkTransfer bulk(*nonConstThis);
+    if (_packetSize.load() == FINGERPRINT_PACKET_SIZE_UNKNOWN) {
+        nonConstThis->refreshPacketSize();
+    }
+    uint8_t sizeCode = _packetSize.load();
+    if (sizeCode == FINGERPRINT_PACKET_SIZE_UNKNOWN) {
+        sizeCode = FINGERPRINT_PACKET_SIZE_64; // 包大小寄存器的复位值 / Reset value of the packet size register
+    }
+    uint16_t chunkSize = packetSizeBytes(sizeCode);
+
+    // 发送命令包 / Send command packet
+    if (!nonConstThis->sendCommand<FINGERPRINT_DOWNLOAD_MODEL, 1>(&BufferID)) {
+        serialPrintln("Failed to send PS_DownChar command");
+        return FINGERPRINT_PACKET_TIMEOUT;
+    }
+
+    // 接收ACK响应包，不支持该命令的固件可能不应答 / Receive ACK response packet; firmware without this command may not answer
+    Fingerprint_PacketView ackPacket;
+    if (!nonConstThis->receivePacketData(ackPacket, FINGERPRINT_CHAR_TRANSFER_ACK_TIMEOUT_MS)) {
+        nonConstThis->noteCharTransfer(false, 0);
+        serialPrintln("Failed to receive PS_DownChar ACK response");
+        return FINGERPRINT_PACKET_TIMEOUT;
+    }
+
+    // 检查ACK响应包类型 / Check ACK response packet type
+    if (ackPacket.get_type() != FINGERPRINT_PACKET_ACKPACKET) {
+        serialPrintln("Invalid ACK packet type for PS_DownChar");
+        return FINGERPRINT_PACKET_BADPACKET;
+    }
+
+    // 检查ACK数据长度 / Check ACK data length
+    if (ackPacket.get_actual_data_length() < 1) {
+        serialPrintln("Invalid ACK data length for PS_DownChar");
+        return FINGERPRINT_PACKET_OVERFLOW;
+    }
+
+    // 获取ACK响应数据 / Get ACK response data
+    uint8_t confirmationCode = ackPacket.get_data()[0];
+    ackPacket.release();
+    nonConstThis->noteCharTransfer(true, confirmationCode);
+
+    // 检查命令执行状态 / Check command execution status
+    if (confirmationCode != FINGERPRINT_OK) {
+        serialPrintf("PS_DownChar command failed [confirmation: %s]\r\n",
+                     FingerprintDebugUtils::getStatusName(confirmationCode).c_str());
+        return static_cast<fingerprint_status_t>(confirmationCode);
+    }
+
+    // 整段连发期间持有发送锁，其它命令不会插入数据包之间 / Hold the send lock for the whole burst, so no other command lands between the data packets
+    uint32_t sent    = 0;
+    uint32_t packets = 0;
+    bool written     = true;
+    nonConstThis->acquireTxMutex();
+    while (written && sent < templateSize) {
+        uint16_t length = (templateSize - sent > chunkSize) ? chunkSize : static_cast<uint16_t>(templateSize - sent);
+        bool last       = (sent + length >= templateSize);
+        Fingerprint_Packet dataPacket =
+            last ? Fingerprint_Packet::new_end_packet(_fp2_address, templateData + sent, length)
+                 : Fingerprint_Packet::new_data_packet(_fp2_address, templateData + sent, length);
+        written = nonConstThis->writePacketLocked(dataPacket);
+        sent += length;
+        packets++;
+    }
+    nonConstThis->releaseTxMutex();
+
+    if (!written) {
+        serialPrintf("Failed to send template data packet #%d\r\n", packets);
+        return FINGERPRINT_PACKET_TIMEOUT;
+    }
+
+    serialPrintf("PS_DownChar completed: %d bytes in %d packets\r\n", templateSize, packets);
+    return FINGERPRINT_OK;
+}
+
 // 上传图像（带图像数据返回）- 从指纹模块上传原始图像数据到主控并返回给用户 / Upload image (with image data return) - Upload raw image data from fingerprint module to MCU and return to user
 fingerprint_status_t M5UnitFingerprint2::PS_UpImage(uint8_t* imageBuffer, uint32_t bufferSize, uint32_t& actualImageSize) const
 {
@@ -407,32 +547,38 @@ fingerprint_status_t M5UnitFingerprint2::PS_UpImage(uint8_t* imageBuffer, uint32
 
     actualImageSize = 0; // 初始化实际图像大小 / Initialize actual image size
 
-    // 创建上传图像命令数据包 / Create upload image command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_UPLOAD_IMAGE, nullptr, 0);
+    // 按传输策略提升包大小，须在启用流式接收前完成 / Raise the packet size per the transfer profile; must happen before the streaming sink is armed
+    M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
+    BulkTransfer bulk(*nonConstThis);
+
+    // 发送命令前启用流式接收，避免应答之后紧跟的数据包先进入解析队列 / Arm the streaming sink before sending, so data packets right after the ACK never reach the parse queue
+    nonConstThis->armDataSink(imageBuffer, bufferSize);
 
     // 发送命令包 / Send command packet
-    M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_UPLOAD_IMAGE>()) {
+        nonConstThis->disarmDataSink();
         serialPrintln("Failed to send PS_UpImage command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收ACK响应包 / Receive ACK response packet
-    Fingerprint_Packet ackPacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView ackPacket;
     if (!nonConstThis->receivePacketData(ackPacket, 10000)) {
+        nonConstThis->disarmDataSink();
         serialPrintln("Failed to receive PS_UpImage ACK response");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 检查ACK响应包类型 / Check ACK response packet type
     if (ackPacket.get_type() != FINGERPRINT_PACKET_ACKPACKET) {
+        nonConstThis->disarmDataSink();
         serialPrintln("Invalid ACK packet type for PS_UpImage");
         return FINGERPRINT_PACKET_BADPACKET;
     }
 
     // 检查ACK数据长度 / Check ACK data length
     if (ackPacket.get_actual_data_length() < 1) {
+        nonConstThis->disarmDataSink();
         serialPrintln("Invalid ACK data length for PS_UpImage");
         return FINGERPRINT_PACKET_OVERFLOW;
     }
@@ -440,75 +586,36 @@ fingerprint_status_t M5UnitFingerprint2::PS_UpImage(uint8_t* imageBuffer, uint32
     // 获取ACK响应数据 / Get ACK response data
     const uint8_t* ackData = ackPacket.get_data();
     uint8_t confirmationCode = ackData[0];
+    ackPacket.release();
 
     // 检查命令执行状态 / Check command execution status
     if (confirmationCode != FINGERPRINT_OK) {
+        nonConstThis->disarmDataSink();
         serialPrintf("PS_UpImage command failed [confirmation: %s]\r\n",
                      FingerprintDebugUtils::getStatusName(confirmationCode).c_str());
         return static_cast<fingerprint_status_t>(confirmationCode);
     }
 
-    serialPrintln("PS_UpImage ACK received, starting to receive image data packets...");
+    serialPrintln("PS_UpImage ACK received, streaming image data packets...");
 
-    // 开始接收图像数据包 / Start receiving image data packets
-    uint32_t totalPacketsReceived = 0;
-    uint32_t totalBytesReceived = 0;
-    bool receivingComplete = false;
-
-    while (!receivingComplete) {
-        // 接收数据包（可能是DATAPACKET或ENDDATAPACKET） / Receive data packet (could be DATAPACKET or ENDDATAPACKET)
-        Fingerprint_Packet dataPacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_DATAPACKET, nullptr, 0);
-        if (!nonConstThis->receivePacketData(dataPacket, 10000)) {
-            serialPrintf("Failed to receive image data packet #%d\r\n", totalPacketsReceived + 1);
-            return FINGERPRINT_PACKET_TIMEOUT;
-        }
-
-        // 检查数据包类型 / Check data packet type
-        uint8_t packetType = dataPacket.get_type();
-        if (packetType == FINGERPRINT_PACKET_DATAPACKET) {
-            // 普通数据包，继续接收 / Normal data packet, continue receiving
-            serialPrintf("Received data packet #%d, size: %d bytes\r\n", 
-                        totalPacketsReceived + 1, dataPacket.get_actual_data_length());
-        } else if (packetType == FINGERPRINT_PACKET_ENDDATAPACKET) {
-            // 结束数据包，这是最后一个包 / End data packet, this is the last packet
-            serialPrintf("Received end data packet #%d, size: %d bytes\r\n", 
-                        totalPacketsReceived + 1, dataPacket.get_actual_data_length());
-            receivingComplete = true;
-        } else {
-            serialPrintf("Invalid data packet type: 0x%02X\r\n", packetType);
-            return FINGERPRINT_PACKET_BADPACKET;
-        }
-
-        // 将当前包的数据添加到图像数据中 / Add current packet data to image data
-        const uint8_t* packetData = dataPacket.get_data();
-        uint16_t packetDataLength = dataPacket.get_actual_data_length();
-        
-        if (packetDataLength > 0) {
-            // 检查用户提供的缓冲区是否有足够空间 / Check if user-provided buffer has enough space
-            if (totalBytesReceived + packetDataLength > bufferSize) {
-                serialPrintf("Image data exceeds provided buffer size (%d bytes)\r\n", bufferSize);
-                return FINGERPRINT_PACKET_OVERFLOW;
-            }
-            
-            // 复制数据到用户提供的图像缓冲区 / Copy data to user-provided buffer
-            memcpy(&imageBuffer[totalBytesReceived], packetData, packetDataLength);
-            totalBytesReceived += packetDataLength;
-        }
-
-        totalPacketsReceived++;
+    // 解析器将数据包直接写入 imageBuffer，收到结束包时只唤醒一次 / The parser writes data packets straight into imageBuffer and wakes us once on the end packet
+    fingerprint_sink_state_t sinkState = nonConstThis->waitDataSink(10000);
+    uint32_t totalBytesReceived        = nonConstThis->disarmDataSink();
 
-        // 防止无限循环，设置最大包数限制 / Prevent infinite loop, set maximum packet count limit
-        if (totalPacketsReceived > 1000) {
-            serialPrintln("Warning: Received too many packets, stopping...");
-            break;
-        }
+    if (sinkState == FINGERPRINT_SINK_OVERFLOW) {
+        serialPrintf("Image data exceeds provided buffer size (%d bytes)\r\n", bufferSize);
+        return FINGERPRINT_PACKET_OVERFLOW;
+    }
+    if (sinkState != FINGERPRINT_SINK_DONE) {
+        serialPrintf("Failed to receive image data packet #%d\r\n", (int)_dataSink.packets + 1);
+        return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 设置实际接收的图像大小 / Set actual received image size
     actualImageSize = totalBytesReceived;
 
     serialPrintf("Image upload completed successfully!\r\n");
-    serialPrintf("Total packets received: %d\r\n", totalPacketsReceived);
+    serialPrintf("Total packets received: %d\r\n", (int)_dataSink.packets);
     serialPrintf("Total image data size: %d bytes\r\n", actualImageSize);
 
 // #if defined M5_MODULE_DEBUG_SERIAL
@@ -543,19 +650,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_DeletChar(uint16_t PageID, uint16_t
     params[2] = (Num >> 8) & 0xFF;     // Num 高字节 / Num high byte
     params[3] = Num & 0xFF;            // Num 低字节 / Num low byte
 
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_DELETE_MODEL, params, 4);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_DELETE_MODEL, 4>(params)) {
         serialPrintln("Failed to send PS_DeletChar command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 2000)) {  // 删除可能需要更长时间 / Delete may take longer
         serialPrintln("Failed to receive PS_DeletChar response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -587,19 +690,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_DeletChar(uint16_t PageID, uint16_t
 // 清空指纹库 - 清空flash指纹库 / Empty fingerprint library - Clear flash fingerprint library
 fingerprint_status_t M5UnitFingerprint2::PS_Empty(void) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_EMPTY, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_EMPTY>()) {
         serialPrintln("Failed to send PS_Empty command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 (清空操作可能需要更长时间) / Receive response packet (empty operation may take longer)
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 5000)) {
         serialPrintln("Failed to receive PS_Empty response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -647,19 +746,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_WriteReg(fingerprint_register_id_t R
     }
     params[1] = Value;                        // 寄存器数据值 / Register data value
 
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_WRITE_REG, params, 2);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_WRITE_REG, 2>(params)) {
         serialPrintln("Failed to send PS_WriteReg command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_WriteReg response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -682,8 +777,13 @@ fingerprint_status_t M5UnitFingerprint2::PS_WriteReg(fingerprint_register_id_t R
     uint8_t confirmationCode    = responseData[0];
 
     // 计算实际发送的RegID值（用于调试输出） / Calculate actual sent RegID value (for debug output)
-    uint8_t actualRegIDValue = (RegID > 9) ? (0x10 + (RegID - 10)) : static_cast<uint8_t>(RegID);
+    [[maybe_unused]] uint8_t actualRegIDValue = (RegID > 9) ? (0x10 + (RegID - 10)) : static_cast<uint8_t>(RegID);
     
+    // 包大小寄存器写入成功后更新缓存 / Update the cache once the packet size register was written
+    if (confirmationCode == FINGERPRINT_OK && RegID == FP_REG_PACKET_SIZE) {
+        nonConstThis->_packetSize.store(Value);
+    }
+
     serialPrintf("Write register result: %s [RegID: %d->0x%02X, Value: 0x%02X, confirmation: %s]\r\n",
                  (confirmationCode == FINGERPRINT_OK) ? "Success" : "Failed", static_cast<uint8_t>(RegID), actualRegIDValue, Value,
                  FingerprintDebugUtils::getStatusName(confirmationCode).c_str());
@@ -694,19 +794,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_WriteReg(fingerprint_register_id_t R
 // 读取系统参数 - 读取系统基本参数 / Read system parameters - Read basic system parameters
 fingerprint_status_t M5UnitFingerprint2::PS_ReadSysPara(PS_ReadSysPara_BasicParams &RawData) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_READ_SYSTEM_PARAM, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_READ_SYSTEM_PARAM>()) {
         serialPrintln("Failed to send PS_ReadSysPara command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_ReadSysPara response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -745,6 +841,11 @@ fingerprint_status_t M5UnitFingerprint2::PS_ReadSysPara(PS_ReadSysPara_BasicPara
             RawData.packet_size = (paramData[12] << 8) | paramData[13];             // 数据包大小 (2字节) / Packet size (2 bytes)
             RawData.baud_rate = (paramData[14] << 8) | paramData[15];               // 串口波特率 (2字节) / Serial baud rate (2 bytes)
 
+            // 缓存包大小，批量传输时无需再查询 / Cache the packet size so bulk transfers need no further query
+            if (RawData.packet_size <= FINGERPRINT_PACKET_SIZE_256) {
+                nonConstThis->_packetSize.store(static_cast<uint8_t>(RawData.packet_size));
+            }
+
 #ifdef M5_MODULE_DEBUG_SERIAL_ENABLED
             serialPrintf("Read system parameters successfully:\r\n");
             serialPrintf("  Status Register: 0x%04X\r\n", RawData.status_register);
@@ -787,22 +888,116 @@ fingerprint_status_t M5UnitFingerprint2::PS_ReadSysPara(PS_ReadSysPara_BasicPara
     return static_cast<fingerprint_status_t>(confirmationCode);
 }
 
+void M5UnitFingerprint2::setTransferProfile(fingerprint_transfer_profile_t profile)
+{
+    _transferProfile = profile;
+}
+
+fingerprint_transfer_profile_t M5UnitFingerprint2::getTransferProfile() const
+{
+    return _transferProfile;
+}
+
+uint8_t M5UnitFingerprint2::getPacketSize() const
+{
+    return _packetSize.load();
+}
+
+// 设置包大小寄存器，缓存值相同时不发送命令 / Set the packet size register, sending nothing when the cached value already matches
+fingerprint_status_t M5UnitFingerprint2::setPacketSize(uint8_t sizeCode)
+{
+    if (sizeCode > FINGERPRINT_PACKET_SIZE_256) {
+        serialPrintf("Invalid packet size code: %d (valid: 0-3)\r\n", sizeCode);
+        return FINGERPRINT_PARAM_ERROR;
+    }
+    if (_packetSize.load() == sizeCode) {
+        return FINGERPRINT_OK;
+    }
+    return PS_WriteReg(FP_REG_PACKET_SIZE, sizeCode);
+}
+
+// 读取并缓存模组的包大小 / Read and cache the module's packet size
+fingerprint_status_t M5UnitFingerprint2::refreshPacketSize()
+{
+    PS_ReadSysPara_BasicParams params;
+    return PS_ReadSysPara(params);
+}
+
+// 批量传输前按策略提升包大小 / Raise the packet size before a bulk transfer according to the profile
+M5UnitFingerprint2::BulkTransfer::BulkTransfer(M5UnitFingerprint2& device) : _device(device)
+{
+    if (_device._transferProfile == FINGERPRINT_TRANSFER_AS_CONFIGURED) {
+        return;
+    }
+
+    // 缓存为空（未读取或模组重新上电）时先读取一次 / Read once when the cache is empty (never read, or the module powered up again)
+    if (_device._packetSize.load() == FINGERPRINT_PACKET_SIZE_UNKNOWN) {
+        _device.refreshPacketSize();
+    }
+    uint8_t previous = _device._packetSize.load();
+    if (previous == FINGERPRINT_BULK_PACKET_SIZE) {
+        return;
+    }
+
+    // 提升失败时按当前包大小传输，流式接收不依赖包大小 / If raising fails the transfer runs at the current size; the streaming sink does not depend on it
+    if (_device.setPacketSize(FINGERPRINT_BULK_PACKET_SIZE) != FINGERPRINT_OK) {
+        serialPrintln("Failed to raise the packet size for a bulk transfer");
+        return;
+    }
+    if (_device._transferProfile == FINGERPRINT_TRANSFER_BULK_RESTORE) {
+        _restoreSize = previous;
+    }
+}
+
+// 传输结束后按策略恢复原包大小 / Restore the previous packet size after the transfer according to the profile
+M5UnitFingerprint2::BulkTransfer::~BulkTransfer()
+{
+    if (_restoreSize != FINGERPRINT_PACKET_SIZE_UNKNOWN) {
+        _device.setPacketSize(_restoreSize);
+    }
+}
+
+fingerprint_char_transfer_t M5UnitFingerprint2::getCharTransferSupport() const
+{
+    return static_cast<fingerprint_char_transfer_t>(_charTransfer.load());
+}
+
+void M5UnitFingerprint2::setCharTransferSupport(fingerprint_char_transfer_t support)
+{
+    _charTransferSilences = 0;
+    _charTransfer         = static_cast<uint8_t>(support);
+}
+
+// 格式正确的应答（含非零确认码）即说明支持；只有指令无效确认码或连续无应答才记为不支持 / Any well-formed acknowledge, non-zero codes included, means supported; only the invalid-command code or repeated silence means unsupported
+void M5UnitFingerprint2::noteCharTransfer(bool answered, uint8_t confirmationCode)
+{
+    uint8_t expected = FINGERPRINT_CHAR_TRANSFER_UNKNOWN;
+    if (!answered) {
+        if (++_charTransferSilences >= FINGERPRINT_CHAR_TRANSFER_SILENT_LIMIT) {
+            _charTransfer.compare_exchange_strong(expected, FINGERPRINT_CHAR_TRANSFER_UNSUPPORTED);
+        }
+        return;
+    }
+    _charTransferSilences = 0;
+    if (confirmationCode == FINGERPRINT_CHAR_TRANSFER_INVALID_CODE) {
+        _charTransfer.compare_exchange_strong(expected, FINGERPRINT_CHAR_TRANSFER_UNSUPPORTED);
+    } else {
+        _charTransfer = FINGERPRINT_CHAR_TRANSFER_SUPPORTED;
+    }
+}
+
 // 采样随机数 - 生成4字节随机数 / Sample random number - Generate 4-byte random number
 fingerprint_status_t M5UnitFingerprint2::PS_GetRandomCode(uint32_t &RandomCode) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_GET_RANDOM_CODE, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_GET_RANDOM_CODE>()) {
         serialPrintln("Failed to send PS_GetRandomCode command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_GetRandomCode response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -855,19 +1050,18 @@ fingerprint_status_t M5UnitFingerprint2::PS_ReadINFpage(uint8_t* INFData) const
         return FINGERPRINT_PARAM_ERROR;
     }
 
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_READ_INFO_PAGE, nullptr, 0);
+    // 按传输策略提升包大小 / Raise the packet size per the transfer profile
+    M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
+    BulkTransfer bulk(*nonConstThis);
 
     // 发送命令包 / Send command packet
-    M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_READ_INFO_PAGE>()) {
         serialPrintln("Failed to send PS_ReadINFpage command");
         return FINGERPRINT_PARAM_ERROR;
     }
 
     // 接收第一个响应包（ACK包） / Receive first response packet (ACK packet)
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 2000)) {
         serialPrintln("Failed to receive PS_ReadINFpage ACK response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -904,7 +1098,7 @@ fingerprint_status_t M5UnitFingerprint2::PS_ReadINFpage(uint8_t* INFData) const
 
     while (totalBytesReceived < expectedDataSize) {
         // 接收数据包 / Receive data packet
-        Fingerprint_Packet dataPacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_DATAPACKET, nullptr, 0);
+        Fingerprint_PacketView dataPacket;
         if (!nonConstThis->receivePacketData(dataPacket, 3000)) {
             serialPrintf("Failed to receive data packet %d for PS_ReadINFpage\r\n", totalPacketsReceived + 1);
             return FINGERPRINT_PACKET_TIMEOUT;
@@ -955,7 +1149,7 @@ fingerprint_status_t M5UnitFingerprint2::PS_ReadINFpage(uint8_t* INFData) const
 #if defined M5_MODULE_DEBUG_SERIAL
     if (totalBytesReceived > 0) {
         serialPrint("INF data (128 bytes):");
-        for (int i = 0; i < totalBytesReceived && i < 128; i++) {
+        for (uint32_t i = 0; i < totalBytesReceived && i < 128; i++) {
             if (i % 16 == 0) {
                 M5_MODULE_DEBUG_SERIAL.printf("\r\n%04X: ", i); // Print address offset
             }
@@ -997,19 +1191,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_WriteNotepad(uint8_t NotepadID, cons
         memcpy(&commandParams[1], NotepadData, NotepadLength);
     }
 
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_WRITE_NOTEPAD, commandParams, 33);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_WRITE_NOTEPAD, 33>(commandParams)) {
         serialPrintln("Failed to send PS_WriteNotepad command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_WriteNotepad response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1056,19 +1246,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_ReadNotepad(uint8_t NotepadID, uint8
     // 准备命令参数：便笺号(1字节) / Prepare command parameters: Notepad ID (1 byte)
     uint8_t commandParams[1] = {NotepadID};
 
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_READ_NOTEPAD, commandParams, 1);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_READ_NOTEPAD, 1>(commandParams)) {
         serialPrintln("Failed to send PS_ReadNotepad command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_ReadNotepad response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1115,19 +1301,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_ReadNotepad(uint8_t NotepadID, uint8
 // 读有效模板个数 - 获取指纹库中已存储的有效模板数量 / Read valid template count - Get the number of valid templates stored in fingerprint library
 fingerprint_status_t M5UnitFingerprint2::PS_ValidTemplateNum(uint16_t &ValidNum) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_VALID_MODEL_COUNT, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_VALID_MODEL_COUNT>()) {
         serialPrintln("Failed to send PS_ValidTemplateNum command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_ValidTemplateNum response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1185,19 +1367,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_ReadIndexTable(uint8_t* IndexTableDa
     // 准备命令参数：索引表号(1字节) / Prepare command parameters: Index table ID (1 byte)
     uint8_t commandParams[1] = {IndexTableID};
 
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_READ_INDEX_TABLE, commandParams, 1);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_READ_INDEX_TABLE, 1>(commandParams)) {
         serialPrintln("Failed to send PS_ReadIndexTable command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_ReadIndexTable response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1284,19 +1462,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_GetChipSN(uint8_t* ChipSN) const
     // 准备命令参数：预留(1字节) / Prepare command parameters: Reserved (1 byte)
     uint8_t commandParams[1] = {0};
 
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_CHIP_SN, commandParams, 1);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_CHIP_SN, 1>(commandParams)) {
         serialPrintln("Failed to send PS_GetChipSN command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_GetChipSN response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1345,19 +1519,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_GetChipSN(uint8_t* ChipSN) const
 // 握手指令 - 检查模块是否正常工作 / Handshake command - Check if module is working properly
 fingerprint_status_t M5UnitFingerprint2::PS_HandShake(void) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_HAND_SHAKE, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_HAND_SHAKE>()) {
         serialPrintln("Failed to send PS_HandShake command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_HandShake response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1389,19 +1559,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_HandShake(void) const
 // 校验传感器 - 检查传感器是否正常工作 / Check sensor - Check if sensor is working properly
 fingerprint_status_t M5UnitFingerprint2::PS_CheckSensor(void) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_CHECK_SENSOR, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_CHECK_SENSOR>()) {
         serialPrintln("Failed to send PS_CheckSensor command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_CheckSensor response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1458,19 +1624,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_ControlBLN(fingerprint_led_control_m
         loopCount                          // 循环次数 / Loop count
     };
 
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_CONTROL_LED, commandParams, 4);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_CONTROL_LED, 4>(commandParams)) {
         serialPrintln("Failed to send PS_ControlBLN command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_ControlBLN response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1507,19 +1669,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_GetImageInfo(uint8_t &imageArea, uin
     imageArea = 0;
     imageQuality = 0xFF; // 默认设为不合格 / Default set to unqualified
 
-    // 创建命令数据包（无参数） / Create command packet (no parameters)
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_GET_IMAGE_INFO, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_GET_IMAGE_INFO>()) {
         serialPrintln("Failed to send PS_GetImageInfo command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_GetImageInfo response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1577,19 +1735,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_SearchNow(uint16_t StartPage, uint16
         static_cast<uint8_t>((PageNum >> 8) & 0xFF), static_cast<uint8_t>(PageNum & 0xFF)       // 搜索页数 / Search page count
     };
 
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_SEARCH_NOW, commandParams, 4);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_SEARCH_NOW, 4>(commandParams)) {
         serialPrintln("Failed to send PS_SearchNow command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_SearchNow response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1629,19 +1783,24 @@ fingerprint_status_t M5UnitFingerprint2::PS_SearchNow(uint16_t StartPage, uint16
 // 取消指令 - 取消当前正在执行的自动注册或自动验证操作 / Cancel command - Cancel currently executing auto enrollment or auto verification operation
 fingerprint_status_t M5UnitFingerprint2::PS_Cancel(void) const
 {
-    // 创建命令数据包 - 使用命令代码 0x30 / Create command packet - Use command code 0x30
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_CANCEL_AUTO_FLOW, nullptr, 0);
+    // 自动流程进行中：立即发出取消命令，其应答由流程循环代收 / An auto flow is running: send the cancel command right away, its reply is collected by the flow's loop
+    M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
+    fingerprint_status_t cancelResult;
+    if (nonConstThis->cancelAutoFlow(cancelResult)) {
+        serialPrintf("Cancel auto operation result: %s [confirmation: %s]\r\n",
+                     (cancelResult == FINGERPRINT_OK) ? "Success" : "Failed",
+                     FingerprintDebugUtils::getStatusName(cancelResult).c_str());
+        return cancelResult;
+    }
 
     // 发送命令包 / Send command packet
-    M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_CANCEL_AUTO_FLOW>()) {
         serialPrintln("Failed to send PS_Cancel command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_Cancel response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1670,6 +1829,128 @@ fingerprint_status_t M5UnitFingerprint2::PS_Cancel(void) const
     return static_cast<fingerprint_status_t>(confirmationCode);
 }
 
+// 标记自动流程开始 / Mark the start of an auto flow
+void M5UnitFingerprint2::beginAutoFlow(uint8_t command)
+{
+    acquireMutex();
+    _autoFlowCommand = command;
+    _cancelState     = CANCEL_IDLE;
+    releaseMutex();
+}
+
+// 结束自动流程，先收取已注入的取消命令的应答 / End an auto flow, first collecting the reply to an injected cancel command
+void M5UnitFingerprint2::endAutoFlow()
+{
+    acquireMutex();
+    bool pending = (_cancelState == CANCEL_PENDING);
+    if (!pending) {
+        _autoFlowCommand = 0;
+    }
+    releaseMutex();
+    if (!pending) {
+        return;
+    }
+
+    // 流程可能先于取消应答结束 / The flow may have ended before the cancel reply arrived
+    unsigned long startTime = millis();
+    unsigned long elapsed;
+    while (pending && (elapsed = millis() - startTime) < 1000) {
+        Fingerprint_PacketView packet;
+        if (!receivePacketData(packet, 1000 - elapsed)) {
+            break;
+        }
+        pending = !takeCancelReply(packet);
+    }
+
+    acquireMutex();
+    if (_cancelState == CANCEL_PENDING) {
+        finishCancelLocked(FINGERPRINT_PACKET_TIMEOUT);
+    }
+    _autoFlowCommand = 0;
+    releaseMutex();
+}
+
+// 向进行中的自动流程立即注入取消命令，不等待应答 / Inject a cancel command into a running auto flow at once, without waiting for its reply
+bool M5UnitFingerprint2::injectCancel()
+{
+    acquireMutex();
+    if (_autoFlowCommand == 0) {
+        releaseMutex();
+        return false;
+    }
+    bool send = (_cancelState == CANCEL_IDLE);
+    if (send) {
+        _cancelState = CANCEL_PENDING;
+    }
+    releaseMutex();
+
+    // 不经过 sendCommand()，以免清空流程尚未取走的应答 / Bypass sendCommand() so acknowledges the flow has not claimed yet are kept
+    if (send) {
+        uint8_t frame[Fingerprint_CommandEncoder<FINGERPRINT_CANCEL_AUTO_FLOW>::frameSize];
+        size_t length = Fingerprint_CommandEncoder<FINGERPRINT_CANCEL_AUTO_FLOW>::encode(frame, _fp2_address, nullptr);
+        acquireTxMutex();
+        bool written = writeBytesLocked(frame, length);
+        releaseTxMutex();
+        if (!written) {
+            serialPrintln("Failed to send PS_Cancel command");
+            acquireMutex();
+            finishCancelLocked(FINGERPRINT_PACKET_TIMEOUT);
+            releaseMutex();
+        }
+    }
+    return true;
+}
+
+// 注入取消命令并等待结果 / Inject a cancel command and wait for the result
+bool M5UnitFingerprint2::cancelAutoFlow(fingerprint_status_t& result)
+{
+    if (!injectCancel()) {
+        return false;
+    }
+
+    // 流程循环收到取消应答（或放弃等待）后结束 / Finished once the flow's loop has the cancel reply (or gave up waiting for it)
+    unsigned long startTime = millis();
+    while (_cancelState.load(std::memory_order_acquire) != CANCEL_DONE) {
+        if (millis() - startTime >= 2000) {
+            result = FINGERPRINT_PACKET_TIMEOUT;
+            return true;
+        }
+        // 没有解析任务时自动流程会话的应答由本任务解析 / Without a parse task this task parses the reply for an auto flow session
+        if (parsesInline()) {
+            receiveSerialData();
+            checkAndParsePackets();
+        }
+        delay(1);
+    }
+
+    acquireMutex();
+    result       = _cancelResult;
+    _cancelState = CANCEL_IDLE;
+    releaseMutex();
+    return true;
+}
+
+// 识别取消命令的应答：只有确认码，自动流程的应答都带参数 / Recognise the cancel reply: it carries only the confirmation code, whereas auto flow replies carry parameters
+bool M5UnitFingerprint2::takeCancelReply(const Fingerprint_PacketView& packet)
+{
+    if (packet.get_type() != FINGERPRINT_PACKET_ACKPACKET || packet.get_actual_data_length() != 1) {
+        return false;
+    }
+    acquireMutex();
+    bool pending = (_cancelState == CANCEL_PENDING);
+    if (pending) {
+        finishCancelLocked(static_cast<fingerprint_status_t>(packet.get_data()[0]));
+    }
+    releaseMutex();
+    return pending;
+}
+
+void M5UnitFingerprint2::finishCancelLocked(fingerprint_status_t result)
+{
+    _cancelResult = result;
+    _cancelState.store(CANCEL_DONE, std::memory_order_release);
+}
+
 
 // 特殊上传模板 - 从指纹模块上传模板数据到主控 / Special upload template - Upload template data from fingerprint module to host controller
 fingerprint_status_t M5UnitFingerprint2::PS_UploadTemplate(uint16_t offset, uint16_t uploadSize, uint16_t &actualSize, uint8_t* templateData) const
@@ -1689,18 +1970,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_UploadTemplate(uint16_t offset, uint
     commandData[2] = (uploadSize >> 8) & 0xFF;
     commandData[3] = uploadSize & 0xFF;
 
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_UP_TEMPLATE, commandData, 4);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_UP_TEMPLATE, 4>(commandData)) {
         serialPrintln("Failed to send PS_UploadTemplate command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收ACK响应包 / Receive ACK response packet
-    Fingerprint_Packet ackPacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView ackPacket;
     if (!nonConstThis->receivePacketData(ackPacket, 10000)) {
         serialPrintln("Failed to receive PS_UploadTemplate ACK response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1778,37 +2056,21 @@ fingerprint_status_t M5UnitFingerprint2::PS_UploadTemplate(uint16_t offset, uint
 fingerprint_status_t M5UnitFingerprint2::PS_DownloadTemplate(uint16_t offset, uint16_t downloadSize, const uint8_t* templateData) const
 {
     // 参数检查 / Parameter check
-    if (templateData == nullptr || downloadSize == 0) {
+    if (templateData == nullptr || downloadSize == 0 || downloadSize > FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX) {
         serialPrintln("Invalid parameters for PS_DownloadTemplate");
         return FINGERPRINT_PARAM_ERROR;
     }
 
-    // 创建命令数据包 - 参数：偏移地址(2字节) + 下载大小(2字节) + 模板数据 / Create command packet - Parameters: Offset address (2 bytes) + Download size (2 bytes) + Template data
-    uint8_t* commandData = new uint8_t[4 + downloadSize];
-    commandData[0] = (offset >> 8) & 0xFF;
-    commandData[1] = offset & 0xFF;
-    commandData[2] = (downloadSize >> 8) & 0xFF;
-    commandData[3] = downloadSize & 0xFF;
-    
-    // 将模板数据复制到命令数据包中 / Copy template data to command packet
-    memcpy(&commandData[4], templateData, downloadSize);
-
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_DOWN_TEMPLATE, commandData, 4 + downloadSize);
-
-    // 发送命令包 / Send command packet
+    // 发送命令包，模板数据直接从调用者的缓冲区写出 / Send command packet; the template data is written straight from the caller's buffer
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    uint32_t seq;
+    if (!nonConstThis->sendTemplateChunk(offset, templateData, downloadSize, true, seq)) {
         serialPrintln("Failed to send PS_DownloadTemplate command");
-        delete[] commandData;
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
-    // 释放内存 / Release memory
-    delete[] commandData;
-
     // 接收ACK响应包 / Receive ACK response packet
-    Fingerprint_Packet ackPacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView ackPacket;
     if (!nonConstThis->receivePacketData(ackPacket, 10000)) {
         serialPrintln("Failed to receive PS_DownloadTemplate ACK response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -1868,107 +2130,80 @@ fingerprint_status_t M5UnitFingerprint2::PS_DownloadTemplateAuto(
         return FINGERPRINT_PARAM_ERROR;
     }
 
-    uint16_t offset = 0;               // 起始偏移地址 / Start offset address
-    uint16_t downloadSize = 100;       // 每次发送的下载大小 / Download size per transmission
-    uint32_t totalSize = 0;            // 累计发送的总大小 / Total size sent cumulatively
-    int packetCount = 0;               // 数据包计数器 / Packet counter
-    bool downloadComplete = false;     // 下载完成标志 / Download complete flag
-    bool callbackAborted = false;      // 回调中止标志 / Callback aborted flag
-    
-    serialPrintln("PS_DownloadTemplateAuto: Starting automatic template download...");
-    serialPrintf("Template size: %d bytes, download packet size: %d bytes\r\n", actualSize, downloadSize);
-    
-    // 循环发送所有模板数据包 / Loop to send all template data packets
-    while (!downloadComplete && !callbackAborted) {
-        packetCount++;
-        
-        // 计算当前包的实际发送大小 / Calculate actual send size of current packet
-        uint16_t currentDownloadSize = downloadSize;
-        if (totalSize + downloadSize > actualSize) {
-            // 最后一个包，调整大小 / Last packet, adjust size
-            currentDownloadSize = actualSize - totalSize;
-        }
-        
-        // 检查是否是最后一个数据包 / Check if it's the last data packet
-        if (totalSize + currentDownloadSize >= actualSize) {
-            downloadComplete = true;
-        }
-        
-        // 调用原始的PS_DownloadTemplate函数发送一个数据包 / Call original PS_DownloadTemplate function to send one data packet
-        fingerprint_status_t result = PS_DownloadTemplate(offset, currentDownloadSize, 
-                                                          templateBuffer + totalSize);
-        
-        if (result != FINGERPRINT_OK) {
-            serialPrintf("PS_DownloadTemplateAuto: Download failed at packet #%d (offset %d), error: %s\r\n", 
-                        packetCount, offset, 
-                        FingerprintDebugUtils::getStatusName(result).c_str());
-            return result;
-        }
-        
-        // 打印当前包信息 / Print current packet information
-        serialPrintf("PS_DownloadTemplateAuto: Packet #%d - offset=%d, sent=%d bytes\r\n",
-                    packetCount, offset, currentDownloadSize);
-        
-        // 更新偏移量和总大小 / Update offset and total size
-        offset += currentDownloadSize;
-        totalSize += currentDownloadSize;
-        
-        // 调用进度回调函数（如果提供） / Call progress callback function (if provided)
-        if (callback != nullptr) {
-            bool continueDownload = callback(currentDownloadSize, totalSize, packetCount, downloadComplete);
-            if (!continueDownload) {
-                serialPrintln("PS_DownloadTemplateAuto: Download aborted by callback function");
-                callbackAborted = true;
-                return FINGERPRINT_OPERATION_BLOCKED;
-            }
-        }
-        
-        // 防止无限循环的安全检查 / Safety check to prevent infinite loop
-        if (packetCount > 1000) {
-            serialPrintln("PS_DownloadTemplateAuto: Too many packets sent, stopping for safety");
-            return FINGERPRINT_PACKET_OVERFLOW;
-        }
-    }
-    
-    if (downloadComplete && !callbackAborted) {
-        serialPrintf("PS_DownloadTemplateAuto: Download completed successfully!\r\n");
-        serialPrintf("Total packets sent: %d\r\n", packetCount);
-        serialPrintf("Total template data size: %d bytes\r\n", totalSize);
-        
-        // 最后一次调用回调函数通知完成 / Call callback function one last time to notify completion
-        if (callback != nullptr) {
-            callback(0, totalSize, packetCount, true);
-        }
-        
-#if defined M5_MODULE_DEBUG_SERIAL
-        // 显示模板数据预览 / Display template data preview
-        if (totalSize > 0) {
-            serialPrint("Template data preview (first 16 bytes): ");
-            for (int i = 0; i < 16 && i < totalSize; i++) {
-                M5_MODULE_DEBUG_SERIAL.printf("%02X ", templateBuffer[i]);
+    // 模组支持 09H 时整个模板一条命令传完，否则（或探测失败时）回退到 7BH 分段 / If the module supports 09H the whole template moves in one command; otherwise (or when the probe fails) fall back to 7BH chunks
+    if (_charTransfer.load() != FINGERPRINT_CHAR_TRANSFER_UNSUPPORTED) {
+        fingerprint_status_t result = PS_DownChar(FINGERPRINT_CHAR_TRANSFER_BUFFER_ID, templateBuffer, actualSize);
+        if (_charTransfer.load() == FINGERPRINT_CHAR_TRANSFER_SUPPORTED) {
+            if (result == FINGERPRINT_OK && callback != nullptr) {
+                uint16_t currentSize = (actualSize > 0xFFFF) ? 0xFFFF : static_cast<uint16_t>(actualSize);
+                if (!callback(currentSize, actualSize, 1, false)) {
+                    serialPrintln("PS_DownloadTemplateAuto: Download aborted by callback function");
+                    return FINGERPRINT_OPERATION_BLOCKED;
+                }
+                callback(0, actualSize, 1, true);
             }
-            M5_MODULE_DEBUG_SERIAL.println("");
+            return result;
         }
-#endif
-        
-        return FINGERPRINT_OK;
-    } else if (callbackAborted) {
-        serialPrintf("PS_DownloadTemplateAuto: Download aborted by callback after %d packets, %d bytes sent\r\n",
-                    packetCount, totalSize);
-        return FINGERPRINT_OPERATION_BLOCKED;
-    } else {
-        serialPrintf("PS_DownloadTemplateAuto: Download incomplete, %d bytes sent\r\n", totalSize);
-        return FINGERPRINT_TIMEOUT;
+        serialPrintln("PS_DownloadTemplateAuto: PS_DownChar not supported, using PS_DownloadTemplate");
     }
+
+    return const_cast<M5UnitFingerprint2*>(this)->downloadTemplateChunks(templateBuffer, actualSize, callback);
 }
 
-// 特殊上传模板自动版本 - 自动循环上传完整模板数据 / Special upload template auto version - Automatically loop upload complete template data
+// 特殊上传模板自动版本 - 自动上传完整模板数据 / Special upload template auto version - Automatically upload complete template data
 fingerprint_status_t M5UnitFingerprint2::PS_UploadTemplateAuto(
     uint8_t* templateBuffer,        // 上传缓冲区 / Upload buffer
     uint32_t bufferSize,            // 缓冲区大小 / Buffer size
     uint32_t& actualSize,           // 返回的实际上传大小 / Returned actual upload size
     PS_UploadTemplateCallback_t callback // 每接收一段数据时的回调 / Callback when receiving each data segment
 ) const
+{
+    TemplateProgress progress;
+    progress.callback = callback;
+    progress.startUs  = static_cast<uint32_t>(micros());
+    return const_cast<M5UnitFingerprint2*>(this)->uploadTemplate(templateBuffer, bufferSize, actualSize, progress);
+}
+
+// 特殊上传模板自动版本（计时回调） / Special upload template auto version (timed callback)
+fingerprint_status_t M5UnitFingerprint2::PS_UploadTemplateAuto(uint8_t* templateBuffer, uint32_t bufferSize,
+                                                               uint32_t& actualSize,
+                                                               PS_UploadTemplateTimedCallback_t callback,
+                                                               void* context) const
+{
+    TemplateProgress progress;
+    progress.timedCallback = callback;
+    progress.context       = context;
+    progress.startUs       = static_cast<uint32_t>(micros());
+    return const_cast<M5UnitFingerprint2*>(this)->uploadTemplate(templateBuffer, bufferSize, actualSize, progress);
+}
+
+// 报告上传进度 / Report upload progress
+bool M5UnitFingerprint2::TemplateProgress::report(uint16_t currentSize, uint32_t totalSize, int packetCount,
+                                                  bool isComplete) const
+{
+    if (timedCallback != nullptr) {
+        return timedCallback(currentSize, totalSize, packetCount, isComplete,
+                             static_cast<uint32_t>(micros()) - startUs, context);
+    }
+    if (callback != nullptr) {
+        return callback(currentSize, totalSize, packetCount, isComplete);
+    }
+    return true;
+}
+
+uint16_t M5UnitFingerprint2::getTemplateChunkSize() const
+{
+    return (_templateChunkFirmware == _firmwareVersion.load()) ? _templateChunkSize : 0;
+}
+
+uint16_t M5UnitFingerprint2::getTemplateDownloadChunkSize() const
+{
+    return (_downloadChunkFirmware == _firmwareVersion.load()) ? _downloadChunkSize : 0;
+}
+
+// 上传完整模板 / Upload the complete template
+fingerprint_status_t M5UnitFingerprint2::uploadTemplate(uint8_t* templateBuffer, uint32_t bufferSize,
+                                                        uint32_t& actualSize, const TemplateProgress& progress)
 {
     // 参数检查 / Parameter check
     if (templateBuffer == nullptr || bufferSize == 0) {
@@ -1977,117 +2212,452 @@ fingerprint_status_t M5UnitFingerprint2::PS_UploadTemplateAuto(
     }
 
     actualSize = 0; // 初始化实际上传大小 / Initialize actual upload size
-    
-    uint16_t offset = 0;               // 起始偏移地址 / Start offset address
-    uint16_t uploadSize = 100;         // 每次请求的上传大小 / Upload size per request
-    uint16_t currentActualSize = 0;    // 当前包的实际大小 / Actual size of current packet
-    uint32_t totalSize = 0;            // 累计接收的总大小 / Total size received cumulatively
-    int packetCount = 0;               // 数据包计数器 / Packet counter
-    bool uploadComplete = false;       // 上传完成标志 / Upload complete flag
-    bool callbackAborted = false;      // 回调中止标志 / Callback aborted flag
-    
-    serialPrintln("PS_UploadTemplateAuto: Starting automatic template upload...");
-    serialPrintf("Buffer size: %d bytes, upload packet size: %d bytes\r\n", bufferSize, uploadSize);
-    
-    // 清空缓冲区 / Clear buffer
-    memset(templateBuffer, 0, bufferSize);
-    
-    // 循环接收所有模板数据包 / Loop to receive all template data packets
-    while (!uploadComplete && !callbackAborted) {
-        // 检查缓冲区是否足够容纳下一个数据包 / Check if buffer has enough space for next data packet
-        if (totalSize + uploadSize > bufferSize) {
-            serialPrintf("PS_UploadTemplateAuto: Buffer size insufficient. Required: %d, Available: %d\r\n", 
-                        totalSize + uploadSize, bufferSize);
-            return FINGERPRINT_PACKET_OVERFLOW;
-        }
-        
-        packetCount++;
-        
-        // 调用原始的PS_UploadTemplate函数获取一个数据包 / Call original PS_UploadTemplate function to get one data packet
-        fingerprint_status_t result = PS_UploadTemplate(offset, uploadSize, currentActualSize, 
-                                                        templateBuffer + totalSize);
-        
-        if (result != FINGERPRINT_OK) {
-            serialPrintf("PS_UploadTemplateAuto: Upload failed at packet #%d (offset %d), error: %s\r\n", 
-                        packetCount, offset, 
-                        FingerprintDebugUtils::getStatusName(result).c_str());
-            actualSize = totalSize; // 返回已经接收到的数据大小 / Return already received data size
-            return result;
-        }
-        
-        // 打印当前包信息 / Print current packet information
-        serialPrintf("PS_UploadTemplateAuto: Packet #%d - offset=%d, requested=%d, received=%d bytes\r\n",
-                    packetCount, offset, uploadSize, currentActualSize);
-        
-        // 检查是否是最后一个数据包 / Check if it's the last data packet
-        if (currentActualSize == 0) {
-            // 实际接收大小为0，表示模板数据传输完成 / Actual received size is 0, indicating template data transfer is complete
-            serialPrintln("PS_UploadTemplateAuto: Template upload completed (actualSize = 0)");
-            uploadComplete = true;
-        } else {
-            // 更新偏移量和总大小 / Update offset and total size
-            offset += currentActualSize;
-            totalSize += currentActualSize;
-            
-            // 调用进度回调函数（如果提供） / Call progress callback function (if provided)
-            if (callback != nullptr) {
-                bool continueUpload = callback(currentActualSize, totalSize, packetCount, uploadComplete);
-                if (!continueUpload) {
+
+    // 模组支持 08H 时整个模板一条命令传完，否则（或探测失败时）回退到 7AH 分段 / If the module supports 08H the whole template moves in one command; otherwise (or when the probe fails) fall back to 7AH chunks
+    if (_charTransfer.load() != FINGERPRINT_CHAR_TRANSFER_UNSUPPORTED) {
+        fingerprint_status_t result = PS_UpChar(FINGERPRINT_CHAR_TRANSFER_BUFFER_ID, templateBuffer, bufferSize, actualSize);
+        if (_charTransfer.load() == FINGERPRINT_CHAR_TRANSFER_SUPPORTED) {
+            if (result == FINGERPRINT_OK) {
+                uint16_t currentSize = (actualSize > 0xFFFF) ? 0xFFFF : static_cast<uint16_t>(actualSize);
+                if (!progress.report(currentSize, actualSize, 1, false)) {
                     serialPrintln("PS_UploadTemplateAuto: Upload aborted by callback function");
-                    callbackAborted = true;
-                    actualSize = totalSize;
                     return FINGERPRINT_OPERATION_BLOCKED;
                 }
+                progress.report(0, actualSize, 1, true);
             }
+            return result;
         }
-        
-        // 防止无限循环的安全检查 / Safety check to prevent infinite loop
-        if (packetCount > 1000) {
-            serialPrintln("PS_UploadTemplateAuto: Too many packets received, stopping for safety");
-            actualSize = totalSize;
-            return FINGERPRINT_PACKET_OVERFLOW;
+        serialPrintln("PS_UploadTemplateAuto: PS_UpChar not supported, using PS_UploadTemplate");
+        actualSize = 0;
+    }
+
+    return uploadTemplateChunks(templateBuffer, bufferSize, actualSize, progress);
+}
+
+// 发送一个 7AH 请求 / Send one 7AH request
+bool M5UnitFingerprint2::sendTemplateRequest(uint16_t offset, uint16_t size, bool first, uint32_t& seq)
+{
+    // 参数：偏移地址(2字节) + 上传大小(2字节) / Parameters: Offset address (2 bytes) + Upload size (2 bytes)
+    uint8_t params[4] = {static_cast<uint8_t>(offset >> 8), static_cast<uint8_t>(offset & 0xFF),
+                         static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size & 0xFF)};
+
+    uint8_t frame[Fingerprint_CommandEncoder<FINGERPRINT_UP_TEMPLATE, 4>::frameSize];
+    size_t length = Fingerprint_CommandEncoder<FINGERPRINT_UP_TEMPLATE, 4>::encode(frame, _fp2_address, params);
+
+    acquireTxMutex();
+    acquireMutex();
+    if (first) {
+        beginCommandLocked(FINGERPRINT_UP_TEMPLATE);
+        seq = _lastCommandSeq;
+    } else {
+        seq = nextCommandSequence();
+    }
+    releaseMutex();
+    bool written = writeBytesLocked(frame, length);
+    releaseTxMutex();
+    return written;
+}
+
+// 7AH 分段上传：段长未知时逐段往返并学习段长，已知时流水线发送请求 / 7AH chunked upload: one round trip per chunk while the chunk size is learned, pipelined requests once it is known
+fingerprint_status_t M5UnitFingerprint2::uploadTemplateChunks(uint8_t* templateBuffer, uint32_t bufferSize,
+                                                              uint32_t& actualSize, const TemplateProgress& progress)
+{
+    // 7AH 的偏移地址为 16 位 / 7AH offsets are 16-bit
+    uint32_t capacity = (bufferSize > 0xFFFF) ? 0xFFFF : bufferSize;
+
+    // 段长按固件版本缓存，版本未知时先读取 / The chunk size is cached per firmware version; read the version first if unknown
+    if (_firmwareVersion.load() == FINGERPRINT_FIRMWARE_VERSION_UNKNOWN) {
+        uint8_t version;
+        PS_GetFirmwareVersion(version);
+    }
+    uint16_t firmware = _firmwareVersion.load();
+    bool learning     = (_templateChunkSize == 0 || _templateChunkFirmware != firmware);
+    uint16_t chunk    = learning ? FINGERPRINT_TEMPLATE_CHUNK_MAX : _templateChunkSize;
+    uint8_t depth     = learning ? 1 : FINGERPRINT_TEMPLATE_PIPELINE_DEPTH;
+
+    serialPrintf("PS_UploadTemplateAuto: %s 7AH chunks of %d bytes\r\n", learning ? "learning with" : "pipelining",
+                 chunk);
+
+    // 在途请求，按发送顺序应答 / Requests in flight, answered in send order
+    struct Request {
+        uint16_t offset;
+        uint16_t size;
+        uint32_t seq;
+    };
+    Request inFlight[FINGERPRINT_TEMPLATE_PIPELINE_DEPTH];
+    uint8_t head  = 0;
+    uint8_t count = 0;
+
+    uint32_t nextOffset         = 0;      // 下一个请求的偏移 / Offset of the next request
+    uint32_t received           = 0;      // 已写入缓冲区的字节数 / Bytes written to the buffer
+    int packetCount             = 0;      // 非空应答计数 / Non-empty replies
+    bool issuing                = true;   // 是否继续发送请求 / Whether to keep sending requests
+    bool ended                  = false;  // 已收到短应答，之后的应答应为空 / A short reply arrived; the replies after it must be empty
+    uint16_t capSize            = 0;      // 学习时第一个短应答的长度 / Length of the first short reply while learning
+    bool capped                 = false;  // 短应答之后仍有数据：模组按 capSize 截断应答 / Data followed a short reply: the module caps replies at capSize
+    bool relearn                = false;  // 缓存的段长与模组不符 / The cached chunk size does not match the module
+    fingerprint_status_t result = FINGERPRINT_OK;
+
+    while (result == FINGERPRINT_OK && (issuing || count > 0)) {
+        // 流水线未满时继续发送；缓冲区已满时请求 1 字节，确认模板已经结束 / Keep sending while the pipeline has room; with the buffer full, ask for 1 byte to confirm the template has ended
+        while (issuing && count < depth) {
+            uint16_t size = (nextOffset < capacity)
+                                ? static_cast<uint16_t>((capacity - nextOffset < chunk) ? capacity - nextOffset : chunk)
+                                : 1;
+            Request& request = inFlight[(head + count) % FINGERPRINT_TEMPLATE_PIPELINE_DEPTH];
+            request.offset   = static_cast<uint16_t>(nextOffset);
+            request.size     = size;
+            if (!sendTemplateRequest(request.offset, size, count == 0, request.seq)) {
+                serialPrintln("Failed to send PS_UploadTemplate command");
+                result = FINGERPRINT_PACKET_TIMEOUT;
+                break;
+            }
+            count++;
+            issuing = (nextOffset < capacity);
+            nextOffset += size;
         }
-        
-        // 如果缓冲区即将满，提前结束以避免溢出 / If buffer is nearly full, end early to avoid overflow
-        if (totalSize >= bufferSize - uploadSize) {
-            serialPrintln("PS_UploadTemplateAuto: Buffer nearly full, ending upload");
-            uploadComplete = true;
+        if (result != FINGERPRINT_OK) {
+            break;
         }
-    }
-    
-    // 设置最终的实际大小 / Set final actual size
-    actualSize = totalSize;
-    
-    if (uploadComplete && !callbackAborted) {
-        serialPrintf("PS_UploadTemplateAuto: Upload completed successfully!\r\n");
-        serialPrintf("Total packets received: %d\r\n", packetCount);
-        serialPrintf("Total template data size: %d bytes\r\n", actualSize);
-        
-        // 最后一次调用回调函数通知完成 / Call callback function one last time to notify completion
-        if (callback != nullptr) {
-            callback(0, actualSize, packetCount, true);
+
+        Request request = inFlight[head];
+        head            = (head + 1) % FINGERPRINT_TEMPLATE_PIPELINE_DEPTH;
+        count--;
+
+        // 等待最早的请求的应答，超时时为它留下墓碑 / Wait for the earliest request's reply, leaving a tombstone for it on timeout
+        acquireMutex();
+        _lastCommand     = FINGERPRINT_UP_TEMPLATE;
+        _lastCommandSeq  = request.seq;
+        uint32_t dropped = _staleReplies;
+        releaseMutex();
+        Fingerprint_PacketView ackPacket;
+        bool answered = receivePacketData(ackPacket, FINGERPRINT_TEMPLATE_CHUNK_ACK_TIMEOUT_MS);
+
+        // 学习时超时但期间有应答被当作迟到应答丢弃：模组已应答，同样长度重发 / A timeout while learning, but a reply was dropped as late meanwhile: the module did answer, so request the same size again
+        if (learning && !answered && droppedStaleReply(dropped)) {
+            nextOffset = request.offset;
+            issuing    = true;
+            serialPrintln("PS_UploadTemplateAuto: reply dropped as a late reply, requesting again");
+            continue;
         }
-        
-#if defined M5_MODULE_DEBUG_SERIAL
-        // 显示模板数据预览 / Display template data preview
-        if (actualSize > 0) {
-            serialPrint("Template data preview (first 16 bytes): ");
-            for (int i = 0; i < 16 && i < actualSize; i++) {
-                M5_MODULE_DEBUG_SERIAL.printf("%02X ", templateBuffer[i]);
+
+        uint8_t confirmationCode = FINGERPRINT_PACKET_TIMEOUT;
+        uint16_t replySize       = 0;
+        if (answered) {
+            if (ackPacket.get_type() != FINGERPRINT_PACKET_ACKPACKET || ackPacket.get_actual_data_length() < 3) {
+                serialPrintln("Invalid ACK packet for PS_UploadTemplate");
+                result = FINGERPRINT_PACKET_BADPACKET;
+                break;
+            }
+            const uint8_t* ackData = ackPacket.get_data();
+            confirmationCode       = ackData[0];
+            replySize              = (ackData[1] << 8) | ackData[2];
+            // 只取实际携带且不超过请求的数据 / Take only the data actually carried, and no more than requested
+            uint16_t carried = ackPacket.get_actual_data_length() - 3;
+            if (replySize > carried) {
+                replySize = carried;
+            }
+            if (replySize > request.size) {
+                replySize = request.size;
             }
-            M5_MODULE_DEBUG_SERIAL.println("");
         }
-#endif
-        
-        return FINGERPRINT_OK;
-    } else if (callbackAborted) {
-        serialPrintf("PS_UploadTemplateAuto: Upload aborted by callback after %d packets, %d bytes received\r\n",
-                    packetCount, actualSize);
-        return FINGERPRINT_OPERATION_BLOCKED;
+
+        // 学习时第一段没有应答或被拒绝且没有数据：段长减半后重试 / While learning, no reply or a rejection without data for the first chunk: halve the chunk and retry
+        if (learning && request.offset == 0 && replySize == 0 && confirmationCode != FINGERPRINT_OK &&
+            chunk > FINGERPRINT_TEMPLATE_CHUNK_MIN) {
+            chunk      = (chunk / 2 < FINGERPRINT_TEMPLATE_CHUNK_MIN) ? FINGERPRINT_TEMPLATE_CHUNK_MIN : chunk / 2;
+            nextOffset = 0;
+            issuing    = true;
+            serialPrintf("PS_UploadTemplateAuto: chunk rejected, retrying with %d bytes\r\n", chunk);
+            continue;
+        }
+        if (!answered) {
+            result = FINGERPRINT_PACKET_TIMEOUT;
+            break;
+        }
+        if (confirmationCode != FINGERPRINT_OK) {
+            serialPrintf("PS_UploadTemplate command failed [confirmation: %s]\r\n",
+                         FingerprintDebugUtils::getStatusName(confirmationCode).c_str());
+        }
+
+        // 空应答：模板结束 / Empty reply: the template has ended
+        if (replySize == 0) {
+            issuing = false;
+            continue;
+        }
+
+        // 缓冲区已满后仍有数据 / Data remains after the buffer is full
+        if (request.offset >= capacity) {
+            serialPrintf("PS_UploadTemplateAuto: Buffer size insufficient, %d bytes available\r\n", capacity);
+            result = FINGERPRINT_PACKET_OVERFLOW;
+            break;
+        }
+
+        // 短应答之后又有数据：缓存的段长与模组不符，按学习模式重新上传 / Data after a short reply: the cached chunk size does not match the module, so upload again while learning
+        if (ended) {
+            serialPrintln("PS_UploadTemplateAuto: cached chunk size does not match, learning again");
+            _templateChunkSize = 0;
+            relearn            = true;
+            break;
+        }
+
+        memcpy(templateBuffer + request.offset, ackPacket.get_data() + 3, replySize);
+        ackPacket.release();
+        received = request.offset + replySize;
+        packetCount++;
+
+        if (replySize < request.size) {
+            if (!learning) {
+                // 短应答即最后一段，已发出的请求应得到空应答 / A short reply is the last chunk; requests already sent should get empty replies
+                ended   = true;
+                issuing = false;
+            } else if (capSize == 0) {
+                capSize = replySize;
+            } else {
+                capped = true;
+            }
+        } else if (learning && capSize != 0) {
+            capped = true;
+        }
+        if (learning) {
+            nextOffset = received;
+        }
+
+        // 调用进度回调函数（如果提供） / Call progress callback function (if provided)
+        if (!progress.report(replySize, received, packetCount, false)) {
+            serialPrintln("PS_UploadTemplateAuto: Upload aborted by callback function");
+            result = FINGERPRINT_OPERATION_BLOCKED;
+            break;
+        }
+    }
+
+    // 提前结束时为仍在途的请求留下墓碑 / On an early exit, leave tombstones for the requests still in flight
+    acquireMutex();
+    for (; count > 0; count--) {
+        retireCommand(FINGERPRINT_UP_TEMPLATE, inFlight[head].seq);
+        head = (head + 1) % FINGERPRINT_TEMPLATE_PIPELINE_DEPTH;
+    }
+    _lastCommand = 0;
+    releaseMutex();
+
+    actualSize = received;
+
+    if (relearn) {
+        actualSize = 0;
+        return uploadTemplateChunks(templateBuffer, bufferSize, actualSize, progress);
+    }
+    if (result != FINGERPRINT_OK) {
+        serialPrintf("PS_UploadTemplateAuto: Upload failed after %d bytes, error: %s\r\n", received,
+                     FingerprintDebugUtils::getStatusName(result).c_str());
+        return result;
+    }
+
+    // 学习完成：模组截断应答时取截断长度，否则取被接受的请求段长；空模板不说明段长 / Learning done: the cap if the module capped replies, otherwise the accepted request size; an empty template tells nothing
+    if (learning && received > 0) {
+        _templateChunkSize     = capped ? capSize : chunk;
+        _templateChunkFirmware = firmware;
+    }
+
+    serialPrintf("PS_UploadTemplateAuto: Upload completed, %d bytes in %d replies\r\n", actualSize, packetCount);
+    progress.report(0, actualSize, packetCount, true);
+    return FINGERPRINT_OK;
+}
+
+// 自 dropped 记录以来是否有应答被当作迟到应答丢弃 / Whether a reply was dropped as late since dropped was recorded
+bool M5UnitFingerprint2::droppedStaleReply(uint32_t dropped)
+{
+    acquireMutex();
+    bool result = (_staleReplies != dropped);
+    releaseMutex();
+    return result;
+}
+
+// 发送一个 7BH 分段 / Send one 7BH chunk
+bool M5UnitFingerprint2::sendTemplateChunk(uint16_t offset, const uint8_t* data, uint16_t size, bool first,
+                                           uint32_t& seq)
+{
+    // 命令码 + 偏移地址(2字节) + 下载大小(2字节)，模板数据随后原地写出 / Command code + offset (2 bytes) + size (2 bytes); the template data follows in place
+    uint8_t head[5] = {FINGERPRINT_DOWN_TEMPLATE,           static_cast<uint8_t>(offset >> 8),
+                       static_cast<uint8_t>(offset & 0xFF), static_cast<uint8_t>(size >> 8),
+                       static_cast<uint8_t>(size & 0xFF)};
+
+    acquireTxMutex();
+    acquireMutex();
+    if (first) {
+        beginCommandLocked(FINGERPRINT_DOWN_TEMPLATE);
+        seq = _lastCommandSeq;
     } else {
-        serialPrintf("PS_UploadTemplateAuto: Upload incomplete, %d bytes received\r\n", actualSize);
-        return FINGERPRINT_TIMEOUT;
+        seq = nextCommandSequence();
+    }
+    releaseMutex();
+    bool written = writeFrameLocked(FINGERPRINT_PACKET_COMMANDPACKET, head, sizeof(head), data, size);
+    releaseTxMutex();
+    return written;
+}
+
+// 7BH 分段下载：段长未知时逐段往返并增大段长，已知时流水线发送 / 7BH chunked download: one round trip per chunk while the chunk size grows, pipelined chunks once it is known
+fingerprint_status_t M5UnitFingerprint2::downloadTemplateChunks(const uint8_t* templateData, uint32_t templateSize,
+                                                                PS_DownloadTemplateCallback_t callback)
+{
+    // 7BH 的偏移地址为 16 位 / 7BH offsets are 16-bit
+    if (templateSize > 0xFFFF) {
+        serialPrintln("Invalid parameters for PS_DownloadTemplateAuto");
+        return FINGERPRINT_PARAM_ERROR;
+    }
+
+    // 段长按固件版本缓存，版本未知时先读取 / The chunk size is cached per firmware version; read the version first if unknown
+    if (_firmwareVersion.load() == FINGERPRINT_FIRMWARE_VERSION_UNKNOWN) {
+        uint8_t version;
+        PS_GetFirmwareVersion(version);
     }
+    uint16_t firmware = _firmwareVersion.load();
+    bool learning     = (_downloadChunkSize == 0 || _downloadChunkFirmware != firmware);
+    uint16_t chunk    = learning ? FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_START : _downloadChunkSize;
+    uint8_t depth     = learning ? 1 : FINGERPRINT_TEMPLATE_PIPELINE_DEPTH;
+
+    serialPrintf("PS_DownloadTemplateAuto: %s 7BH chunks of %d bytes\r\n", learning ? "learning from" : "pipelining",
+                 chunk);
+
+    // 在途分段，按发送顺序应答 / Chunks in flight, acknowledged in send order
+    struct Request {
+        uint16_t offset;
+        uint16_t size;
+        uint32_t seq;
+    };
+    Request inFlight[FINGERPRINT_TEMPLATE_PIPELINE_DEPTH];
+    uint8_t head  = 0;
+    uint8_t count = 0;
+
+    uint32_t nextOffset         = 0;      // 下一个分段的偏移 / Offset of the next chunk
+    uint32_t sent               = 0;      // 模组已确认的字节数 / Bytes the module has acknowledged
+    int packetCount             = 0;      // 已确认的分段数 / Chunks acknowledged
+    uint16_t accepted           = 0;      // 学习时被接受的最大整段 / Largest full chunk accepted while learning
+    bool settled                = false;  // 学习时有分段被拒绝，段长不再增大 / A chunk was rejected while learning; the chunk size stops growing
+    bool relearn                = false;  // 缓存的段长被模组拒绝 / The module rejected the cached chunk size
+    fingerprint_status_t result = FINGERPRINT_OK;
+
+    while (result == FINGERPRINT_OK && (nextOffset < templateSize || count > 0)) {
+        // 流水线未满时继续发送 / Keep sending while the pipeline has room
+        while (nextOffset < templateSize && count < depth) {
+            uint16_t size    = static_cast<uint16_t>((templateSize - nextOffset < chunk) ? templateSize - nextOffset : chunk);
+            Request& request = inFlight[(head + count) % FINGERPRINT_TEMPLATE_PIPELINE_DEPTH];
+            request.offset   = static_cast<uint16_t>(nextOffset);
+            request.size     = size;
+            if (!sendTemplateChunk(request.offset, templateData + nextOffset, size, count == 0, request.seq)) {
+                serialPrintln("Failed to send PS_DownloadTemplate command");
+                result = FINGERPRINT_PACKET_TIMEOUT;
+                break;
+            }
+            count++;
+            nextOffset += size;
+        }
+        if (result != FINGERPRINT_OK) {
+            break;
+        }
+
+        Request request = inFlight[head];
+        head            = (head + 1) % FINGERPRINT_TEMPLATE_PIPELINE_DEPTH;
+        count--;
+
+        // 等待最早的分段的确认，超时时为它留下墓碑 / Wait for the earliest chunk's acknowledge, leaving a tombstone for it on timeout
+        acquireMutex();
+        _lastCommand    = FINGERPRINT_DOWN_TEMPLATE;
+        _lastCommandSeq = request.seq;
+        uint32_t dropped = _staleReplies;
+        releaseMutex();
+        Fingerprint_PacketView ackPacket;
+        uint8_t confirmationCode = FINGERPRINT_PACKET_TIMEOUT;
+        bool answered            = receivePacketData(ackPacket, FINGERPRINT_TEMPLATE_CHUNK_ACK_TIMEOUT_MS);
+        if (answered) {
+            if (ackPacket.get_type() != FINGERPRINT_PACKET_ACKPACKET || ackPacket.get_actual_data_length() < 1) {
+                serialPrintln("Invalid ACK packet for PS_DownloadTemplate");
+                result = FINGERPRINT_PACKET_BADPACKET;
+                break;
+            }
+            confirmationCode = ackPacket.get_data()[0];
+            ackPacket.release();
+        }
+
+        // 学习时超时但期间有应答被当作迟到应答丢弃：模组已应答，同样长度重发 / A timeout while learning, but a reply was dropped as late meanwhile: the module did answer, so resend at the same size
+        if (learning && !answered && droppedStaleReply(dropped)) {
+            nextOffset = request.offset;
+            serialPrintln("PS_DownloadTemplateAuto: acknowledge dropped as a late reply, resending");
+            continue;
+        }
+
+        if (confirmationCode != FINGERPRINT_OK) {
+            // 学习时比已接受的段更长的分段被拒绝：退回已接受的段长（第一段则减半）后重发 / While learning, a chunk longer than any accepted one was rejected: resend it at the accepted size (halved for the first chunk)
+            if (learning && request.size > accepted && (accepted != 0 || request.size > FINGERPRINT_TEMPLATE_CHUNK_MIN)) {
+                chunk = (accepted != 0) ? accepted
+                                        : ((request.size / 2 < FINGERPRINT_TEMPLATE_CHUNK_MIN) ? FINGERPRINT_TEMPLATE_CHUNK_MIN
+                                                                                               : request.size / 2);
+                settled    = true;
+                nextOffset = request.offset;
+                serialPrintf("PS_DownloadTemplateAuto: chunk rejected, resending with %d bytes\r\n", chunk);
+                continue;
+            }
+            // 缓存的段长被拒绝：按学习模式重新下载 / The cached chunk size was rejected: download again while learning
+            if (!learning) {
+                serialPrintln("PS_DownloadTemplateAuto: cached chunk size rejected, learning again");
+                _downloadChunkSize = 0;
+                relearn            = true;
+                break;
+            }
+            serialPrintf("PS_DownloadTemplate command failed [confirmation: %s]\r\n",
+                         FingerprintDebugUtils::getStatusName(confirmationCode).c_str());
+            result = static_cast<fingerprint_status_t>(confirmationCode);
+            break;
+        }
+
+        sent = request.offset + request.size;
+        packetCount++;
+
+        // 学习时整段被接受后段长加倍，直到帧上限或有分段被拒绝 / While learning, double the chunk after a full one is accepted, until the frame limit or a rejection
+        if (learning && request.size == chunk) {
+            accepted = chunk;
+            if (!settled) {
+                chunk = (chunk > FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX / 2) ? FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX
+                                                                              : chunk * 2;
+            }
+        }
+
+        // 调用进度回调函数（如果提供） / Call progress callback function (if provided)
+        if (callback != nullptr && !callback(request.size, sent, packetCount, sent >= templateSize)) {
+            serialPrintln("PS_DownloadTemplateAuto: Download aborted by callback function");
+            result = FINGERPRINT_OPERATION_BLOCKED;
+            break;
+        }
+    }
+
+    // 提前结束时为仍在途的分段留下墓碑 / On an early exit, leave tombstones for the chunks still in flight
+    acquireMutex();
+    for (; count > 0; count--) {
+        retireCommand(FINGERPRINT_DOWN_TEMPLATE, inFlight[head].seq);
+        head = (head + 1) % FINGERPRINT_TEMPLATE_PIPELINE_DEPTH;
+    }
+    _lastCommand = 0;
+    releaseMutex();
+
+    if (relearn) {
+        return downloadTemplateChunks(templateData, templateSize, callback);
+    }
+    if (result != FINGERPRINT_OK) {
+        serialPrintf("PS_DownloadTemplateAuto: Download failed after %d bytes, error: %s\r\n", sent,
+                     FingerprintDebugUtils::getStatusName(result).c_str());
+        return result;
+    }
+
+    // 学习完成：段长已触及上限或被拒绝过时才说明模组的上限 / Learning done: the accepted size tells the module's limit only once it reached the maximum or a larger chunk was rejected
+    if (learning && accepted != 0 && (settled || accepted == FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX)) {
+        _downloadChunkSize     = accepted;
+        _downloadChunkFirmware = firmware;
+    }
+
+    serialPrintf("PS_DownloadTemplateAuto: Download completed, %d bytes in %d chunks\r\n", sent, packetCount);
+    if (callback != nullptr) {
+        callback(0, sent, packetCount, true);
+    }
+    return FINGERPRINT_OK;
 }
 
 // 自动注册模板 - 自动注册指纹模板到指定ID / Auto enroll template - Automatically enroll fingerprint template to specified ID
@@ -2118,16 +2688,13 @@ fingerprint_status_t M5UnitFingerprint2::PS_AutoEnroll(uint16_t ID,
     params[3] = (static_cast<uint16_t>(flags) >> 8) & 0xFF;  // 参数高字节 / Parameter high byte
     params[4] = static_cast<uint16_t>(flags) & 0xFF;         // 参数低字节 / Parameter low byte
 
-    // 创建命令数据包 - 使用命令代码 0x31 / Create command packet - Use command code 0x31
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_AUTO_ENROLL, params, 5);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_AUTO_ENROLL, 5>(params)) {
         serialPrintln("Failed to send PS_AutoEnroll command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
+    nonConstThis->beginAutoFlow(FINGERPRINT_AUTO_ENROLL);
 
     serialPrintf("PS_AutoEnroll: Starting enrollment [ID: %d, Count: %d, Flags: 0x%04X]\r\n",
                  ID, enrollCount, static_cast<uint16_t>(flags));
@@ -2143,17 +2710,25 @@ fingerprint_status_t M5UnitFingerprint2::PS_AutoEnroll(uint16_t ID,
     
     while (millis() - startTime < totalTimeout && !enrollmentComplete && !callbackAborted) {
         // 接收响应包 / Receive response packet
-        Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+        Fingerprint_PacketView responsePacket;
         if (!nonConstThis->receivePacketData(responsePacket, 10000)) {
             // 如果这是第一个包，则认为是通信错误 / If this is the first packet, consider it a communication error
             if (packetCount == 0) {
                 serialPrintln("Failed to receive PS_AutoEnroll initial response");
+                nonConstThis->endAutoFlow();
                 return FINGERPRINT_PACKET_TIMEOUT;
             }
             // 否则可能是注册过程结束，退出循环 / Otherwise enrollment process may have ended, exit loop
             break;
         }
 
+        // PS_Cancel 注入的取消命令的应答：流程已中止 / Reply to a cancel command injected by PS_Cancel: the flow has been aborted
+        if (nonConstThis->takeCancelReply(responsePacket)) {
+            serialPrintln("PS_AutoEnroll: Process cancelled by PS_Cancel");
+            finalResult = FINGERPRINT_OPERATION_BLOCKED;
+            break;
+        }
+
         packetCount++;
         
         // 检查响应包类型 / Check response packet type
@@ -2223,9 +2798,6 @@ fingerprint_status_t M5UnitFingerprint2::PS_AutoEnroll(uint16_t ID,
             enrollmentComplete = true;
             break;
         }
-        
-        // 继续等待下一个包 / Continue waiting for next packet
-        delay(100); // 短暂延迟避免过度占用CPU / Brief delay to avoid excessive CPU usage
     }
     
     // 超时检查 / Timeout check
@@ -2233,6 +2805,7 @@ fingerprint_status_t M5UnitFingerprint2::PS_AutoEnroll(uint16_t ID,
         serialPrintln("PS_AutoEnroll: Process timeout after 60 seconds");
         finalResult = FINGERPRINT_TIMEOUT;
     }
+    nonConstThis->endAutoFlow();
     
     // 设置返回参数 / Set return parameters
     if (param1 != nullptr) {
@@ -2281,23 +2854,20 @@ fingerprint_status_t M5UnitFingerprint2::PS_AutoIdentify(uint8_t securityLevel,
     params[3] = (static_cast<uint16_t>(flags) >> 8) & 0xFF;  // 标志位高字节 / Flag high byte
     params[4] = static_cast<uint16_t>(flags) & 0xFF;         // 标志位低字节 / Flag low byte
 
-    // 创建命令数据包 - 使用命令代码 0x32 / Create command packet - Use command code 0x32
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_AUTO_IDENTIFY, params, 5);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_AUTO_IDENTIFY, 5>(params)) {
         serialPrintln("Failed to send PS_AutoIdentify command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
+    nonConstThis->beginAutoFlow(FINGERPRINT_AUTO_IDENTIFY);
 
     serialPrintf("PS_AutoIdentify: Starting identification [Security Level: %d, Input ID: %d, Flags: 0x%02X]\r\n",
                  securityLevel, ID, static_cast<uint8_t>(flags));
     
     // PS_AutoIdentify命令特殊处理 - 类似PS_AutoEnroll，需要接收多个响应包，但只有一个参数 / PS_AutoIdentify command special handling - Similar to PS_AutoEnroll, need to receive multiple response packets, but with only one parameter
     fingerprint_status_t finalResult = FINGERPRINT_OK;
-    uint8_t lastParam = 0;
+    [[maybe_unused]] uint8_t lastParam = 0;
     int packetCount = 0;
     unsigned long startTime = millis();
     const unsigned long totalTimeout = 30000; // 总超时时间30秒 / Total timeout 30 seconds
@@ -2306,17 +2876,26 @@ fingerprint_status_t M5UnitFingerprint2::PS_AutoIdentify(uint8_t securityLevel,
     
     while (millis() - startTime < totalTimeout && !identificationComplete && !callbackAborted) {
         // 接收响应包 / Receive response packet
-        Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+        Fingerprint_PacketView responsePacket;
         if (!nonConstThis->receivePacketData(responsePacket, 10000)) {
             // 如果这是第一个包，则认为是通信错误 / If this is the first packet, consider it a communication error
             if (packetCount == 0) {
                 serialPrintln("Failed to receive PS_AutoIdentify initial response");
+                nonConstThis->endAutoFlow();
                 return FINGERPRINT_PACKET_TIMEOUT;
             }
             // 否则可能是验证过程结束，退出循环 / Otherwise verification process may have ended, exit loop
             break;
         }
 
+        // PS_Cancel 注入的取消命令的应答：流程已中止 / Reply to a cancel command injected by PS_Cancel: the flow has been aborted
+        if (nonConstThis->takeCancelReply(responsePacket)) {
+            serialPrintln("PS_AutoIdentify: Process cancelled by PS_Cancel");
+            finalResult = FINGERPRINT_OPERATION_BLOCKED;
+            PageID      = 0;
+            break;
+        }
+
         packetCount++;
         
         // 检查响应包类型 / Check response packet type
@@ -2430,9 +3009,6 @@ fingerprint_status_t M5UnitFingerprint2::PS_AutoIdentify(uint8_t securityLevel,
             identificationComplete = true;
             break;
         }
-        
-        // 继续等待下一个包 / Continue waiting for next packet
-        delay(100); // 短暂延迟避免过度占用CPU / Brief delay to avoid excessive CPU usage
     }
     
     // 超时检查 / Timeout check
@@ -2441,6 +3017,7 @@ fingerprint_status_t M5UnitFingerprint2::PS_AutoIdentify(uint8_t securityLevel,
         PageID = 0;
         finalResult = FINGERPRINT_TIMEOUT;
     }
+    nonConstThis->endAutoFlow();
     
     // 输出最终结果总结 / Output final result summary
     if (callbackAborted) {
@@ -0,0 +1,531 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_CORO_H
+#define __M5_UNIT_FINGERPRINT2_CORO_H
+
+// C++20 协程封装：在异步命令接口之上提供可 co_await 的 PS_* 命令。需要以 C++20（-std=gnu++20）编译，
+// 且须显式包含本头文件；编译器不支持协程时本头文件为空。
+// C++20 coroutine wrappers: co_await-able PS_* commands on top of the asynchronous command API. Requires building as
+// C++20 (-std=gnu++20) and including this header explicitly; the header is empty when the compiler lacks coroutines.
+
+#include "M5UnitFingerprint2.hpp"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#if !defined(ARDUINO_ARCH_ESP32) && !defined(ARDUINO_ARCH_ESP8266)
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#endif
+
+#define FINGERPRINT_CORO_AVAILABLE 1
+
+#ifndef FINGERPRINT_CORO_POLL_MS
+#define FINGERPRINT_CORO_POLL_MS 2 // 原生平台调度线程读取传输的最长间隔（毫秒） / Longest interval between transport reads of the native scheduler thread (milliseconds)
+#endif
+
+/**
+ * @brief 协程执行器 / Coroutine executor
+ *
+ * 决定命令完成后协程在哪个线程恢复。不指定执行器时协程直接在解析任务（原生平台为 processCommands() 的调用者）
+ * 中恢复，此时协程体与完成回调的限制相同：不得调用阻塞的 PS_* 函数。
+ *
+ * Decides which thread a coroutine resumes on once its command completes. Without an executor the coroutine resumes
+ * directly in the parse task (the caller of processCommands() on native platforms), and the coroutine body is then
+ * bound by the same rules as a completion callback: it must not call blocking PS_* functions.
+ */
+class Fingerprint_Executor {
+public:
+    virtual ~Fingerprint_Executor() {}
+
+    // 安排协程恢复，可在任意任务中调用 / Schedule a coroutine to resume, callable from any task
+    virtual void post(std::coroutine_handle<> handle) = 0;
+};
+
+// 命令结果：确认码及其后的应答数据 / Command result: confirmation code and the acknowledge data that follows it
+struct Fingerprint_CommandResult {
+    fingerprint_status_t status = FINGERPRINT_PACKET_TIMEOUT;
+    uint16_t length             = 0;
+    uint8_t data[FINGERPRINT_ASYNC_PAYLOAD_SIZE];
+
+    bool ok() const { return status == FINGERPRINT_OK; }
+
+    // 读取大端 16 位字段，越界返回 0 / Read a big-endian 16-bit field, 0 when out of range
+    uint16_t u16(uint16_t offset) const
+    {
+        return (offset + 1 < length) ? static_cast<uint16_t>((data[offset] << 8) | data[offset + 1]) : 0;
+    }
+};
+
+/**
+ * @brief 等待单条命令应答的可等待对象 / Awaitable for the acknowledge of a single command
+ *
+ * co_await 时通过 submitCommand() 提交命令并挂起，应答到达或超时后恢复，结果为 Fingerprint_CommandResult。
+ * 命令表已满时不挂起，结果为 FINGERPRINT_OPERATION_BLOCKED；参数超过 FINGERPRINT_ASYNC_PAYLOAD_SIZE 时同样不挂起，
+ * 结果为 FINGERPRINT_PARAM_ERROR。
+ *
+ * On co_await the command is submitted through submitCommand() and the coroutine suspends; it resumes when the
+ * acknowledge arrives or times out, yielding a Fingerprint_CommandResult. When the command table is full it does not
+ * suspend and yields FINGERPRINT_OPERATION_BLOCKED. Parameters longer than FINGERPRINT_ASYNC_PAYLOAD_SIZE do not
+ * suspend either and yield FINGERPRINT_PARAM_ERROR.
+ */
+class Fingerprint_CommandAwaitable {
+public:
+    Fingerprint_CommandAwaitable(M5UnitFingerprint2& device, Fingerprint_Executor* executor, uint8_t command,
+                                 const uint8_t* params, uint16_t paramLength, uint32_t timeout_ms)
+        : _device(device), _executor(executor), _command(command), _paramLength(paramLength), _timeout(timeout_ms)
+    {
+        // 截断的参数会发出另一条命令，直接以参数错误完成 / Truncated parameters would send a different command, so complete with a parameter error instead
+        if (_paramLength > FINGERPRINT_ASYNC_PAYLOAD_SIZE) {
+            _result.status = FINGERPRINT_PARAM_ERROR;
+            _ready         = true;
+            return;
+        }
+        if (params != nullptr && _paramLength > 0) {
+            memcpy(_params, params, _paramLength);
+        }
+    }
+
+    bool await_ready() const noexcept { return _ready; }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        _handle = handle;
+        // 应答可能在 submitCommand() 返回前就已恢复协程，之后不得再访问本对象 / The acknowledge may resume the coroutine before submitCommand() returns, so this object must not be touched afterwards
+        if (_device.submitCommand(_command, _params, _paramLength, _timeout, onComplete, this) != 0) {
+            return true;
+        }
+        _result.status = FINGERPRINT_OPERATION_BLOCKED;
+        return false;
+    }
+
+    Fingerprint_CommandResult await_resume() const { return _result; }
+
+private:
+    static void onComplete(uint32_t handle, fingerprint_status_t status, const uint8_t* response,
+                           uint16_t responseLength, void* context)
+    {
+        (void)handle;
+        Fingerprint_CommandAwaitable* self = static_cast<Fingerprint_CommandAwaitable*>(context);
+        self->_result.status               = status;
+        self->_result.length               = responseLength;
+        memcpy(self->_result.data, response, responseLength);
+        if (self->_executor != nullptr) {
+            self->_executor->post(self->_handle);
+        } else {
+            self->_handle.resume();
+        }
+    }
+
+    M5UnitFingerprint2& _device;
+    Fingerprint_Executor* _executor;
+    uint8_t _command;
+    uint8_t _params[FINGERPRINT_ASYNC_PAYLOAD_SIZE];
+    uint16_t _paramLength;
+    uint32_t _timeout;
+    bool _ready = false;  // 不提交命令，立即得到结果 / Yields its result at once without submitting a command
+    std::coroutine_handle<> _handle;
+    Fingerprint_CommandResult _result;
+};
+
+namespace fingerprint_coro_detail {
+// 结束时恢复等待者；已分离的协程自行销毁 / On completion resume the awaiter; detached coroutines destroy themselves
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    bool detached = false;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            PromiseBase& promise = handle.promise();
+            if (promise.continuation) {
+                return promise.continuation;
+            }
+            if (promise.detached) {
+                handle.destroy();
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() const { std::terminate(); }
+};
+
+template <typename T>
+struct TaskPromise : PromiseBase {
+    T value{};
+    void return_value(T result) { value = std::move(result); }
+};
+
+template <>
+struct TaskPromise<void> : PromiseBase {
+    void return_void() const {}
+};
+}  // namespace fingerprint_coro_detail
+
+/**
+ * @brief 惰性启动的协程任务 / Lazily started coroutine task
+ *
+ * 可在另一个协程中 co_await（结束时以对称转移恢复等待者），或通过 start() 启动并分离，结束时自行销毁。
+ * 协程帧由编译器分配，不需要独立的任务栈。
+ *
+ * Can be co_awaited from another coroutine (the awaiter is resumed by symmetric transfer on completion), or started
+ * and detached with start(), in which case it destroys itself when it finishes. Coroutine frames are allocated by the
+ * compiler, no dedicated task stack is needed.
+ */
+template <typename T = void>
+class Fingerprint_Task {
+public:
+    struct promise_type : fingerprint_coro_detail::TaskPromise<T> {
+        Fingerprint_Task get_return_object()
+        {
+            return Fingerprint_Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+    };
+
+    Fingerprint_Task(Fingerprint_Task&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+    Fingerprint_Task& operator=(Fingerprint_Task&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            _handle = std::exchange(other._handle, nullptr);
+        }
+        return *this;
+    }
+    Fingerprint_Task(const Fingerprint_Task&)            = delete;
+    Fingerprint_Task& operator=(const Fingerprint_Task&) = delete;
+    ~Fingerprint_Task() { reset(); }
+
+    // 启动并分离 / Start and detach
+    void start()
+    {
+        std::coroutine_handle<promise_type> handle = std::exchange(_handle, nullptr);
+        if (handle) {
+            handle.promise().detached = true;
+            handle.resume();
+        }
+    }
+
+    bool await_ready() const noexcept { return !_handle || _handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        _handle.promise().continuation = awaiting;
+        return _handle;
+    }
+
+    T await_resume()
+    {
+        if constexpr (!std::is_void<T>::value) {
+            return std::move(_handle.promise().value);
+        }
+    }
+
+private:
+    explicit Fingerprint_Task(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+    void reset()
+    {
+        if (_handle) {
+            _handle.destroy();
+            _handle = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> _handle;
+};
+
+/**
+ * @brief 可 co_await 的 PS_* 命令集 / co_await-able PS_* command set
+ *
+ * 每个方法返回一个 Fingerprint_CommandAwaitable，参数编码与对应的阻塞 PS_* 函数相同，应答超时也相同。
+ * Each method returns a Fingerprint_CommandAwaitable with the same parameter encoding and acknowledge timeout as the
+ * matching blocking PS_* function.
+ */
+class Fingerprint_CoDevice {
+public:
+    /**
+     * @param device 指纹模组实例 / Fingerprint module instance
+     * @param executor 协程恢复所用执行器，nullptr 表示在解析任务中直接恢复 / Executor used to resume coroutines, nullptr to resume directly in the parse task
+     */
+    explicit Fingerprint_CoDevice(M5UnitFingerprint2& device, Fingerprint_Executor* executor = nullptr)
+        : _device(device), _executor(executor)
+    {
+    }
+
+    M5UnitFingerprint2& device() const { return _device; }
+
+    // 任意单应答命令 / Any single-acknowledge command
+    Fingerprint_CommandAwaitable command(uint8_t command, const uint8_t* params = nullptr, uint16_t paramLength = 0,
+                                         uint32_t timeout_ms = 1000) const
+    {
+        return Fingerprint_CommandAwaitable(_device, _executor, command, params, paramLength, timeout_ms);
+    }
+
+    Fingerprint_CommandAwaitable getImage() const { return command(FINGERPRINT_GET_IMAGE); }              // 01H
+    Fingerprint_CommandAwaitable getEnrollImage() const { return command(FINGERPRINT_GET_ENROLL_IMAGE); } // 29H
+
+    // 02H 生成特征文件 / Generate character file
+    Fingerprint_CommandAwaitable genChar(uint8_t bufferId) const
+    {
+        return command(FINGERPRINT_GENERATE_CHARACTER, &bufferId, 1);
+    }
+
+    // 03H 精确比对，结果 u16(0) 为比对得分 / Match, u16(0) of the result is the score
+    Fingerprint_CommandAwaitable match() const { return command(FINGERPRINT_MATCH); }
+
+    // 04H 搜索指纹，结果 u16(0) 为页码、u16(2) 为得分 / Search, u16(0) of the result is the page ID and u16(2) the score
+    Fingerprint_CommandAwaitable search(uint8_t bufferId, uint16_t startPage, uint16_t pageNum) const
+    {
+        uint8_t params[] = {bufferId, static_cast<uint8_t>(startPage >> 8), static_cast<uint8_t>(startPage & 0xFF),
+                            static_cast<uint8_t>(pageNum >> 8), static_cast<uint8_t>(pageNum & 0xFF)};
+        return command(FINGERPRINT_SEARCH, params, sizeof(params));
+    }
+
+    Fingerprint_CommandAwaitable regModel() const { return command(FINGERPRINT_REG_MODEL); } // 05H
+
+    // 06H 储存模板 / Store template
+    Fingerprint_CommandAwaitable storeChar(uint8_t bufferId, uint16_t pageId) const
+    {
+        uint8_t params[] = {bufferId, static_cast<uint8_t>(pageId >> 8), static_cast<uint8_t>(pageId & 0xFF)};
+        return command(FINGERPRINT_STORE, params, sizeof(params));
+    }
+
+    // 07H 读取模板 / Load template
+    Fingerprint_CommandAwaitable loadChar(uint8_t bufferId, uint16_t pageId) const
+    {
+        uint8_t params[] = {bufferId, static_cast<uint8_t>(pageId >> 8), static_cast<uint8_t>(pageId & 0xFF)};
+        return command(FINGERPRINT_LOAD_MODEL, params, sizeof(params));
+    }
+
+    // 0CH 删除模板 / Delete templates
+    Fingerprint_CommandAwaitable deletChar(uint16_t pageId, uint16_t num) const
+    {
+        uint8_t params[] = {static_cast<uint8_t>(pageId >> 8), static_cast<uint8_t>(pageId & 0xFF),
+                            static_cast<uint8_t>(num >> 8), static_cast<uint8_t>(num & 0xFF)};
+        return command(FINGERPRINT_DELETE_MODEL, params, sizeof(params), 2000);
+    }
+
+    Fingerprint_CommandAwaitable empty() const { return command(FINGERPRINT_EMPTY, nullptr, 0, 5000); } // 0DH
+
+    // 1DH 有效模板数量，结果 u16(0) 为数量 / Valid template count, u16(0) of the result is the count
+    Fingerprint_CommandAwaitable validTemplateNum() const { return command(FINGERPRINT_VALID_MODEL_COUNT); }
+
+    Fingerprint_CommandAwaitable handShake() const { return command(FINGERPRINT_HAND_SHAKE); } // 35H
+
+    // 3CH LED 控制 / LED control
+    Fingerprint_CommandAwaitable controlBLN(fingerprint_led_control_mode_t mode, fingerprint_led_color_t startColor,
+                                            fingerprint_led_color_t endColor, uint8_t loopCount = 0) const
+    {
+        uint8_t params[] = {static_cast<uint8_t>(mode), static_cast<uint8_t>(startColor),
+                            static_cast<uint8_t>(endColor), loopCount};
+        return command(FINGERPRINT_CONTROL_LED, params, sizeof(params));
+    }
+
+private:
+    M5UnitFingerprint2& _device;
+    Fingerprint_Executor* _executor;
+};
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+/**
+ * @brief FreeRTOS 协程调度器 / FreeRTOS coroutine scheduler
+ *
+ * 以一个 FreeRTOS 队列保存待恢复的协程。begin() 可创建一个专用任务恢复所有协程（多个协程共用一个任务栈），
+ * 也可以不创建任务，在 loop() 中调用 runOnce()，使协程在应用自己的任务中恢复。
+ *
+ * Holds coroutines waiting to resume in a FreeRTOS queue. begin() can create one dedicated task that resumes every
+ * coroutine (all coroutines share one task stack), or create none and let loop() call runOnce() so coroutines resume
+ * in the application's own task.
+ */
+class Fingerprint_CoroScheduler : public Fingerprint_Executor {
+public:
+    ~Fingerprint_CoroScheduler() override { end(); }
+
+    /**
+     * @param stackSize 调度任务栈大小，0 表示不创建任务 / Scheduler task stack size, 0 to create no task
+     * @param priority 调度任务优先级 / Scheduler task priority
+     * @param depth 队列深度 / Queue depth
+     * @return 成功返回 true / true on success
+     */
+    bool begin(uint32_t stackSize = 4096, UBaseType_t priority = 4, UBaseType_t depth = FINGERPRINT_MAX_PENDING_COMMANDS * 2)
+    {
+        if (_queue == nullptr) {
+            _queue = xQueueCreate(depth, sizeof(void*));
+            if (_queue == nullptr) {
+                return false;
+            }
+        }
+        if (stackSize > 0 && _task == nullptr) {
+            xTaskCreate(taskEntry, "FingerprintCoro", stackSize, this, priority, &_task);
+            return _task != nullptr;
+        }
+        return true;
+    }
+
+    void end()
+    {
+        if (_task != nullptr) {
+            vTaskDelete(_task);
+            _task = nullptr;
+        }
+        if (_queue != nullptr) {
+            vQueueDelete(_queue);
+            _queue = nullptr;
+        }
+    }
+
+    void post(std::coroutine_handle<> handle) override
+    {
+        void* address = handle.address();
+        if (_queue == nullptr || xQueueSend(_queue, &address, portMAX_DELAY) != pdTRUE) {
+            handle.resume();
+        }
+    }
+
+    /**
+     * @brief 恢复所有已就绪的协程 / Resume every ready coroutine
+     * @param timeout_ms 队列为空时的最长等待时间 / Longest wait while the queue is empty
+     * @return 恢复的协程数量 / Number of coroutines resumed
+     */
+    size_t runOnce(uint32_t timeout_ms = 0)
+    {
+        if (_queue == nullptr) {
+            return 0;
+        }
+        size_t resumed = 0;
+        void* address;
+        TickType_t wait = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+        while (xQueueReceive(_queue, &address, resumed == 0 ? wait : 0) == pdTRUE) {
+            std::coroutine_handle<>::from_address(address).resume();
+            resumed++;
+        }
+        return resumed;
+    }
+
+private:
+    static void taskEntry(void* parameter)
+    {
+        Fingerprint_CoroScheduler* self = static_cast<Fingerprint_CoroScheduler*>(parameter);
+        while (true) {
+            self->runOnce(UINT32_MAX);
+        }
+    }
+
+    QueueHandle_t _queue = nullptr;
+    TaskHandle_t _task   = nullptr;
+};
+#else
+/**
+ * @brief 基于 std::thread 的协程调度器（原生平台） / std::thread based coroutine scheduler (native platforms)
+ *
+ * 一个调度线程恢复所有协程，并为 attach() 的实例调用 processCommands()，代替 FreeRTOS 上的解析任务。
+ * One scheduler thread resumes every coroutine and calls processCommands() for the attached instances, standing in for
+ * the parse task of FreeRTOS platforms.
+ */
+class Fingerprint_CoroScheduler : public Fingerprint_Executor {
+public:
+    static constexpr size_t MAX_DEVICES = 4;
+
+    ~Fingerprint_CoroScheduler() override { end(); }
+
+    // 由调度线程驱动该实例的异步命令，须在 begin() 之前调用 / Drive the instance's asynchronous commands from the scheduler thread; call before begin()
+    bool attach(M5UnitFingerprint2& device)
+    {
+        if (_thread.joinable() || _deviceCount >= MAX_DEVICES) {
+            return false;
+        }
+        _devices[_deviceCount++] = &device;
+        return true;
+    }
+
+    bool begin()
+    {
+        if (!_thread.joinable()) {
+            _running = true;
+            _thread  = std::thread(&Fingerprint_CoroScheduler::run, this);
+        }
+        return true;
+    }
+
+    // 停止调度线程，尚未恢复的协程不会再恢复 / Stop the scheduler thread; coroutines not yet resumed never will be
+    void end()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _running = false;
+        }
+        _ready.notify_all();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    void post(std::coroutine_handle<> handle) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _queue.push_back(handle);
+        }
+        _ready.notify_one();
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        while (_running) {
+            while (!_queue.empty()) {
+                std::coroutine_handle<> handle = _queue.front();
+                _queue.pop_front();
+                lock.unlock();
+                handle.resume();
+                lock.lock();
+            }
+
+            // 没有解析任务：在此读取传输并推进命令 / No parse task: read the transports and advance commands here
+            lock.unlock();
+            uint32_t wait = FINGERPRINT_CORO_POLL_MS;
+            for (size_t i = 0; i < _deviceCount; i++) {
+                uint32_t deviceWait = _devices[i]->processCommands();
+                if (deviceWait < wait) {
+                    wait = deviceWait;
+                }
+            }
+            lock.lock();
+
+            _ready.wait_for(lock, std::chrono::milliseconds(wait), [this] { return !_queue.empty() || !_running; });
+        }
+    }
+
+    M5UnitFingerprint2* _devices[MAX_DEVICES] = {};
+    size_t _deviceCount                       = 0;
+    std::deque<std::coroutine_handle<>> _queue;
+    std::mutex _lock;
+    std::condition_variable _ready;
+    std::thread _thread;
+    bool _running = false;
+};
+#endif
+
+#endif  // __cpp_impl_coroutine
+
+#endif  // __M5_UNIT_FINGERPRINT2_CORO_H
@@ -7,7 +7,7 @@
 #ifndef __M5_UNIT_FINGERPRINT2_DEFS_H
 #define __M5_UNIT_FINGERPRINT2_DEFS_H
 
-#include "Arduino.h"
+#include "M5UnitFingerprint2_platform.hpp"
 
 #define M5_DEVICE_NAME "M5UnitFingerprint2"
 
@@ -70,9 +70,143 @@
 // 指纹传感器常量定义 / Fingerprint sensor constant definitions
 #define FINGERPRINT_STARTCODE 0xEF01    // 指纹传感器数据包起始码 / Fingerprint sensor packet start code
 #define FINGERPRINT_MAX_PACKET_SIZE 256 // 指纹传感器数据包最大长度 / Maximum fingerprint sensor packet length
-#define FINGERPRINT_RECV_BUFFER_SIZE 16384 // 接收缓冲区大小，应该能容纳多个连续数据包 / Receive buffer size, should be able to hold multiple consecutive packets
+#define FINGERPRINT_PACKET_HEADER_SIZE 9 // 包头长度：起始码(2) + 地址(4) + 包标识(1) + 包长度(2) / Header length: start code(2) + address(4) + identifier(1) + length(2)
+
+// 内存占用配置：以下大小均可在包含本库前（或通过编译选项）定义以覆盖默认值。
+// 定义 FINGERPRINT_PROFILE_LEAN 为 1 选用精简配置（单实例 < 4 KB），仅适用于命令/应答交互，
+// 超过 FINGERPRINT_RX_MAX_PAYLOAD_SIZE 的数据包（模板、图像上传）会被丢弃。
+// 定义 FINGERPRINT_RAM_BUDGET（字节）可在编译期检查单个实例的大小，详见 Fingerprint_Footprint。
+// Memory footprint configuration: each size below can be overridden by defining it before including the library
+// (or through build flags). Define FINGERPRINT_PROFILE_LEAN as 1 for the lean profile (< 4 KB per instance), meant
+// for command/acknowledge traffic only; data packets larger than FINGERPRINT_RX_MAX_PAYLOAD_SIZE (template and image
+// uploads) are dropped. Define FINGERPRINT_RAM_BUDGET (bytes) to check the size of one instance at compile time, see
+// Fingerprint_Footprint.
+#if defined(FINGERPRINT_PROFILE_LEAN) && FINGERPRINT_PROFILE_LEAN
+#ifndef FINGERPRINT_RX_MAX_PAYLOAD_SIZE
+#define FINGERPRINT_RX_MAX_PAYLOAD_SIZE 64
+#endif
+#ifndef FINGERPRINT_RECV_BUFFER_SIZE
+#define FINGERPRINT_RECV_BUFFER_SIZE 256
+#endif
+#ifndef MAX_PARSED_PACKETS
+#define MAX_PARSED_PACKETS 4
+#endif
+#ifndef FINGERPRINT_MAX_PENDING_COMMANDS
+#define FINGERPRINT_MAX_PENDING_COMMANDS 2
+#endif
+#ifndef FINGERPRINT_PARSE_TASK_STACK_SIZE
+#define FINGERPRINT_PARSE_TASK_STACK_SIZE 4096
+#endif
+#endif
+
+#ifndef FINGERPRINT_RX_MAX_PAYLOAD_SIZE
+#define FINGERPRINT_RX_MAX_PAYLOAD_SIZE FINGERPRINT_MAX_PACKET_SIZE // 可接收的最大数据长度（不含校验和） / Largest receivable payload (excluding checksum)
+#endif
+#ifndef FINGERPRINT_RECV_BUFFER_SIZE
+#define FINGERPRINT_RECV_BUFFER_SIZE 16384 // 接收环形缓冲区大小（2 的幂），应该能容纳多个连续数据包 / Receive ring buffer size (power of two), should be able to hold multiple consecutive packets
+#endif
+#ifndef MAX_PARSED_PACKETS
 #define MAX_PARSED_PACKETS 256 // 最大解析包数量 / Maximum number of parsed packets
-#define PACKET_INTERVAL_MS 500 // 包间隔时间（毫秒） / Packet interval time (milliseconds)
+#endif
+#ifndef FINGERPRINT_MAX_PENDING_COMMANDS
+#define FINGERPRINT_MAX_PENDING_COMMANDS 4 // 异步命令最大挂起数量 / Maximum number of pending asynchronous commands
+#endif
+#ifndef FINGERPRINT_ASYNC_PAYLOAD_SIZE
+#define FINGERPRINT_ASYNC_PAYLOAD_SIZE 40 // 异步命令参数/应答数据缓冲区大小 / Asynchronous command parameter/response buffer size
+#endif
+#ifndef FINGERPRINT_MAX_COMMANDS_IN_FLIGHT
+#define FINGERPRINT_MAX_COMMANDS_IN_FLIGHT FINGERPRINT_MAX_PENDING_COMMANDS // 同时等待应答的异步命令数（流水线深度），模组按顺序应答 / Asynchronous commands awaiting their acknowledge at once (pipeline depth); the module replies in order
+#endif
+#ifndef FINGERPRINT_SESSION_EVENT_DEPTH
+#define FINGERPRINT_SESSION_EVENT_DEPTH 8 // 自动流程会话缓存、尚未分发的阶段包数量 / Stage packets an auto flow session buffers before they are dispatched
+#endif
+#ifndef FINGERPRINT_AUTO_FLOW_IDLE_TIMEOUT_MS
+#define FINGERPRINT_AUTO_FLOW_IDLE_TIMEOUT_MS 10000 // 自动流程两个阶段包之间的最长间隔（毫秒） / Longest gap between two auto flow stage packets (milliseconds)
+#endif
+#define FINGERPRINT_COMMAND_TABLE_SIZE (FINGERPRINT_MAX_PENDING_COMMANDS + 1) // 异步命令表大小，额外一项留给取消类命令 / Asynchronous command table size; the extra entry is reserved for the cancel class
+#define FINGERPRINT_MAX_STALE_COMMANDS (FINGERPRINT_MAX_PENDING_COMMANDS + 1) // 超时命令墓碑数量（含阻塞调用） / Timed-out command tombstones (including blocking calls)
+#define FINGERPRINT_MAX_FRAME_SIZE (FINGERPRINT_PACKET_HEADER_SIZE + FINGERPRINT_RX_MAX_PAYLOAD_SIZE + 2) // 接收帧最大长度（含校验和） / Maximum received frame length (including checksum)
+#ifndef FINGERPRINT_HANDOFF_NOTIFY_INDEX
+#define FINGERPRINT_HANDOFF_NOTIFY_INDEX 1 // 唤醒等待响应的任务所用的任务通知下标（FreeRTOS），须大于 0 且小于 configTASK_NOTIFICATION_ARRAY_ENTRIES，否则改用每个实例的二值信号量 / Task notification index used to wake the task awaiting a response (FreeRTOS); must be above 0 and below configTASK_NOTIFICATION_ARRAY_ENTRIES, otherwise a per-instance binary semaphore is used
+#endif
+#ifndef FINGERPRINT_NATIVE_WAIT_SLICE_MS
+#define FINGERPRINT_NATIVE_WAIT_SLICE_MS 5 // 原生平台单次等待传输可读的最长时间（毫秒） / Longest single wait for transport readability on native platforms (milliseconds)
+#endif
+#ifndef FINGERPRINT_PARSE_SLICE_BYTES
+#define FINGERPRINT_PARSE_SLICE_BYTES 256 // 解析器每次持锁送入分帧器的最大字节数，限制发送方等待 RX 锁的时间 / Most bytes the parser feeds to the framer per lock hold, bounding how long a sender waits for the RX lock
+#endif
+#ifndef FINGERPRINT_PARSE_TASK_STACK_SIZE
+#define FINGERPRINT_PARSE_TASK_STACK_SIZE 8096 // 解析任务默认栈大小（字节） / Default parse task stack size (bytes)
+#endif
+#ifndef FINGERPRINT_PARSE_TASK_PRIORITY
+#define FINGERPRINT_PARSE_TASK_PRIORITY 5 // 解析任务默认优先级 / Default parse task priority
+#endif
+#ifndef FINGERPRINT_PARSE_TASK_CORE
+#define FINGERPRINT_PARSE_TASK_CORE -1 // 解析任务默认所在核心，-1 表示不绑定 / Default parse task core, -1 for no affinity
+#endif
+#ifndef FINGERPRINT_QUERY_PACKET_SIZE_AT_BEGIN
+#define FINGERPRINT_QUERY_PACKET_SIZE_AT_BEGIN 0 // 为 1 时 begin() 读取并缓存模组的包大小，模组不在时 begin() 最多多等 1 秒；为 0 时留到第一次批量传输 / When 1, begin() reads and caches the module's packet size, taking up to 1 s longer when no module answers; when 0 this is left to the first bulk transfer
+#endif
+#ifndef FINGERPRINT_DEFAULT_TRANSFER_PROFILE
+#define FINGERPRINT_DEFAULT_TRANSFER_PROFILE FINGERPRINT_TRANSFER_BULK // 默认批量传输包大小策略 / Default bulk transfer packet size policy
+#endif
+#ifndef FINGERPRINT_CHAR_TRANSFER_BUFFER_ID
+#define FINGERPRINT_CHAR_TRANSFER_BUFFER_ID 1 // 模板自动上传/下载使用的特征缓冲区 / Template buffer used by the automatic template upload and download
+#endif
+#ifndef FINGERPRINT_CHAR_TRANSFER_ACK_TIMEOUT_MS
+#define FINGERPRINT_CHAR_TRANSFER_ACK_TIMEOUT_MS 1000 // 上传/下载特征的应答超时，不支持的固件可能不应答（毫秒） / Acknowledge timeout of template upload/download; firmware without them may not answer (milliseconds)
+#endif
+#ifndef FINGERPRINT_CHAR_TRANSFER_INVALID_CODE
+#define FINGERPRINT_CHAR_TRANSFER_INVALID_CODE FINGERPRINT_PACKET_ERROR // 模组对未实现指令的确认码 / Confirmation code the module answers an unimplemented command with
+#endif
+#ifndef FINGERPRINT_CHAR_TRANSFER_SILENT_LIMIT
+#define FINGERPRINT_CHAR_TRANSFER_SILENT_LIMIT 2 // 连续多少次无应答后视为不支持 08H/09H / Consecutive unanswered 08H/09H commands before they count as unsupported
+#endif
+#ifndef FINGERPRINT_TEMPLATE_CHUNK_MAX
+#define FINGERPRINT_TEMPLATE_CHUNK_MAX (FINGERPRINT_RX_MAX_PAYLOAD_SIZE - 3) // 7AH 分段上传首先尝试的段长，应答另含 3 字节确认码与长度 / Chunk size the 7AH upload tries first; the reply adds 3 bytes of confirmation code and size
+#endif
+#ifndef FINGERPRINT_TEMPLATE_CHUNK_MIN
+#define FINGERPRINT_TEMPLATE_CHUNK_MIN 32 // 学习段长时逐次减半的下限 / Lower bound when the chunk size is halved while learning
+#endif
+#ifndef FINGERPRINT_TEMPLATE_CHUNK_ACK_TIMEOUT_MS
+#define FINGERPRINT_TEMPLATE_CHUNK_ACK_TIMEOUT_MS 10000 // 7AH/7BH 每段的应答超时（毫秒） / Acknowledge timeout of each 7AH/7BH chunk (milliseconds)
+#endif
+#ifndef FINGERPRINT_TEMPLATE_PIPELINE_DEPTH
+#define FINGERPRINT_TEMPLATE_PIPELINE_DEPTH 2 // 段长已知时同时在途的 7AH/7BH 请求数 / 7AH/7BH requests in flight at once once the chunk size is known
+#endif
+#ifndef FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_START
+#define FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_START 100 // 7BH 分段下载学习段长时的起始段长 / Chunk size the 7BH download starts from while learning
+#endif
+#ifndef FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX
+#define FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX (FINGERPRINT_MAX_PACKET_SIZE - 5) // 7BH 段长上限，命令包另含命令码、偏移与长度 5 字节 / Largest 7BH chunk; the command packet adds 5 bytes of command code, offset and size
+#endif
+#ifndef FINGERPRINT_FLEET_MAX_WORKERS
+#define FINGERPRINT_FLEET_MAX_WORKERS 16 // 多模组管理器工作线程数上限（Linux） / Maximum worker threads of the multi-unit manager (Linux)
+#endif
+#ifndef FINGERPRINT_FLEET_SWEEP_MS
+#define FINGERPRINT_FLEET_SWEEP_MS 50 // 多模组管理器在无事件时推进全部模组的间隔（毫秒） / Interval at which the multi-unit manager advances every unit when no event arrives (milliseconds)
+#endif
+#ifndef FINGERPRINT_PARSED_PACKET_TIMEOUT_MS
+#define FINGERPRINT_PARSED_PACKET_TIMEOUT_MS 5000 // 未被取走的解析包过期时间（毫秒） / Expiry time of unclaimed parsed packets (milliseconds)
+#endif
+#ifndef FINGERPRINT_ACK_PACKET_LIFETIME_MS
+#define FINGERPRINT_ACK_PACKET_LIFETIME_MS FINGERPRINT_PARSED_PACKET_TIMEOUT_MS // 应答包默认生存时间 / Default acknowledge packet lifetime
+#endif
+#ifndef FINGERPRINT_DATA_PACKET_LIFETIME_MS
+#define FINGERPRINT_DATA_PACKET_LIFETIME_MS FINGERPRINT_PARSED_PACKET_TIMEOUT_MS // 数据包/结束包默认生存时间 / Default data/end packet lifetime
+#endif
+
+// 事件驱动接收：ESP32 Arduino 核心 2.x 及以上通过 onReceive（RX FIFO 阈值/接收超时）唤醒解析任务，
+// 否则回退为 1ms 轮询。可在包含本库前定义为 0 强制使用轮询。
+// Event-driven reception: on ESP32 Arduino core 2.x and later the parse task is woken by onReceive (RX FIFO
+// threshold / RX timeout), otherwise it falls back to 1 ms polling. Define as 0 before including to force polling.
+#ifndef FINGERPRINT_EVENT_DRIVEN_RX
+#if defined(ESP32) && defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 2)
+#define FINGERPRINT_EVENT_DRIVEN_RX 1
+#else
+#define FINGERPRINT_EVENT_DRIVEN_RX 0
+#endif
+#endif
 
 // 包标识 / Packet identifiers
 #define FINGERPRINT_PACKET_COMMANDPACKET 0x1  //!< Command packet
@@ -171,6 +305,21 @@
 #define FINGERPRINT_PACKET_SIZE_64  0X1  //!< Packet size is 64 Byte
 #define FINGERPRINT_PACKET_SIZE_128 0X2  //!< Packet size is 128 Byte
 #define FINGERPRINT_PACKET_SIZE_256 0X3  //!< Packet size is 256 Byte
+#define FINGERPRINT_FIRMWARE_VERSION_UNKNOWN 0xFFFF  // 固件版本尚未读取或模组已重新上电 / Firmware version not read yet or the module powered up again
+#define FINGERPRINT_PACKET_SIZE_UNKNOWN 0xFF  // 包大小未知，尚未读取或模组已重新上电 / Packet size unknown: not read yet or the module powered up again
+
+// 批量传输使用的包大小：不超过可接收的最大数据长度 / Packet size used for bulk transfers: no larger than the largest receivable payload
+#ifndef FINGERPRINT_BULK_PACKET_SIZE
+#if FINGERPRINT_RX_MAX_PAYLOAD_SIZE >= 256
+#define FINGERPRINT_BULK_PACKET_SIZE FINGERPRINT_PACKET_SIZE_256
+#elif FINGERPRINT_RX_MAX_PAYLOAD_SIZE >= 128
+#define FINGERPRINT_BULK_PACKET_SIZE FINGERPRINT_PACKET_SIZE_128
+#elif FINGERPRINT_RX_MAX_PAYLOAD_SIZE >= 64
+#define FINGERPRINT_BULK_PACKET_SIZE FINGERPRINT_PACKET_SIZE_64
+#else
+#define FINGERPRINT_BULK_PACKET_SIZE FINGERPRINT_PACKET_SIZE_32
+#endif
+#endif
 
 
 // 状态代码枚举 / Status code enumeration
@@ -256,12 +405,100 @@ typedef enum {
     FINGERPRINT_REG_AUTO_LIGHT         = 0x0B,
 } fingerprint_reg_t;
 
-// 队列数据结构 / Queue data structure
+// 接收路径统计 / Receive path statistics
 typedef struct {
-    uint8_t* data;
-    size_t length;
-    unsigned long timestamp;
-} QueuedData;
+    uint32_t bytesReceived;      // 从串口读取的总字节数 / Total bytes read from the serial port
+    uint32_t backpressureCount;  // 环形缓冲区满、数据暂留驱动缓冲区的次数 / Times the ring was full and data was left in the driver buffer
+    uint32_t ringHighWatermark;  // 环形缓冲区最高占用字节数 / Ring buffer high watermark in bytes
+    uint32_t framesParsed;       // 已解析的完整帧数 / Complete frames parsed
+    uint32_t checksumErrors;     // 校验和错误帧数 / Frames with checksum errors
+    uint32_t discardedBytes;     // 重新同步时丢弃的字节数 / Bytes dropped while resynchronizing
+    uint32_t packetsDropped;     // 解析队列满时淘汰的包数 / Packets evicted because the parse queue was full
+    uint32_t packetsExpired;     // 到期仍未被取走的包数，持续增长通常意味着协议失步 / Packets that expired unclaimed; steady growth usually means a protocol desync
+    uint32_t staleReplies;       // 作为超时命令的迟到应答而丢弃的包数 / Packets dropped as late replies to timed-out commands
+    uint32_t mismatchedReplies;  // 形状与等待中命令不符的应答数 / Replies whose shape did not fit the waiting command
+    uint32_t syncProbes;         // 命令超时后发出的探测命令数 / Probe commands sent after a command timed out
+    uint32_t handoffCount;           // 解析器直接交给等待者的响应数 / Responses handed by the parser straight to a waiting caller
+    uint32_t handoffLatencyLastUs;   // 最近一次从解析出校验和字节到调用者被唤醒的时间（微秒） / Time from checksum byte parsed to caller wakeup for the last handoff (microseconds)
+    uint32_t handoffLatencyMaxUs;    // 最大交接延迟（微秒） / Maximum handoff latency (microseconds)
+    uint32_t handoffLatencyTotalUs;  // 交接延迟累计，除以 handoffCount 得平均值 / Accumulated handoff latency; divide by handoffCount for the mean
+    uint32_t bytesSent;              // 写入串口的总字节数 / Total bytes written to the serial port
+    uint32_t rxLockContended;        // RX 锁（接收状态）被占用、需要等待的次数 / Times the RX lock (receive state) was busy and had to be waited for
+    uint32_t rxLockWaitMaxUs;        // 等待 RX 锁的最长时间（微秒） / Longest wait for the RX lock (microseconds)
+    uint32_t rxLockWaitTotalUs;      // 等待 RX 锁的累计时间（微秒） / Accumulated wait for the RX lock (microseconds)
+    uint32_t txLockContended;        // TX 锁（串口写出）被占用、需要等待的次数 / Times the TX lock (serial writes) was busy and had to be waited for
+    uint32_t txLockWaitMaxUs;        // 等待 TX 锁的最长时间（微秒） / Longest wait for the TX lock (microseconds)
+    uint32_t txLockWaitTotalUs;      // 等待 TX 锁的累计时间（微秒） / Accumulated wait for the TX lock (microseconds)
+} fingerprint_rx_stats_t;
+
+// 解析任务配置，传给 begin() / Parse task configuration, passed to begin()
+typedef struct {
+    bool useTask       = true;  // false 为内联模式：不创建任务，由应用调用 update() / false for inline mode: no task, the application calls update()
+    int8_t core        = FINGERPRINT_PARSE_TASK_CORE;        // 绑定的核心（仅 ESP32），-1 表示不绑定 / Core to pin to (ESP32 only), -1 for no affinity
+    uint8_t priority   = FINGERPRINT_PARSE_TASK_PRIORITY;    // 任务优先级 / Task priority
+    uint32_t stackSize = FINGERPRINT_PARSE_TASK_STACK_SIZE;  // 任务栈大小（字节） / Task stack size (bytes)
+} fingerprint_task_config_t;
+
+// 批量传输（上传图像、读取 INF 页）的包大小策略 / Packet size policy for bulk transfers (image upload, INF page read)
+typedef enum {
+    FINGERPRINT_TRANSFER_AS_CONFIGURED = 0,  // 使用模组当前的包大小 / Use the module's current packet size
+    FINGERPRINT_TRANSFER_BULK          = 1,  // 传输前提升到 FINGERPRINT_BULK_PACKET_SIZE 并保持到模组重新上电 / Raise to FINGERPRINT_BULK_PACKET_SIZE before the transfer and keep it until the module powers up again
+    FINGERPRINT_TRANSFER_BULK_RESTORE  = 2,  // 传输前提升，传输后恢复原值 / Raise before the transfer and restore the previous size afterwards
+} fingerprint_transfer_profile_t;
+
+// 模组对上传/下载特征（08H/09H）的支持情况 / Module support for template upload/download (08H/09H)
+typedef enum {
+    FINGERPRINT_CHAR_TRANSFER_UNKNOWN     = 0,  // 尚未探测，下一次自动传输时探测 / Not probed yet, probed by the next automatic transfer
+    FINGERPRINT_CHAR_TRANSFER_SUPPORTED   = 1,  // 使用 08H/09H 整体传输 / Templates move as one 08H/09H transfer
+    FINGERPRINT_CHAR_TRANSFER_UNSUPPORTED = 2,  // 使用 7AH/7BH 分段传输 / Templates move in 7AH/7BH chunks
+} fingerprint_char_transfer_t;
+
+// 数据包流式接收状态 / Data packet streaming sink state
+typedef enum {
+    FINGERPRINT_SINK_IDLE      = 0,  // 未启用，数据包进入解析队列 / Disabled, data packets go to the parse queue
+    FINGERPRINT_SINK_ARMED     = 1,  // 等待命令应答包 / Waiting for the command acknowledge packet
+    FINGERPRINT_SINK_STREAMING = 2,  // 应答成功，数据包直接写入目标缓冲区 / Acknowledged, data packets are written straight to the destination
+    FINGERPRINT_SINK_DONE      = 3,  // 已收到结束包 / End-of-data packet received
+    FINGERPRINT_SINK_OVERFLOW  = 4,  // 目标缓冲区空间不足 / Destination buffer too small
+} fingerprint_sink_state_t;
+
+// 异步命令状态 / Asynchronous command state
+typedef enum {
+    FINGERPRINT_COMMAND_INVALID = 0,  // 句柄无效或结果已取走 / Unknown handle, or the result was already collected
+    FINGERPRINT_COMMAND_QUEUED  = 1,  // 等待发送 / Waiting to be sent
+    FINGERPRINT_COMMAND_SENT    = 2,  // 已发送，等待应答包 / Sent, waiting for the acknowledge packet
+    FINGERPRINT_COMMAND_DONE    = 3,  // 已完成（应答或超时） / Completed (acknowledged or timed out)
+} fingerprint_command_state_t;
+
+// 异步命令优先级，数值越小越先发送 / Asynchronous command priority; lower values are sent first
+typedef enum {
+    FINGERPRINT_PRIORITY_CANCEL      = 0,  // 取消/中止：占用保留表项，不受流水线深度限制，立即插队发送 / Cancel/abort: uses the reserved entry, ignores the pipeline depth and jumps the queue
+    FINGERPRINT_PRIORITY_INTERACTIVE = 1,  // 交互命令（默认） / Interactive commands (default)
+    FINGERPRINT_PRIORITY_BACKGROUND  = 2,  // 后台维护（如 PS_ReadIndexTable）：仅在没有命令在途时发送 / Background maintenance (e.g. PS_ReadIndexTable): sent only while no command is in flight
+} fingerprint_command_priority_t;
+
+// 自动流程会话状态 / Auto flow session state
+typedef enum {
+    FINGERPRINT_SESSION_IDLE    = 0,  // 未开始 / Not started
+    FINGERPRINT_SESSION_RUNNING = 1,  // 进行中，等待阶段包 / Running, waiting for stage packets
+    FINGERPRINT_SESSION_DONE    = 2,  // 已结束，result() 为最终结果 / Finished, result() holds the final result
+} fingerprint_session_state_t;
+
+// 异步命令完成回调函数类型定义 / Asynchronous command completion callback function type definition
+// 在解析任务中执行（原生平台在 processCommands() 的调用者中执行），不得调用阻塞的 PS_* 函数，可以提交新命令
+// Runs in the parse task (in the caller of processCommands() on native platforms); must not call blocking PS_*
+// functions, but may submit new commands
+// 参数： / Parameters:
+//   handle: submitCommand() 返回的句柄 / Handle returned by submitCommand()
+//   status: 确认码，超时为 FINGERPRINT_PACKET_TIMEOUT / Confirmation code, FINGERPRINT_PACKET_TIMEOUT on timeout
+//   response: 确认码之后的应答数据 / Acknowledge data following the confirmation code
+//   responseLength: 应答数据长度 / Acknowledge data length
+//   context: 提交命令时传入的上下文指针 / Context pointer passed when submitting the command
+typedef void (*PS_CommandCallback_t)(uint32_t handle,
+                                     fingerprint_status_t status,
+                                     const uint8_t* response,
+                                     uint16_t responseLength,
+                                     void* context);
 
 // 自动注册回调函数类型定义 / Auto enrollment callback function type definition
 // 参数： / Parameters:
@@ -320,4 +557,16 @@ typedef bool (*PS_DownloadTemplateCallback_t)(uint16_t currentSize,
                                               int packetCount,
                                               bool isComplete);
 
+// PS_UploadTemplateAuto 计时回调函数类型定义 / PS_UploadTemplateAuto timed callback function type definition
+// 参数同 PS_UploadTemplateCallback_t，另有： / Parameters as PS_UploadTemplateCallback_t, plus:
+//   elapsedUs: 自开始上传起经过的时间（微秒），完成时即为整个模板的传输时间 / Time since the upload started (microseconds); on completion, the transfer time of the whole template
+//   context: 用户上下文 / User context
+// 返回值：true 继续处理，false 中止处理 / Return value: true to continue, false to abort
+typedef bool (*PS_UploadTemplateTimedCallback_t)(uint16_t currentSize,
+                                                 uint32_t totalSize,
+                                                 int packetCount,
+                                                 bool isComplete,
+                                                 uint32_t elapsedUs,
+                                                 void* context);
+
 #endif // __M5_UNIT_FINGERPRINT2_DEFS_H
@@ -0,0 +1,116 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_ENCODER_H
+#define __M5_UNIT_FINGERPRINT2_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "M5UnitFingerprint2_defs.hpp"
+
+/**
+ * @brief 命令帧编码 / Command frame encoding
+ *
+ * 命令帧一次写入调用者的小缓冲区：包头、命令码、参数与校验和，不经过 Fingerprint_Packet 的 256 字节数据区和
+ * serialize() 的逐字节拷贝。缓冲区大小由 size() 给出。
+ *
+ * A command frame is written into the caller's small buffer in one pass: header, command code, parameters and
+ * checksum, without the 256-byte data area of Fingerprint_Packet and the byte-by-byte copy of serialize(). size()
+ * gives the buffer size.
+ */
+class Fingerprint_CommandFrame {
+public:
+    // 命令帧长度：包头 + 命令码 + 参数 + 校验和 / Command frame length: header + command code + parameters + checksum
+    static constexpr size_t size(size_t paramLength) {
+        return FINGERPRINT_PACKET_HEADER_SIZE + 1 + paramLength + 2;
+    }
+
+    // 包长度字段：命令码 + 参数 + 校验和 / Packet length field: command code + parameters + checksum
+    static constexpr uint16_t packetLength(size_t paramLength) {
+        return static_cast<uint16_t>(1 + paramLength + 2);
+    }
+
+    // 校验和中与参数无关的部分：包标识、包长度与命令码 / Part of the checksum independent of the parameters: identifier, packet length and command code
+    static constexpr uint16_t constantSum(uint8_t command, size_t paramLength) {
+        return static_cast<uint16_t>(FINGERPRINT_PACKET_COMMANDPACKET + (packetLength(paramLength) >> 8) +
+                                     (packetLength(paramLength) & 0xFF) + command);
+    }
+
+    /**
+     * @brief 编码命令码在运行时确定的命令帧 / Encode a command frame whose command code is known at run time
+     * @param frame 输出缓冲区，至少 size(paramLength) 字节 / Output buffer of at least size(paramLength) bytes
+     * @return 帧长度 / Frame length
+     */
+    static size_t encode(uint8_t* frame, uint32_t address, uint8_t command, const uint8_t* params,
+                         uint16_t paramLength) {
+        return finish(frame, address, command, packetLength(paramLength), constantSum(command, paramLength), params,
+                      paramLength);
+    }
+
+    /**
+     * @brief 写出包头、命令码与参数并追加校验和 / Write the header, command code and parameters and append the checksum
+     * @param sum 校验和的常量部分 / Constant part of the checksum
+     * @return 帧长度 / Frame length
+     */
+    static size_t finish(uint8_t* frame, uint32_t address, uint8_t command, uint16_t length, uint16_t sum,
+                         const uint8_t* params, uint16_t paramLength) {
+        frame[0] = (FINGERPRINT_STARTCODE >> 8) & 0xFF;
+        frame[1] = FINGERPRINT_STARTCODE & 0xFF;
+        frame[2] = (address >> 24) & 0xFF;
+        frame[3] = (address >> 16) & 0xFF;
+        frame[4] = (address >> 8) & 0xFF;
+        frame[5] = address & 0xFF;
+        frame[6] = FINGERPRINT_PACKET_COMMANDPACKET;
+        frame[7] = (length >> 8) & 0xFF;
+        frame[8] = length & 0xFF;
+        frame[9] = command;
+
+        uint8_t* out = frame + FINGERPRINT_PACKET_HEADER_SIZE + 1;
+        for (uint16_t i = 0; i < paramLength; i++) {
+            out[i] = params[i];
+            sum += params[i];
+        }
+        out[paramLength]     = (sum >> 8) & 0xFF;
+        out[paramLength + 1] = sum & 0xFF;
+        return size(paramLength);
+    }
+};
+
+/**
+ * @brief 单个操作码的命令帧编码器 / Command frame encoder for one opcode
+ *
+ * 命令码与参数长度在编译期确定：帧长度可用作栈上缓冲区的大小，包长度与校验和的常量部分是编译期常量。
+ * 没有参数的命令整个校验和都在编译期算出。
+ *
+ * The command code and parameter length are fixed at compile time: the frame length can size a buffer on the stack,
+ * and the packet length and the constant part of the checksum are compile-time constants. For a command without
+ * parameters the whole checksum is computed at compile time.
+ *
+ * @tparam Command 命令码 / Command code
+ * @tparam ParamLength 参数字节数 / Parameter bytes
+ */
+template <uint8_t Command, uint16_t ParamLength = 0>
+class Fingerprint_CommandEncoder {
+    static_assert(1 + ParamLength <= FINGERPRINT_MAX_PACKET_SIZE, "Command parameters must fit one packet");
+
+public:
+    static constexpr size_t frameSize      = Fingerprint_CommandFrame::size(ParamLength);
+    static constexpr uint16_t packetLength = Fingerprint_CommandFrame::packetLength(ParamLength);
+    static constexpr uint16_t constantSum  = Fingerprint_CommandFrame::constantSum(Command, ParamLength);
+
+    /**
+     * @param frame 输出缓冲区，至少 frameSize 字节 / Output buffer of at least frameSize bytes
+     * @param params ParamLength 字节的参数，无参数时可为 nullptr / ParamLength parameter bytes, may be nullptr without parameters
+     * @return 帧长度 / Frame length
+     */
+    static size_t encode(uint8_t* frame, uint32_t address, const uint8_t* params) {
+        return Fingerprint_CommandFrame::finish(frame, address, Command, packetLength, constantSum, params,
+                                                ParamLength);
+    }
+};
+
+#endif  // __M5_UNIT_FINGERPRINT2_ENCODER_H
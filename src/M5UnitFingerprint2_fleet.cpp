@@ -0,0 +1,431 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "M5UnitFingerprint2_fleet.hpp"
+
+#if defined(__linux__) && !defined(ARDUINO)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+static const unsigned long NO_DEADLINE = ~0UL;
+static const uint64_t WAKE_TAG         = ~0ULL;  // eventfd 在 epoll 中的标记 / Tag of the eventfd in epoll
+
+// 模组报告无手指或超时：尚未检测到手指，可以重新开始 / The unit reported no finger or a timeout: no finger seen yet, it may start over
+static bool awaitingFinger(fingerprint_status_t status)
+{
+    return status == FINGERPRINT_NO_FINGER || status == FINGERPRINT_TIMEOUT;
+}
+
+// 模组得出结果；取消、通信错误等本机状态码不算 / The unit reached a result; host-side codes such as a cancel or a communication error do not count
+static bool decided(fingerprint_status_t status)
+{
+    return !awaitingFinger(status) && status < FINGERPRINT_PACKET_TIMEOUT;
+}
+
+Fingerprint_Fleet::Fingerprint_Fleet(size_t workerCount) : _requestedWorkers(workerCount)
+{
+}
+
+Fingerprint_Fleet::~Fingerprint_Fleet()
+{
+    end();
+    // 会话先于模组实例销毁，模组实例先于传输销毁 / Sessions go before the unit instances, which go before the transports
+    for (Unit* unit : _units) {
+        delete unit->session;
+        delete unit->device;
+        delete unit->transport;
+        delete unit;
+    }
+}
+
+int Fingerprint_Fleet::add(const char* device, uint32_t baudRate, uint32_t address)
+{
+    if (_running.load() || device == nullptr) {
+        return -1;
+    }
+    Unit* unit      = new Unit();
+    unit->path      = device;
+    unit->transport = new Fingerprint_TermiosTransport(unit->path.c_str(), baudRate);
+    return addUnit(unit, address);
+}
+
+int Fingerprint_Fleet::add(Fingerprint_FdTransport* transport, uint32_t address)
+{
+    if (_running.load() || transport == nullptr) {
+        return -1;
+    }
+    Unit* unit      = new Unit();
+    unit->transport = transport;
+    return addUnit(unit, address);
+}
+
+int Fingerprint_Fleet::addUnit(Unit* unit, uint32_t address)
+{
+    unit->device  = new M5UnitFingerprint2(unit->transport, address);
+    unit->session = new Fingerprint_AutoIdentifySession(*unit->device);
+    _units.push_back(unit);
+    return static_cast<int>(_units.size() - 1);
+}
+
+bool Fingerprint_Fleet::begin()
+{
+    if (_running.load()) {
+        return true;
+    }
+
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    _wakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event event;
+    event.events   = EPOLLIN;
+    event.data.u64 = WAKE_TAG;
+    if (_epollFd < 0 || _wakeFd < 0 || epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &event) < 0) {
+        serialPrintln("Fleet: failed to create epoll instance");
+        end();
+        return false;
+    }
+
+    // 模组以内联模式运行，由工作线程调用 update() / Units run in inline mode; the workers call update()
+    fingerprint_task_config_t taskConfig;
+    taskConfig.useTask = false;
+
+    bool allOnline = true;
+    for (size_t i = 0; i < _units.size(); i++) {
+        Unit& unit = *_units[i];
+        unit.busy.store(false);
+        unit.due.store(NO_DEADLINE);
+        unit.online = unit.device->begin(taskConfig) && unit.transport->fd() >= 0;
+        if (unit.online) {
+            // 单次触发：推进期间不再报告该串口，推进结束后重新启用 / One-shot: the port is not reported again while the unit is being advanced; re-armed afterwards
+            event.events   = EPOLLIN | EPOLLONESHOT;
+            event.data.u64 = i;
+            unit.online    = epoll_ctl(_epollFd, EPOLL_CTL_ADD, unit.transport->fd(), &event) == 0;
+        }
+        if (!unit.online) {
+            serialPrintf("Fleet: unit %u failed to open\r\n", static_cast<unsigned>(i));
+            allOnline = false;
+        }
+    }
+
+    size_t workers = _requestedWorkers;
+    if (workers == 0) {
+        workers = std::thread::hardware_concurrency();
+    }
+    if (workers > _units.size()) {
+        workers = _units.size();
+    }
+    if (workers > FINGERPRINT_FLEET_MAX_WORKERS) {
+        workers = FINGERPRINT_FLEET_MAX_WORKERS;
+    }
+    if (workers == 0) {
+        workers = 1;
+    }
+
+    _running.store(true);
+    for (size_t i = 0; i < workers; i++) {
+        _workers.push_back(new Worker());
+    }
+    for (size_t i = 0; i < workers; i++) {
+        _workers[i]->thread = std::thread(&Fingerprint_Fleet::workerLoop, this, i);
+    }
+    _poller = std::thread(&Fingerprint_Fleet::pollLoop, this);
+
+    // 先推进一次，处理打开前已到达的数据 / Advance each unit once to handle data that arrived before opening
+    for (size_t i = 0; i < _units.size(); i++) {
+        schedule(i);
+    }
+    return allOnline;
+}
+
+void Fingerprint_Fleet::end()
+{
+    if (_running.exchange(false)) {
+        uint64_t one = 1;
+        if (write(_wakeFd, &one, sizeof(one)) < 0) {
+            serialPrintln("Fleet: failed to wake the poller");
+        }
+        _poller.join();
+
+        {
+            std::lock_guard<std::mutex> guard(_idleLock);
+        }
+        _idleCv.notify_all();
+        for (Worker* worker : _workers) {
+            worker->thread.join();
+            delete worker;
+        }
+        _workers.clear();
+        _pending.store(0);
+    }
+
+    for (Unit* unit : _units) {
+        if (unit->online) {
+            epoll_ctl(_epollFd, EPOLL_CTL_DEL, unit->transport->fd(), nullptr);
+            unit->online = false;
+        }
+    }
+    if (_epollFd >= 0) {
+        close(_epollFd);
+        _epollFd = -1;
+    }
+    if (_wakeFd >= 0) {
+        close(_wakeFd);
+        _wakeFd = -1;
+    }
+}
+
+void Fingerprint_Fleet::wake(size_t index)
+{
+    if (index < _units.size() && _running.load()) {
+        schedule(index);
+    }
+}
+
+// 将模组放入其所属工作线程的队列；已排队或正在推进时忽略 / Queue a unit on its home worker; ignored while it is queued or being advanced
+void Fingerprint_Fleet::schedule(size_t index)
+{
+    Unit& unit = *_units[index];
+    if (!unit.online || unit.busy.exchange(true)) {
+        return;
+    }
+
+    Worker& worker = *_workers[index % _workers.size()];
+    {
+        std::lock_guard<std::mutex> guard(worker.lock);
+        worker.tasks.push_back(index);
+    }
+    {
+        std::lock_guard<std::mutex> guard(_idleLock);
+        _pending.fetch_add(1);
+    }
+    _idleCv.notify_one();
+}
+
+// 先取自己队列的头部，再从其它工作线程队列的尾部窃取 / Take from the front of the own queue first, then steal from the back of the other workers' queues
+bool Fingerprint_Fleet::takeTask(size_t self, size_t& index)
+{
+    size_t count = _workers.size();
+    for (size_t n = 0; n < count; n++) {
+        Worker& worker = *_workers[(self + n) % count];
+        std::lock_guard<std::mutex> guard(worker.lock);
+        if (worker.tasks.empty()) {
+            continue;
+        }
+        if (n == 0) {
+            index = worker.tasks.front();
+            worker.tasks.pop_front();
+        } else {
+            index = worker.tasks.back();
+            worker.tasks.pop_back();
+            _workers[self]->steals.fetch_add(1, std::memory_order_relaxed);
+        }
+        _pending.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+// 推进一个模组：读取并解析数据、推进异步命令和会话，然后重新启用其串口事件 / Advance one unit: read and parse data, advance async commands and sessions, then re-arm its port event
+void Fingerprint_Fleet::service(size_t index)
+{
+    Unit& unit    = *_units[index];
+    uint32_t wait = unit.device->update();
+
+    unsigned long due = (wait == UINT32_MAX) ? NO_DEADLINE : millis() + wait;
+    unit.due.store(due);
+    unit.busy.store(false);
+
+    struct epoll_event event;
+    event.events   = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = index;
+    epoll_ctl(_epollFd, EPOLL_CTL_MOD, unit.transport->fd(), &event);
+
+    // 截止时间早于下一次定时推进时唤醒轮询线程重新计算 / Wake the poller to recompute its timeout when the deadline precedes the next timed pass
+    if (wait < FINGERPRINT_FLEET_SWEEP_MS) {
+        uint64_t one = 1;
+        if (write(_wakeFd, &one, sizeof(one)) < 0) {
+            serialPrintln("Fleet: failed to wake the poller");
+        }
+    }
+
+    _activitySeq.fetch_add(1);
+    if (_activityWaiters.load() > 0) {
+        {
+            std::lock_guard<std::mutex> guard(_activityLock);
+        }
+        _activityCv.notify_all();
+    }
+}
+
+void Fingerprint_Fleet::pollLoop()
+{
+    struct epoll_event events[32];
+    unsigned long lastSweep = millis();
+
+    while (_running.load()) {
+        // 等到最早的超时检查或下一次定时推进 / Wait until the earliest timeout check or the next timed pass
+        unsigned long now  = millis();
+        unsigned long next = lastSweep + FINGERPRINT_FLEET_SWEEP_MS;
+        for (Unit* unit : _units) {
+            unsigned long due = unit->due.load();
+            if (due < next) {
+                next = due;
+            }
+        }
+        int timeout = (next <= now) ? 0 : static_cast<int>(next - now);
+
+        int count = epoll_wait(_epollFd, events, sizeof(events) / sizeof(events[0]), timeout);
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.u64 == WAKE_TAG) {
+                uint64_t value;
+                ssize_t drained = read(_wakeFd, &value, sizeof(value));
+                (void)drained;
+                continue;
+            }
+            _events.fetch_add(1, std::memory_order_relaxed);
+            schedule(static_cast<size_t>(events[i].data.u64));
+        }
+
+        // 定时推进全部模组，覆盖其它线程提交的命令与会话；否则只推进到达截止时间的模组
+        // A timed pass advances every unit, covering commands and sessions started from other threads; otherwise only
+        // units whose deadline has passed are advanced
+        now = millis();
+        if (now - lastSweep >= FINGERPRINT_FLEET_SWEEP_MS) {
+            lastSweep = now;
+            _sweeps.fetch_add(1, std::memory_order_relaxed);
+            for (size_t i = 0; i < _units.size(); i++) {
+                schedule(i);
+            }
+            continue;
+        }
+        for (size_t i = 0; i < _units.size(); i++) {
+            unsigned long due = _units[i]->due.load();
+            if (due <= now && _units[i]->due.compare_exchange_strong(due, NO_DEADLINE)) {
+                schedule(i);
+            }
+        }
+    }
+}
+
+void Fingerprint_Fleet::workerLoop(size_t self)
+{
+    Worker& worker = *_workers[self];
+    while (true) {
+        size_t index;
+        if (takeTask(self, index)) {
+            service(index);
+            worker.updates.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_idleLock);
+        _idleCv.wait(lock, [this] { return _pending.load() > 0 || !_running.load(); });
+        if (!_running.load()) {
+            return;
+        }
+    }
+}
+
+// 等待任一模组完成一次推进 / Wait until any unit completes a pass
+void Fingerprint_Fleet::waitActivity(uint32_t seen, uint32_t timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(_activityLock);
+    _activityWaiters.fetch_add(1);
+    _activityCv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this, seen] { return _activitySeq.load() != seen; });
+    _activityWaiters.fetch_sub(1);
+}
+
+fingerprint_status_t Fingerprint_Fleet::identifyAny(uint32_t timeout_ms, fingerprint_fleet_match_t& match,
+                                                    uint8_t securityLevel, fingerprint_auto_verify_flags_t flags)
+{
+    std::lock_guard<std::mutex> guard(_identifyLock);
+    match = fingerprint_fleet_match_t();
+    if (!_running.load()) {
+        return FINGERPRINT_MODULE_NOT_OPEN;
+    }
+
+    unsigned long startTime = millis();
+    std::vector<bool> active(_units.size(), false);
+    size_t running = 0;
+    for (size_t i = 0; i < _units.size(); i++) {
+        if (_units[i]->online && _units[i]->session->begin(securityLevel, 0xFFFF, flags) == FINGERPRINT_OK) {
+            active[i] = true;
+            running++;
+            wake(i);
+        }
+    }
+    if (running == 0) {
+        return FINGERPRINT_MODULE_NOT_OPEN;
+    }
+
+    bool cancelled = false;
+    while (running > 0) {
+        uint32_t seen = _activitySeq.load();
+
+        for (size_t i = 0; i < _units.size(); i++) {
+            Fingerprint_AutoIdentifySession& session = *_units[i]->session;
+            if (!active[i] || !session.done()) {
+                continue;
+            }
+            fingerprint_status_t result = session.result();
+
+            // 第一个得出结果的模组做出判定，取消其余模组 / The first unit to reach a result decides; cancel the others
+            if (!cancelled && decided(result)) {
+                match.unit   = static_cast<int>(i);
+                match.status = result;
+                match.pageID = session.pageID();
+                match.score  = session.score();
+                serialPrintf("Fleet: unit %u decided with status 0x%02X\r\n", static_cast<unsigned>(i), result);
+                for (size_t j = 0; j < _units.size(); j++) {
+                    if (active[j] && j != i && _units[j]->session->cancel()) {
+                        wake(j);
+                    }
+                }
+                cancelled = true;
+            } else if (!cancelled && awaitingFinger(result) && millis() - startTime < timeout_ms &&
+                       session.begin(securityLevel, 0xFFFF, flags) == FINGERPRINT_OK) {
+                // 尚未检测到手指，重新开始 / No finger seen yet, start over
+                wake(i);
+                continue;
+            }
+            active[i] = false;
+            running--;
+        }
+
+        unsigned long elapsed = millis() - startTime;
+        if (!cancelled && elapsed >= timeout_ms) {
+            serialPrintln("Fleet: no unit saw a finger before the timeout");
+            for (size_t i = 0; i < _units.size(); i++) {
+                if (active[i] && _units[i]->session->cancel()) {
+                    wake(i);
+                }
+            }
+            cancelled = true;
+        }
+
+        if (running > 0) {
+            uint32_t wait = FINGERPRINT_FLEET_SWEEP_MS;
+            if (!cancelled && timeout_ms - elapsed < wait) {
+                wait = timeout_ms - elapsed;
+            }
+            waitActivity(seen, wait);
+        }
+    }
+
+    return (match.unit >= 0) ? match.status : FINGERPRINT_TIMEOUT;
+}
+
+void Fingerprint_Fleet::getStats(fingerprint_fleet_stats_t& stats) const
+{
+    stats         = fingerprint_fleet_stats_t();
+    stats.events  = _events.load(std::memory_order_relaxed);
+    stats.sweeps  = _sweeps.load(std::memory_order_relaxed);
+    for (const Worker* worker : _workers) {
+        stats.updates += worker->updates.load(std::memory_order_relaxed);
+        stats.steals += worker->steals.load(std::memory_order_relaxed);
+    }
+}
+#endif
@@ -0,0 +1,197 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_FLEET_H
+#define __M5_UNIT_FINGERPRINT2_FLEET_H
+
+// Linux 多模组管理器：一个进程通过 USB-UART 等串口驱动多个模组，须显式包含本头文件；其它平台上本头文件为空。
+// Linux multi-unit manager: one process drives many modules over USB-UART adapters or other serial ports; include
+// this header explicitly. The header is empty on other platforms.
+
+#include "M5UnitFingerprint2.hpp"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "M5UnitFingerprint2_session.hpp"
+
+// identifyAny() 的结果 / Result of identifyAny()
+typedef struct {
+    int unit                    = -1;                   // 做出判定的模组序号，-1 表示没有 / Index of the unit that decided, -1 if none
+    fingerprint_status_t status = FINGERPRINT_TIMEOUT;  // 该模组的比对结果 / Identification result of that unit
+    uint16_t pageID             = 0;                    // 匹配的页码 ID，比对成功时有效 / Matched page ID, valid on success
+    uint16_t score              = 0;                    // 匹配分数 / Match score
+} fingerprint_fleet_match_t;
+
+// 多模组管理器统计 / Multi-unit manager statistics
+typedef struct {
+    uint32_t events  = 0;  // 收到的可读事件 / Readability events received
+    uint32_t sweeps  = 0;  // 无事件时的定时推进 / Timed passes without an event
+    uint32_t updates = 0;  // 执行的 update() 次数 / update() calls run
+    uint32_t steals  = 0;  // 从其它工作线程窃取的任务 / Tasks stolen from another worker
+} fingerprint_fleet_stats_t;
+
+/**
+ * @brief 多模组管理器 / Multi-unit manager
+ *
+ * 管理器拥有每个模组的传输与 M5UnitFingerprint2 实例，模组以内联模式运行（不创建解析线程）。一个轮询线程用 epoll
+ * 等待所有串口，可读的模组作为任务交给少量工作线程执行 update()；每个工作线程有自己的任务队列，空闲时从其它
+ * 线程的队列尾部窃取任务，因此吞吐量随核心数增长，而线程数与模组数量无关。同一模组同一时刻只由一个线程推进。
+ *
+ * The manager owns the transport and the M5UnitFingerprint2 instance of each unit, and runs the units in inline
+ * mode (no parse thread each). One poller thread waits on every port with epoll and hands a readable unit to a small
+ * pool of worker threads as a task running its update(). Each worker has a task queue of its own and, when idle,
+ * steals from the back of another worker's queue, so throughput grows with the core count while the thread count
+ * does not depend on the number of units. A unit is advanced by one thread at a time.
+ *
+ * 可以从其它线程在模组上调用阻塞的 PS_* 函数、提交异步命令或运行自动流程会话；回调在工作线程中执行。
+ * Blocking PS_* functions, asynchronous commands and auto flow sessions can be used on a unit from other threads;
+ * callbacks run in the worker threads.
+ */
+class Fingerprint_Fleet {
+public:
+    /**
+     * @param workerCount 工作线程数，0 表示按 CPU 核心数（不超过模组数与 FINGERPRINT_FLEET_MAX_WORKERS）
+     *                    Worker threads; 0 uses the CPU core count (capped by the unit count and
+     *                    FINGERPRINT_FLEET_MAX_WORKERS)
+     */
+    explicit Fingerprint_Fleet(size_t workerCount = 0);
+    ~Fingerprint_Fleet();
+
+    Fingerprint_Fleet(const Fingerprint_Fleet&)            = delete;
+    Fingerprint_Fleet& operator=(const Fingerprint_Fleet&) = delete;
+
+    /**
+     * @brief 添加一个串口设备上的模组，须在 begin() 之前调用 / Add a unit on a serial device, call before begin()
+     * @param device 设备路径，例如 /dev/ttyUSB0 / Device path, e.g. /dev/ttyUSB0
+     * @param baudRate 波特率 / Baud rate
+     * @param address 模组地址 / Module address
+     * @return 模组序号，begin() 之后调用返回 -1 / Unit index, -1 if called after begin()
+     */
+    int add(const char* device, uint32_t baudRate = 115200, uint32_t address = 0xFFFFFFFF);
+
+    /**
+     * @brief 添加一个已有传输上的模组并接管该传输，须在 begin() 之前调用 / Add a unit on an existing transport and take ownership of it, call before begin()
+     * @return 模组序号，begin() 之后调用或传输为空返回 -1 / Unit index, -1 if called after begin() or the transport is null
+     */
+    int add(Fingerprint_FdTransport* transport, uint32_t address = 0xFFFFFFFF);
+
+    /**
+     * @brief 打开所有模组并启动轮询与工作线程 / Open every unit and start the poller and worker threads
+     *
+     * 无法打开的模组被跳过（online() 返回 false），其余模组照常运行。
+     * Units that fail to open are skipped (online() returns false); the others run as usual.
+     *
+     * @return 所有模组均已打开返回 true / true if every unit was opened
+     */
+    bool begin();
+
+    // 停止所有线程；模组实例保留到管理器销毁 / Stop every thread; the unit instances remain until the manager is destroyed
+    void end();
+
+    size_t size() const { return _units.size(); }
+    size_t workerCount() const { return _workers.size(); }
+
+    // 模组实例 / Unit instance
+    M5UnitFingerprint2& unit(size_t index) { return *_units[index]->device; }
+
+    // 模组是否已打开并由管理器推进 / Whether the unit is open and advanced by the manager
+    bool online(size_t index) const { return _units[index]->online; }
+
+    /**
+     * @brief 立即推进一个模组，可在任意线程调用 / Advance a unit at once, callable from any thread
+     *
+     * 从外部线程提交异步命令或开始会话后调用，超时检查无需等待下一次定时推进。
+     * Call after submitting an asynchronous command or starting a session from another thread, so its timeout is
+     * checked without waiting for the next timed pass.
+     */
+    void wake(size_t index);
+
+    /**
+     * @brief 在所有在线模组上同时自动比对，由最先检测到手指的模组做出判定 / Run auto identification on every online unit at once; the first unit to see a finger decides
+     *
+     * 模组报告无手指或超时后重新开始比对，直到 timeout_ms 到期。一个模组得出结果（成功、未搜索到或图像错误）后，
+     * 其余模组的流程被取消。同一时刻只能运行一个 identifyAny()，期间不要在这些模组上运行其它自动流程。
+     * A unit that reports no finger or a timeout starts over until timeout_ms expires. Once one unit reaches a result
+     * (success, not found or an image error) the flows on the other units are cancelled. One identifyAny() runs at a
+     * time; do not run other auto flows on the units meanwhile.
+     *
+     * @param timeout_ms 等待手指的最长时间 / Longest time to wait for a finger
+     * @param match 输出：做出判定的模组及其结果 / Output: the unit that decided and its result
+     * @param securityLevel 安全等级（0-1） / Security level (0-1)
+     * @param flags 自动比对标志 / Auto identify flags
+     * @return 判定模组的比对结果；没有模组检测到手指返回 FINGERPRINT_TIMEOUT；没有在线模组返回
+     *         FINGERPRINT_MODULE_NOT_OPEN
+     *         The deciding unit's identification result; FINGERPRINT_TIMEOUT if no unit saw a finger;
+     *         FINGERPRINT_MODULE_NOT_OPEN if no unit is online
+     */
+    fingerprint_status_t identifyAny(uint32_t timeout_ms, fingerprint_fleet_match_t& match, uint8_t securityLevel = 0,
+                                     fingerprint_auto_verify_flags_t flags = FINGERPRINT_AUTO_VERIFY_DEFAULT);
+
+    void getStats(fingerprint_fleet_stats_t& stats) const;
+
+private:
+    struct Unit {
+        std::string path;  // 串口设备路径，由管理器打开时非空 / Serial device path, non-empty when the manager opens it
+        Fingerprint_FdTransport* transport       = nullptr;
+        M5UnitFingerprint2* device               = nullptr;
+        Fingerprint_AutoIdentifySession* session = nullptr;  // identifyAny() 使用 / Used by identifyAny()
+        bool online                              = false;
+        std::atomic<bool> busy{false};                       // 已排队或正在推进 / Queued or being advanced
+        std::atomic<unsigned long> due{~0UL};                // 下一次超时检查的时间，~0 表示没有 / Time of the next timeout check, ~0 if none
+    };
+
+    struct Worker {
+        std::mutex lock;
+        std::deque<size_t> tasks;  // 模组序号，本线程从头部取，其它线程从尾部窃取 / Unit indices; taken from the front by the owner, stolen from the back by others
+        std::thread thread;
+        std::atomic<uint32_t> updates{0};
+        std::atomic<uint32_t> steals{0};
+    };
+
+    int addUnit(Unit* unit, uint32_t address);
+    void schedule(size_t index);
+    bool takeTask(size_t self, size_t& index);
+    void service(size_t index);
+    void pollLoop();
+    void workerLoop(size_t self);
+    void waitActivity(uint32_t seen, uint32_t timeout_ms);
+
+    size_t _requestedWorkers;
+    std::vector<Unit*> _units;
+    std::vector<Worker*> _workers;
+    std::thread _poller;
+    std::atomic<bool> _running{false};
+    int _epollFd = -1;
+    int _wakeFd  = -1;  // eventfd，唤醒轮询线程 / eventfd waking the poller thread
+
+    // 待执行任务数，空闲工作线程在此等待 / Pending tasks; idle workers wait here
+    std::mutex _idleLock;
+    std::condition_variable _idleCv;
+    std::atomic<int> _pending{0};
+
+    // 每次推进后递增，identifyAny() 据此等待会话变化 / Incremented after every pass; identifyAny() waits on it for session changes
+    std::mutex _activityLock;
+    std::condition_variable _activityCv;
+    std::atomic<uint32_t> _activitySeq{0};
+    std::atomic<int> _activityWaiters{0};
+
+    std::mutex _identifyLock;  // 同一时刻只运行一个 identifyAny() / One identifyAny() at a time
+
+    std::atomic<uint32_t> _events{0};
+    std::atomic<uint32_t> _sweeps{0};
+};
+
+#endif
+
+#endif  // __M5_UNIT_FINGERPRINT2_FLEET_H
@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "M5UnitFingerprint2_framer.hpp"
+#include <cstring>
+
+Fingerprint_Framer::Fingerprint_Framer(Fingerprint_FrameCallback_t callback, void* context)
+    : _callback(callback),
+      _storage(nullptr),
+      _context(context),
+      _frame(nullptr),
+      _index(0),
+      _frameLength(0),
+      _sum(0),
+      _replayLength(0),
+      _replayPos(0),
+      _frameCount(0),
+      _checksumErrors(0),
+      _discardedBytes(0)
+{
+}
+
+void Fingerprint_Framer::setCallback(Fingerprint_FrameCallback_t callback, void* context)
+{
+    _callback = callback;
+    _context  = context;
+}
+
+void Fingerprint_Framer::setStorageCallback(Fingerprint_FrameStorageCallback_t storage)
+{
+    _storage = storage;
+}
+
+void Fingerprint_Framer::reset()
+{
+    _index        = 0;
+    _frameLength  = 0;
+    _sum          = 0;
+    _replayLength = 0;
+    _replayPos    = 0;
+}
+
+// 输入字节流，逐字节推进状态机 / Feed byte stream, advancing the state machine one byte at a time
+size_t Fingerprint_Framer::feed(const uint8_t* data, size_t length)
+{
+    if (data == nullptr) {
+        length = 0;
+    }
+
+    size_t frames = 0;
+    size_t i      = 0;
+    while (i < length || _replayPos < _replayLength) {
+        // 先处理重新同步后待重放的字节 / Replay bytes left over from a resync first
+        uint8_t byte = (_replayPos < _replayLength) ? _replay[_replayPos++] : data[i++];
+
+        // 新帧开始时获取存储，优先使用外部提供的存储以免输出时再拷贝 / Get storage when a new frame starts, preferring external storage so no copy is needed on emit
+        if (_frame == nullptr) {
+            _frame = (_storage != nullptr) ? _storage(_context) : nullptr;
+            if (_frame == nullptr) {
+                _frame = _ownFrame;
+            }
+        }
+
+        _frame[_index] = byte;
+        if (!acceptByte(_index)) {
+            _index++;
+            resync();
+            continue;
+        }
+        _index++;
+
+        // 帧头完整且收到最后一个校验和字节 / Header complete and last checksum byte received
+        if (_index >= FINGERPRINT_PACKET_HEADER_SIZE && _index == _frameLength) {
+            uint16_t receivedChecksum = (_frame[_index - 2] << 8) | _frame[_index - 1];
+            if (receivedChecksum == _sum) {
+                // 输出后存储归接收方所有，下一帧重新获取 / After emitting, the storage belongs to the receiver; the next frame gets new storage
+                uint8_t* frame     = _frame;
+                size_t frameLength = _index;
+                _frame             = nullptr;
+                _index             = 0;
+                _frameCount++;
+                frames++;
+                if (_callback != nullptr) {
+                    _callback(_context, frame, frameLength);
+                }
+            } else {
+#if defined M5_MODULE_DEBUG_SERIAL
+                serialPrintf("Checksum mismatch: expected 0x%04X, got 0x%04X\r\n", _sum, receivedChecksum);
+#endif
+                _checksumErrors++;
+                resync();
+            }
+        }
+    }
+
+    _replayLength = 0;
+    _replayPos    = 0;
+    return frames;
+}
+
+// 校验当前字节：起始码 -> 地址 -> 包标识 -> 包长度 -> 数据 -> 校验和 / Validate current byte: start code -> address -> packet identifier -> length -> data -> checksum
+bool Fingerprint_Framer::acceptByte(size_t pos)
+{
+    uint8_t byte = _frame[pos];
+
+    switch (pos) {
+        case 0:
+            return byte == ((FINGERPRINT_STARTCODE >> 8) & 0xFF);
+        case 1:
+            return byte == (FINGERPRINT_STARTCODE & 0xFF);
+        case 2:
+        case 3:
+        case 4:
+        case 5:
+            // 地址不做限制，与之前的解析行为一致 / Address is not restricted, same as previous parser behavior
+            return true;
+        case 6:
+            return byte == FINGERPRINT_PACKET_COMMANDPACKET || byte == FINGERPRINT_PACKET_DATAPACKET ||
+                   byte == FINGERPRINT_PACKET_ACKPACKET || byte == FINGERPRINT_PACKET_ENDDATAPACKET;
+        case 7:
+            return true;
+        case 8: {
+            // 包长度包含 2 字节校验和 / Packet length includes the 2-byte checksum
+            uint16_t dataLength = (_frame[7] << 8) | byte;
+            if (dataLength < 2 || dataLength > FINGERPRINT_RX_MAX_PAYLOAD_SIZE + 2) {
+                return false;
+            }
+            _frameLength = FINGERPRINT_PACKET_HEADER_SIZE + dataLength;
+            _sum         = _frame[6] + _frame[7] + byte;  // 按字节累加，长度 >= 256 时与数值不同 / Summed byte by byte, which differs from the value once the length is 256 or more
+            return true;
+        }
+        default:
+            if (pos < _frameLength - 2) {
+                _sum += byte;
+            }
+            return true;
+    }
+}
+
+// 丢弃首字节，从下一个可能的起始码开始重放剩余字节 / Drop the first byte and replay the rest from the next possible start code
+void Fingerprint_Framer::resync()
+{
+    size_t skip = 1;
+    while (skip < _index && _frame[skip] != ((FINGERPRINT_STARTCODE >> 8) & 0xFF)) {
+        skip++;
+    }
+    _discardedBytes += skip;
+
+    // 被丢弃帧的剩余部分位于尚未重放的字节之前 / The rest of the rejected frame precedes the bytes not yet replayed
+    size_t tail    = _index - skip;
+    size_t pending = _replayLength - _replayPos;
+    memmove(_replay + tail, _replay + _replayPos, pending);
+    memcpy(_replay, _frame + skip, tail);
+    _replayLength = tail + pending;
+    _replayPos    = 0;
+    _index        = 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_FRAMER_H
+#define __M5_UNIT_FINGERPRINT2_FRAMER_H
+
+#include "M5UnitFingerprint2_defs.hpp"
+
+// 完整帧回调函数类型定义 / Complete frame callback function type definition
+// 参数： / Parameters:
+//   context: 注册回调时传入的上下文指针 / Context pointer passed when registering the callback
+//   frame: 完整数据包（起始码到校验和） / Complete packet (start code to checksum)
+//   length: 数据包总长度 / Total packet length
+typedef void (*Fingerprint_FrameCallback_t)(void* context, const uint8_t* frame, size_t length);
+
+// 帧存储回调函数类型定义：返回至少 FINGERPRINT_MAX_FRAME_SIZE 字节的存储区，返回 nullptr 时使用内部缓冲
+// Frame storage callback function type definition: returns storage of at least FINGERPRINT_MAX_FRAME_SIZE bytes,
+// or nullptr to use the internal buffer
+typedef uint8_t* (*Fingerprint_FrameStorageCallback_t)(void* context);
+
+/**
+ * @brief 流式数据包分帧器 / Streaming packet framer
+ *
+ * 逐字节解析 EF01 协议帧：起始码 -> 地址 -> 包标识 -> 包长度 -> 数据 -> 校验和。
+ * 依据偏移 7~8 的长度字段确定帧尾，在收到最后一个校验和字节时立即回调输出完整帧，
+ * 不再依赖串口空闲间隔。帧头或校验和错误时从下一个可能的起始码重新同步。
+ *
+ * Parses EF01 protocol frames byte by byte: start code -> address -> packet identifier -> length -> data -> checksum.
+ * The length field at offsets 7-8 determines where the frame ends, and the complete frame is emitted through the
+ * callback as soon as its last checksum byte arrives, without waiting for the line to go idle. On a bad header or
+ * checksum the framer resynchronizes on the next possible start code.
+ */
+class Fingerprint_Framer {
+public:
+    Fingerprint_Framer(Fingerprint_FrameCallback_t callback = nullptr, void* context = nullptr);
+
+    /**
+     * @brief 设置完整帧回调 / Set complete frame callback
+     * @param callback 回调函数 / Callback function
+     * @param context 回调上下文 / Callback context
+     */
+    void setCallback(Fingerprint_FrameCallback_t callback, void* context);
+
+    /**
+     * @brief 设置帧存储回调，使帧直接组装在调用者提供的存储中 / Set frame storage callback so frames are assembled directly in caller-provided storage
+     *
+     * 每个新帧开始时请求一次存储；帧输出后存储归回调接收方所有。
+     * Storage is requested once per new frame; after the frame is emitted the storage belongs to the callback receiver.
+     * @param storage 存储回调，使用 setCallback() 的上下文 / Storage callback, uses the context from setCallback()
+     */
+    void setStorageCallback(Fingerprint_FrameStorageCallback_t storage);
+
+    /**
+     * @brief 丢弃未完成的帧并回到等待起始码状态 / Drop any partial frame and wait for a start code again
+     */
+    void reset();
+
+    /**
+     * @brief 输入接收到的字节流 / Feed received byte stream
+     * @param data 数据缓冲区 / Data buffer
+     * @param length 数据长度 / Data length
+     * @return 本次输出的完整帧数量 / Number of complete frames emitted by this call
+     */
+    size_t feed(const uint8_t* data, size_t length);
+
+    /**
+     * @brief 是否正在接收一个未完成的帧 / Whether a partial frame is being received
+     */
+    bool isReceiving() const { return _index > 0; }
+
+    uint32_t getFrameCount() const { return _frameCount; }                 // 已输出帧数 / Frames emitted
+    uint32_t getChecksumErrorCount() const { return _checksumErrors; }     // 校验和错误数 / Checksum errors
+    uint32_t getDiscardedByteCount() const { return _discardedBytes; }     // 重新同步丢弃的字节数 / Bytes dropped while resyncing
+
+private:
+    bool acceptByte(size_t pos);  // 校验 _frame[pos]，前面的字节均已有效 / Validate _frame[pos], given all earlier bytes are valid
+    void resync();                // 丢弃首字节并将其余字节重新送入状态机 / Drop the first byte and replay the rest
+
+    Fingerprint_FrameCallback_t _callback;
+    Fingerprint_FrameStorageCallback_t _storage;
+    void* _context;
+
+    uint8_t* _frame;                                // 当前帧存储 / Current frame storage
+    uint8_t _ownFrame[FINGERPRINT_MAX_FRAME_SIZE];  // 无外部存储时使用的内部缓冲 / Internal buffer used when no external storage is available
+    size_t _index;                                  // 当前帧已接收字节数 / Bytes received for current frame
+    size_t _frameLength;                            // 当前帧总长度（帧头完整后有效） / Current frame total length (valid after header)
+    uint16_t _sum;                                  // 增量校验和 / Incremental checksum
+
+    // 重新同步时待重放的字节 / Bytes waiting to be replayed after a resync
+    uint8_t _replay[FINGERPRINT_MAX_FRAME_SIZE];
+    size_t _replayLength;
+    size_t _replayPos;
+
+    uint32_t _frameCount;
+    uint32_t _checksumErrors;
+    uint32_t _discardedBytes;
+};
+
+#endif  // __M5_UNIT_FINGERPRINT2_FRAMER_H
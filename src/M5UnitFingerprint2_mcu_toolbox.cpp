@@ -17,18 +17,16 @@ fingerprint_status_t M5UnitFingerprint2::PS_SetSleepTime(uint8_t SleepTime) cons
 
     // 创建命令数据包 / Create command packet
     uint8_t params[] = {SleepTime};
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_SET_SLEEP_TIME, params, 1);
 
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_SET_SLEEP_TIME, 1>(params)) {
         serialPrintln("Failed to send PS_SetSleepTime command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_SetSleepTime response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -60,19 +58,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_SetSleepTime(uint8_t SleepTime) cons
 // 获取休眠时间 / Get sleep time
 fingerprint_status_t M5UnitFingerprint2::PS_GeTSleepTime(uint8_t& SleepTime) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_GET_SLEEP_TIME, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_GET_SLEEP_TIME>()) {
         serialPrintln("Failed to send PS_GeTSleepTime command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_GeTSleepTime response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -112,18 +106,16 @@ fingerprint_status_t M5UnitFingerprint2::PS_SetWorkMode(uint8_t WorkMode) const
 
     // 创建命令数据包 / Create command packet
     uint8_t params[] = {WorkMode};
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_SET_WORK_MODE, params, 1);
 
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_SET_WORK_MODE, 1>(params)) {
         serialPrintln("Failed to send PS_SetWorkMode command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_SetWorkMode response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -156,19 +148,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_SetWorkMode(uint8_t WorkMode) const
 // 获取工作模式 / Get work mode
 fingerprint_status_t M5UnitFingerprint2::PS_GetWorkMode(uint8_t& WorkMode) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_GET_WORK_MODE, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_GET_WORK_MODE>()) {
         serialPrintln("Failed to send PS_GetWorkMode command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_GetWorkMode response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -200,19 +188,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_GetWorkMode(uint8_t& WorkMode) const
 // 激活指纹模块 / Activate fingerprint module
 fingerprint_status_t M5UnitFingerprint2::PS_ActivateFingerprintModule(void) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_ACTIVATE_MODULE, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_ACTIVATE_MODULE>()) {
         serialPrintln("Failed to send PS_ActivateFingerprintModule command");
         return FINGERPRINT_PACKET_TIMEOUT;  // 返回错误状态 / Return error status
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_ActivateFingerprintModule response");
         return FINGERPRINT_PACKET_TIMEOUT;  // 返回错误状态 / Return error status
@@ -244,20 +228,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_ActivateFingerprintModule(void) cons
 // 获取模块激活状态 / Get module activation status
 fingerprint_status_t M5UnitFingerprint2::PS_GetFingerprintModuleStatus(uint8_t& ModuleStatus) const
 {
-    // 创建命令数据包 / Create command packet
-    uint8_t commandData[] = {FINGERPRINT_GET_MODULE_STATUS};
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_GET_MODULE_STATUS, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_GET_MODULE_STATUS>()) {
         serialPrintln("Failed to send PS_GetFingerprintModuleStatus command");
         return FINGERPRINT_PACKET_TIMEOUT;  // 返回错误状态 / Return error status
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_GetFingerprintModuleStatus response");
         return FINGERPRINT_PACKET_TIMEOUT;  // 返回错误状态 / Return error status
@@ -298,18 +277,16 @@ fingerprint_status_t M5UnitFingerprint2::PS_SaveConfigurationToFlash(uint8_t Sav
 
     // 创建命令数据包 / Create command packet
     uint8_t params[] = {SaveOptions};
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_SAVE_CONF_TO_FLASH, params, 1);
 
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_SAVE_CONF_TO_FLASH, 1>(params)) {
         serialPrintln("Failed to send PS_SaveConfigurationToFlash command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_SaveConfigurationToFlash response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -342,19 +319,15 @@ fingerprint_status_t M5UnitFingerprint2::PS_SaveConfigurationToFlash(uint8_t Sav
 // 获取固件版本 / Get firmware version
 fingerprint_status_t M5UnitFingerprint2::PS_GetFirmwareVersion(uint8_t& FwVersion) const
 {
-    // 创建命令数据包 / Create command packet
-    Fingerprint_Packet commandPacket =
-        Fingerprint_Packet::new_command_packet(_fp2_address, FINGERPRINT_GET_FINGERPRINT_VERSION, nullptr, 0);
-
     // 发送命令包 / Send command packet
     M5UnitFingerprint2* nonConstThis = const_cast<M5UnitFingerprint2*>(this);
-    if (!nonConstThis->sendPacketData(commandPacket)) {
+    if (!nonConstThis->sendCommand<FINGERPRINT_GET_FINGERPRINT_VERSION>()) {
         serialPrintln("Failed to send PS_GetFirmwareVersion command");
         return FINGERPRINT_PACKET_TIMEOUT;
     }
 
     // 接收响应包 / Receive response packet
-    Fingerprint_Packet responsePacket(FINGERPRINT_STARTCODE, 0, FINGERPRINT_PACKET_ACKPACKET, nullptr, 0);
+    Fingerprint_PacketView responsePacket;
     if (!nonConstThis->receivePacketData(responsePacket, 1000)) {
         serialPrintln("Failed to receive PS_GetFirmwareVersion response");
         return FINGERPRINT_PACKET_TIMEOUT;
@@ -376,6 +349,9 @@ fingerprint_status_t M5UnitFingerprint2::PS_GetFirmwareVersion(uint8_t& FwVersio
     const uint8_t* responseData = responsePacket.get_data();
     uint8_t confirmationCode    = responseData[0];
     FwVersion                     = responseData[1];
+    if (confirmationCode == FINGERPRINT_OK) {
+        nonConstThis->_firmwareVersion.store(FwVersion);
+    }
 
     serialPrintf("Get firmware FwVersion: 0x%02X [confirmation: %s]\r\n", FwVersion,
                  FingerprintDebugUtils::getStatusName(confirmationCode).c_str());
@@ -0,0 +1,63 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_PLATFORM_H
+#define __M5_UNIT_FINGERPRINT2_PLATFORM_H
+
+// 平台适配层：Arduino 平台直接使用 Arduino.h；原生（Linux 主机）平台提供本库用到的最小 Arduino API 子集
+// Platform shim: Arduino platforms use Arduino.h directly; native (Linux host) builds get the minimal subset of the
+// Arduino API this library uses
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#define FINGERPRINT_NATIVE_PLATFORM 1
+
+// 自首次调用起经过的毫秒数 / Milliseconds since the first call
+inline unsigned long millis()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return static_cast<unsigned long>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+// 自首次调用起经过的微秒数 / Microseconds since the first call
+inline unsigned long micros()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return static_cast<unsigned long>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+inline void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// 调试工具使用的 Arduino String 最小替代 / Minimal stand-in for the Arduino String used by the debug utilities
+class String : public std::string {
+public:
+    String() = default;
+    String(const char* s) : std::string(s != nullptr ? s : "") {}
+    String(const std::string& s) : std::string(s) {}
+    String(int value) : std::string(std::to_string(value)) {}
+    String(unsigned int value) : std::string(std::to_string(value)) {}
+    String(long value) : std::string(std::to_string(value)) {}
+    String(unsigned long value) : std::string(std::to_string(value)) {}
+    String(unsigned char value) : std::string(std::to_string(value)) {}
+};
+
+#endif
+
+#endif  // __M5_UNIT_FINGERPRINT2_PLATFORM_H
@@ -0,0 +1,365 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_QUEUE_H
+#define __M5_UNIT_FINGERPRINT2_QUEUE_H
+
+#include "M5UnitFingerprint2_defs.hpp"
+#include <cstring>
+
+// 解析包分发通道 / Parsed packet dispatch lanes
+typedef enum {
+    FINGERPRINT_LANE_ACK   = 0,     // 应答包 / Acknowledge packets
+    FINGERPRINT_LANE_DATA  = 1,     // 数据包与结束包 / Data and end-of-data packets
+    FINGERPRINT_LANE_COUNT = 2,
+    FINGERPRINT_LANE_ANY   = 0xFF,  // 所有通道中最早到达的包 / Earliest arrival across all lanes
+} fingerprint_lane_t;
+
+// 解析完成的数据包（完整帧） / Parsed packet (complete frame)
+struct Fingerprint_ParsedPacket {
+    uint8_t data[FINGERPRINT_MAX_FRAME_SIZE];  // 完整包数据 / Complete packet data
+    uint16_t length;                           // 包长度 / Packet length
+    unsigned long timestamp;                   // 接收时间戳 / Receive timestamp
+    uint32_t stampUs;                          // 解析完成的时间（微秒），用于交接延迟 / Time the frame was parsed (microseconds), for the handoff latency
+    uint32_t sequence;                         // 到达序号 / Arrival sequence number
+};
+
+/**
+ * @brief 解析包分发表 / Parsed packet dispatch table
+ *
+ * 固定数量的包槽位由空闲链表管理；每个通道（ACK、DATA/END）是一个只保存槽位索引的环形队列。
+ * 入队、出队和按通道取包均为 O(1)，包内容写入槽位后不再移动。队列满时淘汰最早到达的包。
+ * 分帧器可以预留槽位直接组帧（reserve/commitReserved），使用者可以取出槽位只读访问直到归还（claim/release）。
+ *
+ * A fixed pool of packet slots is managed by a free list; each lane (ACK, DATA/END) is a ring that only holds slot
+ * indices. Enqueue, dequeue and per-lane lookup are O(1), and packet contents never move once written into a slot.
+ * When the table is full, the earliest arrival is evicted. The framer can reserve a slot and assemble a frame in
+ * place (reserve/commitReserved), and consumers can take a slot for read-only access until they return it
+ * (claim/release).
+ *
+ * @tparam Depth 包槽位数量 / Number of packet slots
+ */
+template <size_t Depth>
+class Fingerprint_PacketQueue {
+    static_assert(Depth > 0 && Depth < 0xFFFF, "Packet queue depth must fit a 16-bit slot index");
+
+public:
+    typedef uint16_t index_t;
+    static const index_t INVALID_INDEX = 0xFFFF;
+
+    Fingerprint_PacketQueue() {
+        clear();
+    }
+
+    // 清空所有通道并回收全部槽位 / Empty every lane and reclaim all slots
+    void clear() {
+        for (size_t i = 0; i < Depth; i++) {
+            _free[i] = static_cast<index_t>(Depth - 1 - i);
+        }
+        _freeCount = Depth;
+        for (size_t l = 0; l < FINGERPRINT_LANE_COUNT; l++) {
+            _lanes[l].head  = 0;
+            _lanes[l].count = 0;
+        }
+        _sequence = 0;
+        _reserved = INVALID_INDEX;
+    }
+
+    // 包标识对应的通道，非应答/数据包返回 FINGERPRINT_LANE_COUNT / Lane for a packet identifier, FINGERPRINT_LANE_COUNT if not ACK/data
+    static fingerprint_lane_t laneOf(uint8_t type) {
+        switch (type) {
+            case FINGERPRINT_PACKET_ACKPACKET:
+                return FINGERPRINT_LANE_ACK;
+            case FINGERPRINT_PACKET_DATAPACKET:
+            case FINGERPRINT_PACKET_ENDDATAPACKET:
+                return FINGERPRINT_LANE_DATA;
+            default:
+                return FINGERPRINT_LANE_COUNT;
+        }
+    }
+
+    /**
+     * @brief 将完整帧放入对应通道 / Put a complete frame into its lane
+     * @param frame 完整帧 / Complete frame
+     * @param length 帧长度 / Frame length
+     * @param timestamp 接收时间戳 / Receive timestamp
+     * @param stampUs 解析完成的时间（微秒） / Time the frame was parsed (microseconds)
+     * @return 成功返回 true；帧过大或不是应答/数据包返回 false / true on success; false if the frame is too large or not an ACK/data packet
+     */
+    bool push(const uint8_t* frame, size_t length, unsigned long timestamp, uint32_t stampUs = 0) {
+        if (length < FINGERPRINT_PACKET_HEADER_SIZE || length > FINGERPRINT_MAX_FRAME_SIZE) {
+            return false;
+        }
+        fingerprint_lane_t lane = laneOf(frame[6]);
+        if (lane == FINGERPRINT_LANE_COUNT) {
+            return false;
+        }
+
+        index_t index = allocate();
+        if (index == INVALID_INDEX) {
+            _dropped++;
+            return false;
+        }
+        memcpy(_slots[index].data, frame, length);
+        enqueue(lane, index, length, timestamp, stampUs);
+        return true;
+    }
+
+    /**
+     * @brief 预留一个槽位供分帧器直接写入完整帧 / Reserve a slot for the framer to assemble a frame into directly
+     *
+     * 同一时刻最多一个预留槽位；重复调用返回同一槽位。 / At most one slot is reserved at a time; repeated calls return the same slot.
+     * @return 槽位数据区（FINGERPRINT_MAX_FRAME_SIZE 字节），无可用槽位时返回 nullptr / Slot data area (FINGERPRINT_MAX_FRAME_SIZE bytes), nullptr if no slot is available
+     */
+    uint8_t* reserve() {
+        if (_reserved == INVALID_INDEX) {
+            _reserved = allocate();
+            if (_reserved == INVALID_INDEX) {
+                return nullptr;
+            }
+        }
+        return _slots[_reserved].data;
+    }
+
+    // 指针是否为预留槽位 / Whether the pointer is the reserved slot
+    bool isReserved(const uint8_t* data) const {
+        return _reserved != INVALID_INDEX && data == _slots[_reserved].data;
+    }
+
+    /**
+     * @brief 将预留槽位中已写好的帧放入对应通道（无拷贝） / Put the frame assembled in the reserved slot into its lane (no copy)
+     * @return 成功返回 true；不是应答/数据包时释放槽位并返回 false / true on success; releases the slot and returns false if not an ACK/data packet
+     */
+    bool commitReserved(size_t length, unsigned long timestamp, uint32_t stampUs = 0) {
+        if (_reserved == INVALID_INDEX) {
+            return false;
+        }
+        index_t index = _reserved;
+        _reserved     = INVALID_INDEX;
+
+        fingerprint_lane_t lane = laneOf(_slots[index].data[6]);
+        if (lane == FINGERPRINT_LANE_COUNT || length > FINGERPRINT_MAX_FRAME_SIZE) {
+            _free[_freeCount++] = index;
+            return false;
+        }
+        enqueue(lane, index, length, timestamp, stampUs);
+        return true;
+    }
+
+    // 放弃预留槽位 / Give up the reserved slot
+    void cancelReserved() {
+        if (_reserved != INVALID_INDEX) {
+            _free[_freeCount++] = _reserved;
+            _reserved           = INVALID_INDEX;
+        }
+    }
+
+    /**
+     * @brief 取出通道队首的包但不回收槽位，直到 release() / Take the head of a lane without reclaiming its slot until release()
+     * @param lane 通道，FINGERPRINT_LANE_ANY 表示所有通道中最早到达的包 / Lane, FINGERPRINT_LANE_ANY for the earliest arrival across all lanes
+     * @return 槽位索引，通道为空时返回 INVALID_INDEX / Slot index, INVALID_INDEX if the lane is empty
+     */
+    index_t claim(fingerprint_lane_t lane = FINGERPRINT_LANE_ANY) {
+        if (lane == FINGERPRINT_LANE_ANY) {
+            lane = oldestLane();
+        }
+        if (lane >= FINGERPRINT_LANE_COUNT || _lanes[lane].count == 0) {
+            return INVALID_INDEX;
+        }
+        Lane& l       = _lanes[lane];
+        index_t index = l.ring[l.head];
+        l.head        = (l.head + 1) % Depth;
+        l.count--;
+        return index;
+    }
+
+    // 归还 claim() 取出的槽位 / Return a slot taken with claim()
+    void release(index_t index) {
+        if (index < Depth) {
+            _free[_freeCount++] = index;
+        }
+    }
+
+    const Fingerprint_ParsedPacket& slot(index_t index) const {
+        return _slots[index];
+    }
+
+    /**
+     * @brief 获取通道队首的包 / Get the packet at the head of a lane
+     * @param lane 通道，FINGERPRINT_LANE_ANY 表示所有通道中最早到达的包 / Lane, FINGERPRINT_LANE_ANY for the earliest arrival across all lanes
+     * @return 包指针，通道为空时返回 nullptr / Packet pointer, nullptr if the lane is empty
+     */
+    const Fingerprint_ParsedPacket* front(fingerprint_lane_t lane = FINGERPRINT_LANE_ANY) const {
+        if (lane == FINGERPRINT_LANE_ANY) {
+            lane = oldestLane();
+        }
+        if (lane >= FINGERPRINT_LANE_COUNT || _lanes[lane].count == 0) {
+            return nullptr;
+        }
+        return &_slots[_lanes[lane].ring[_lanes[lane].head]];
+    }
+
+    // 移除通道队首的包并回收槽位 / Remove the packet at the head of a lane and reclaim its slot
+    void pop(fingerprint_lane_t lane = FINGERPRINT_LANE_ANY) {
+        if (lane == FINGERPRINT_LANE_ANY) {
+            lane = oldestLane();
+        }
+        if (lane < FINGERPRINT_LANE_COUNT) {
+            popLane(lane);
+        }
+    }
+
+    // 设置通道中包的生存时间（毫秒） / Set the lifetime of packets in a lane (milliseconds)
+    void setLifetime(fingerprint_lane_t lane, uint32_t lifetime) {
+        if (lane < FINGERPRINT_LANE_COUNT) {
+            _lifetime[lane] = lifetime;
+        }
+    }
+
+    uint32_t lifetime(fingerprint_lane_t lane) const {
+        return (lane < FINGERPRINT_LANE_COUNT) ? _lifetime[lane] : 0;
+    }
+
+    /**
+     * @brief 移除超时的包 / Remove expired packets
+     *
+     * 同一通道中的包生存时间相同且按到达顺序排列，因此也按过期时间排列，只需检查队首，开销为 O(过期数)。
+     * Packets in a lane share one lifetime and are in arrival order, hence also in deadline order, so only heads
+     * need checking and the cost is O(expired).
+     * @return 移除的包数量 / Number of packets removed
+     */
+    size_t expire(unsigned long now) {
+        size_t removed = 0;
+        for (size_t l = 0; l < FINGERPRINT_LANE_COUNT; l++) {
+            Lane& lane = _lanes[l];
+            while (lane.count > 0 && now - _slots[lane.ring[lane.head]].timestamp >= _lifetime[l]) {
+                popLane(static_cast<fingerprint_lane_t>(l));
+                removed++;
+            }
+        }
+        _expired += removed;
+        return removed;
+    }
+
+    /**
+     * @brief 距最早一个包过期的时间 / Time until the earliest packet expires
+     * @return 毫秒数，已有包过期时为 0，没有待过期的包时为 UINT32_MAX / Milliseconds, 0 if a packet is already due, UINT32_MAX if nothing is queued
+     */
+    uint32_t nextExpiry(unsigned long now) const {
+        uint32_t wait = UINT32_MAX;
+        for (size_t l = 0; l < FINGERPRINT_LANE_COUNT; l++) {
+            const Lane& lane = _lanes[l];
+            if (lane.count == 0) {
+                continue;
+            }
+            unsigned long age = now - _slots[lane.ring[lane.head]].timestamp;
+            uint32_t remain   = (age >= _lifetime[l]) ? 0 : static_cast<uint32_t>(_lifetime[l] - age);
+            if (remain < wait) {
+                wait = remain;
+            }
+        }
+        return wait;
+    }
+
+    // 通道中的包数量（不含预留和被视图持有的槽位） / Packets in lanes (excludes reserved slots and slots held by views)
+    size_t size() const {
+        size_t count = 0;
+        for (size_t l = 0; l < FINGERPRINT_LANE_COUNT; l++) {
+            count += _lanes[l].count;
+        }
+        return count;
+    }
+
+    size_t size(fingerprint_lane_t lane) const {
+        return (lane < FINGERPRINT_LANE_COUNT) ? _lanes[lane].count : size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // 因队列满而被淘汰的包数量 / Packets evicted because the table was full
+    uint32_t droppedCount() const {
+        return _dropped;
+    }
+
+    // 到期仍未被取走的包数量 / Packets that expired without being claimed
+    uint32_t expiredCount() const {
+        return _expired;
+    }
+
+private:
+    struct Lane {
+        index_t ring[Depth];  // 槽位索引环 / Ring of slot indices
+        size_t head;
+        size_t count;
+    };
+
+    // 各通道队首中最早到达的通道 / Lane whose head arrived first
+    fingerprint_lane_t oldestLane() const {
+        fingerprint_lane_t oldest = FINGERPRINT_LANE_COUNT;
+        uint32_t oldestSequence   = 0;
+        for (size_t l = 0; l < FINGERPRINT_LANE_COUNT; l++) {
+            if (_lanes[l].count == 0) {
+                continue;
+            }
+            uint32_t sequence = _slots[_lanes[l].ring[_lanes[l].head]].sequence;
+            if (oldest == FINGERPRINT_LANE_COUNT || static_cast<int32_t>(sequence - oldestSequence) < 0) {
+                oldest         = static_cast<fingerprint_lane_t>(l);
+                oldestSequence = sequence;
+            }
+        }
+        return oldest;
+    }
+
+    // 分配空闲槽位，无空闲时淘汰最早到达的包 / Allocate a free slot, evicting the earliest arrival if none is free
+    index_t allocate() {
+        if (_freeCount == 0) {
+            fingerprint_lane_t oldest = oldestLane();
+            if (oldest == FINGERPRINT_LANE_COUNT) {
+                return INVALID_INDEX;  // 所有槽位都被视图持有 / Every slot is held by a view
+            }
+            popLane(oldest);
+            _dropped++;
+        }
+        return _free[--_freeCount];
+    }
+
+    void enqueue(fingerprint_lane_t lane, index_t index, size_t length, unsigned long timestamp, uint32_t stampUs) {
+        Fingerprint_ParsedPacket& pkt = _slots[index];
+        pkt.length                    = static_cast<uint16_t>(length);
+        pkt.timestamp                 = timestamp;
+        pkt.stampUs                   = stampUs;
+        pkt.sequence                  = _sequence++;
+
+        Lane& l = _lanes[lane];
+        l.ring[(l.head + l.count) % Depth] = index;
+        l.count++;
+    }
+
+    void popLane(fingerprint_lane_t lane) {
+        if (lane >= FINGERPRINT_LANE_COUNT || _lanes[lane].count == 0) {
+            return;
+        }
+        Lane& l             = _lanes[lane];
+        _free[_freeCount++] = l.ring[l.head];
+        l.head              = (l.head + 1) % Depth;
+        l.count--;
+    }
+
+    Fingerprint_ParsedPacket _slots[Depth];
+    index_t _free[Depth];  // 空闲槽位栈 / Free slot stack
+    size_t _freeCount;
+    Lane _lanes[FINGERPRINT_LANE_COUNT];
+    uint32_t _sequence;
+    uint32_t _dropped = 0;
+    uint32_t _expired = 0;
+    uint32_t _lifetime[FINGERPRINT_LANE_COUNT] = {FINGERPRINT_ACK_PACKET_LIFETIME_MS,
+                                                  FINGERPRINT_DATA_PACKET_LIFETIME_MS};  // 各通道包生存时间 / Packet lifetime per lane
+    index_t _reserved;  // 分帧器预留的槽位 / Slot reserved by the framer
+};
+
+#endif  // __M5_UNIT_FINGERPRINT2_QUEUE_H
@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_RINGBUFFER_H
+#define __M5_UNIT_FINGERPRINT2_RINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief 单生产者/单消费者无锁环形缓冲区 / Single-producer/single-consumer lock-free ring buffer
+ *
+ * 读写索引单调递增，按容量取模定位，因此容量必须为 2 的幂。生产者只修改写索引，消费者只修改读索引，
+ * 两端无需互斥锁。读写均以连续区段（span）进行：回绕时分两段访问，不需要拷贝或 memmove 压缩。
+ * 缓冲区满时写入返回 0 而不是覆盖旧数据，由调用者施加背压。
+ *
+ * Read and write indices increase monotonically and are masked by the capacity, which therefore must be a power of
+ * two. The producer only advances the write index and the consumer only advances the read index, so neither side
+ * needs a mutex. Both sides work on contiguous spans: a wrapped region is accessed as two spans with no copy or
+ * memmove compaction. When the buffer is full, writes return 0 instead of overwriting old data, leaving the caller
+ * to apply back-pressure.
+ *
+ * @tparam Capacity 缓冲区容量（字节，2 的幂） / Buffer capacity in bytes (power of two)
+ */
+template <size_t Capacity>
+class Fingerprint_RingBuffer {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Ring buffer capacity must be a power of two");
+
+public:
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+    // 当前可读字节数 / Bytes currently readable
+    size_t size() const {
+        return _writeIndex.load(std::memory_order_acquire) - _readIndex.load(std::memory_order_acquire);
+    }
+
+    // 当前可写字节数 / Bytes currently writable
+    size_t space() const {
+        return Capacity - size();
+    }
+
+    /* ---------- 生产者端 / Producer side ---------- */
+
+    /**
+     * @brief 获取连续可写区段 / Get contiguous writable span
+     * @param span 输出：可写区段起始地址 / Output: start of writable span
+     * @return 区段长度，0 表示缓冲区已满 / Span length, 0 if the buffer is full
+     */
+    size_t writeSpan(uint8_t*& span) {
+        size_t write = _writeIndex.load(std::memory_order_relaxed);
+        size_t free  = Capacity - (write - _readIndex.load(std::memory_order_acquire));
+        size_t pos   = write & (Capacity - 1);
+        span         = &_buffer[pos];
+        return (free < Capacity - pos) ? free : Capacity - pos;
+    }
+
+    // 提交已写入 writeSpan() 区段的字节 / Publish bytes written into the writeSpan() region
+    void commitWrite(size_t length) {
+        _writeIndex.store(_writeIndex.load(std::memory_order_relaxed) + length, std::memory_order_release);
+        size_t used = size();
+        if (used > _highWatermark) {
+            _highWatermark = used;
+        }
+    }
+
+    /**
+     * @brief 写入数据，空间不足时只写入能容纳的部分 / Write data, only the part that fits if space is short
+     * @return 实际写入字节数 / Bytes actually written
+     */
+    size_t write(const uint8_t* data, size_t length) {
+        size_t written = 0;
+        while (written < length) {
+            uint8_t* span;
+            size_t n = writeSpan(span);
+            if (n == 0) {
+                break;
+            }
+            if (n > length - written) {
+                n = length - written;
+            }
+            memcpy(span, data + written, n);
+            commitWrite(n);
+            written += n;
+        }
+        return written;
+    }
+
+    /* ---------- 消费者端 / Consumer side ---------- */
+
+    /**
+     * @brief 获取连续可读区段 / Get contiguous readable span
+     * @param span 输出：可读区段起始地址 / Output: start of readable span
+     * @return 区段长度，0 表示缓冲区为空 / Span length, 0 if the buffer is empty
+     */
+    size_t readSpan(const uint8_t*& span) const {
+        size_t read  = _readIndex.load(std::memory_order_relaxed);
+        size_t avail = _writeIndex.load(std::memory_order_acquire) - read;
+        size_t pos   = read & (Capacity - 1);
+        span         = &_buffer[pos];
+        return (avail < Capacity - pos) ? avail : Capacity - pos;
+    }
+
+    // 释放已从 readSpan() 区段消费的字节 / Release bytes consumed from the readSpan() region
+    void commitRead(size_t length) {
+        _readIndex.store(_readIndex.load(std::memory_order_relaxed) + length, std::memory_order_release);
+    }
+
+    // 历史最高占用字节数 / Highest fill level seen
+    size_t highWatermark() const {
+        return _highWatermark;
+    }
+
+private:
+    uint8_t _buffer[Capacity];
+    std::atomic<size_t> _writeIndex{0};  // 仅生产者修改 / Modified by producer only
+    std::atomic<size_t> _readIndex{0};   // 仅消费者修改 / Modified by consumer only
+    size_t _highWatermark = 0;           // 仅生产者修改 / Modified by producer only
+};
+
+#endif  // __M5_UNIT_FINGERPRINT2_RINGBUFFER_H
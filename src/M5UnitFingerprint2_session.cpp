@@ -0,0 +1,412 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "M5UnitFingerprint2_session.hpp"
+
+// 剩余时间，已过期为 0 / Remaining time, 0 once expired
+static uint32_t remainingMs(unsigned long now, unsigned long since, uint32_t span)
+{
+    unsigned long elapsed = now - since;
+    return (elapsed >= span) ? 0 : static_cast<uint32_t>(span - elapsed);
+}
+
+Fingerprint_AutoFlowSession::Fingerprint_AutoFlowSession(M5UnitFingerprint2& device, uint8_t command,
+                                                         uint32_t totalTimeout_ms)
+    : _device(device), _command(command), _totalTimeout(totalTimeout_ms)
+{
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    _dispatchLock = xSemaphoreCreateMutex();
+#endif
+}
+
+// 销毁前注销，并阻塞等待进行中的分发结束；不得在本会话的回调中销毁 / Unregister before destruction and block until a dispatch in progress ends; must not be destroyed from its own callback
+Fingerprint_AutoFlowSession::~Fingerprint_AutoFlowSession()
+{
+    _device.acquireMutex();
+    if (_device._autoSession.load() == this) {
+        detach();
+    }
+    _device.releaseMutex();
+
+    // 注销后不会再有新的分发开始 / Once unregistered no new dispatch can start
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    if (_dispatchLock != nullptr) {
+        xSemaphoreTake(_dispatchLock, portMAX_DELAY);
+        xSemaphoreGive(_dispatchLock);
+        vSemaphoreDelete(_dispatchLock);
+    }
+#else
+    std::lock_guard<std::mutex> wait(_dispatchLock);
+#endif
+}
+
+bool Fingerprint_AutoFlowSession::tryLockDispatch()
+{
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    return _dispatchLock != nullptr && xSemaphoreTake(_dispatchLock, 0) == pdTRUE;
+#else
+    return _dispatchLock.try_lock();
+#endif
+}
+
+void Fingerprint_AutoFlowSession::unlockDispatch()
+{
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    xSemaphoreGive(_dispatchLock);
+#else
+    _dispatchLock.unlock();
+#endif
+}
+
+fingerprint_status_t Fingerprint_AutoFlowSession::start(const uint8_t* params, uint16_t length)
+{
+    if (state() == FINGERPRINT_SESSION_RUNNING) {
+        return FINGERPRINT_OPERATION_BLOCKED;
+    }
+    if (length > FINGERPRINT_ASYNC_PAYLOAD_SIZE) {
+        return FINGERPRINT_PARAM_ERROR;
+    }
+
+    // 先注册再发送，第一个阶段包不会错过 / Register before sending so the first stage packet cannot be missed
+    _device.acquireMutex();
+    if (_device._autoSession.load() != nullptr || _device._autoFlowCommand != 0) {
+        _device.releaseMutex();
+        serialPrintln("Auto flow session: another auto flow is running");
+        return FINGERPRINT_OPERATION_BLOCKED;
+    }
+    _startTime    = millis();
+    _lastActivity = _startTime;
+    _result       = FINGERPRINT_OK;
+    _lastStatus   = FINGERPRINT_OK;
+    _packetCount  = 0;
+    _finishing    = false;
+    _stageHead    = 0;
+    _stageCount   = 0;
+    _state.store(FINGERPRINT_SESSION_RUNNING, std::memory_order_release);
+
+    _device._autoFlowCommand = _command;
+    _device._cancelState     = M5UnitFingerprint2::CANCEL_IDLE;
+    _device._autoSession.store(this);
+    _device.releaseMutex();
+
+    uint8_t frame[Fingerprint_CommandFrame::size(FINGERPRINT_ASYNC_PAYLOAD_SIZE)];
+    size_t frameLength = Fingerprint_CommandFrame::encode(frame, _device._fp2_address, _command, params, length);
+    if (!_device.sendCommandFrame(frame, frameLength)) {
+        serialPrintf("Auto flow session: failed to send command 0x%02X\r\n", _command);
+        _result = FINGERPRINT_PACKET_TIMEOUT;
+        complete();
+        return FINGERPRINT_PACKET_TIMEOUT;
+    }
+    return FINGERPRINT_OK;
+}
+
+fingerprint_session_state_t Fingerprint_AutoFlowSession::poll()
+{
+    // 没有解析任务时（原生平台、内联模式）在此读取并解析已到达的数据 / Without a parse task (native platforms, inline mode) read and parse arrived data here
+    if (_device.parsesInline()) {
+        _device.receiveSerialData();
+        _device.checkAndParsePackets();
+    }
+
+    if (state() == FINGERPRINT_SESSION_RUNNING && tryLockDispatch()) {
+        dispatch();
+        unlockDispatch();
+    }
+    return state();
+}
+
+bool Fingerprint_AutoFlowSession::cancel()
+{
+    if (state() != FINGERPRINT_SESSION_RUNNING || _finishing) {
+        return false;
+    }
+    return _device.injectCancel();
+}
+
+uint32_t Fingerprint_AutoFlowSession::nextDeadline() const
+{
+    if (state() != FINGERPRINT_SESSION_RUNNING) {
+        return UINT32_MAX;
+    }
+    unsigned long now = millis();
+    if (_finishing) {
+        return remainingMs(now, _finishTime, 1000);
+    }
+    uint32_t total = remainingMs(now, _startTime, _totalTimeout);
+    uint32_t idle  = remainingMs(now, _lastActivity, FINGERPRINT_AUTO_FLOW_IDLE_TIMEOUT_MS);
+    return (idle < total) ? idle : total;
+}
+
+void Fingerprint_AutoFlowSession::finish(fingerprint_status_t result)
+{
+    if (state() != FINGERPRINT_SESSION_RUNNING || _finishing) {
+        return;
+    }
+    _result = result;
+
+    // 取消命令的应答尚未到达时保持注册，以免它被当作下一条命令的应答 / Stay registered while the cancel reply is outstanding so it is not taken as the reply to the next command
+    _device.acquireMutex();
+    if (_device._cancelState == M5UnitFingerprint2::CANCEL_PENDING) {
+        _finishing  = true;
+        _finishTime = millis();
+    } else {
+        detach();
+        markDone();
+    }
+    _device.releaseMutex();
+}
+
+void Fingerprint_AutoFlowSession::abort()
+{
+    if (state() != FINGERPRINT_SESSION_RUNNING || _finishing) {
+        return;
+    }
+    serialPrintf("Auto flow session 0x%02X: aborted by callback function\r\n", _command);
+    _device.injectCancel();
+    finish(FINGERPRINT_OPERATION_BLOCKED);
+}
+
+void Fingerprint_AutoFlowSession::complete()
+{
+    _device.acquireMutex();
+    if (_device._autoSession.load() == this) {
+        detach();
+    }
+    _finishing = false;
+    markDone();
+    _device.releaseMutex();
+}
+
+void Fingerprint_AutoFlowSession::markDone()
+{
+    _state.store(FINGERPRINT_SESSION_DONE, std::memory_order_release);
+}
+
+void Fingerprint_AutoFlowSession::detach()
+{
+    // 放弃等待取消应答，PS_Cancel 的调用者不会一直等待 / Give up on the cancel reply so a PS_Cancel caller does not wait forever
+    if (_device._cancelState == M5UnitFingerprint2::CANCEL_PENDING) {
+        _device.finishCancelLocked(FINGERPRINT_PACKET_TIMEOUT);
+    }
+    _device._autoSession.store(nullptr);
+    _device._autoFlowCommand = 0;
+}
+
+bool Fingerprint_AutoFlowSession::onFrame(const uint8_t* frame, size_t length)
+{
+    if (frame[6] != FINGERPRINT_PACKET_ACKPACKET || length <= FINGERPRINT_PACKET_HEADER_SIZE + 2) {
+        return false;
+    }
+    const uint8_t* payload = frame + FINGERPRINT_PACKET_HEADER_SIZE;
+    size_t payloadLength   = length - FINGERPRINT_PACKET_HEADER_SIZE - 2;
+
+    // 缓存已满时丢弃最早的阶段包，保留最新状态 / When the buffer is full the oldest stage packet is dropped, keeping the latest state
+    if (_stageCount == FINGERPRINT_SESSION_EVENT_DEPTH) {
+        _stageHead = (_stageHead + 1) % FINGERPRINT_SESSION_EVENT_DEPTH;
+        _stageCount--;
+    }
+    Stage& stage = _stages[(_stageHead + _stageCount) % FINGERPRINT_SESSION_EVENT_DEPTH];
+    _stageCount++;
+
+    stage.status      = static_cast<fingerprint_status_t>(payload[0]);
+    stage.length      = static_cast<uint8_t>((payloadLength - 1 < sizeof(stage.data)) ? payloadLength - 1 : sizeof(stage.data));
+    stage.cancelReply = false;
+    memcpy(stage.data, payload + 1, stage.length);
+
+    // 取消命令的应答只有确认码，自动流程的应答都带参数 / The cancel reply carries only the confirmation code, whereas auto flow replies carry parameters
+    if (payloadLength == 1 && _device._cancelState == M5UnitFingerprint2::CANCEL_PENDING) {
+        _device.finishCancelLocked(stage.status);
+        stage.cancelReply = true;
+    }
+
+    _lastActivity = millis();
+    return true;
+}
+
+void Fingerprint_AutoFlowSession::dispatch()
+{
+    while (state() == FINGERPRINT_SESSION_RUNNING) {
+        _device.acquireMutex();
+        if (_stageCount == 0) {
+            _device.releaseMutex();
+            break;
+        }
+        Stage stage = _stages[_stageHead];
+        _stageHead  = (_stageHead + 1) % FINGERPRINT_SESSION_EVENT_DEPTH;
+        _stageCount--;
+        _device.releaseMutex();
+
+        // 取消生效：流程尚未结束时以 FINGERPRINT_OPERATION_BLOCKED 结束 / The cancel took effect: a flow not yet over finishes with FINGERPRINT_OPERATION_BLOCKED
+        if (stage.cancelReply) {
+            serialPrintf("Auto flow session 0x%02X: cancelled\r\n", _command);
+            if (!_finishing) {
+                _result = FINGERPRINT_OPERATION_BLOCKED;
+            }
+            complete();
+            break;
+        }
+
+        // 等待取消应答期间不再上报阶段 / Stages are no longer reported while waiting for the cancel reply
+        if (_finishing) {
+            continue;
+        }
+
+        _packetCount++;
+        _lastStatus = stage.status;
+        serialPrintf("Auto flow session 0x%02X packet #%d: Status=0x%02X\r\n", _command, _packetCount, stage.status);
+        onStage(stage);
+    }
+
+    if (state() != FINGERPRINT_SESSION_RUNNING) {
+        return;
+    }
+
+    // 超时规则与阻塞版本相同 / Same timeout rules as the blocking versions
+    unsigned long now = millis();
+    if (_finishing) {
+        if (now - _finishTime >= 1000) {
+            complete();
+        }
+    } else if (now - _startTime >= _totalTimeout) {
+        serialPrintf("Auto flow session 0x%02X: process timeout\r\n", _command);
+        finish(FINGERPRINT_TIMEOUT);
+    } else if (now - _lastActivity >= FINGERPRINT_AUTO_FLOW_IDLE_TIMEOUT_MS) {
+        // 第一个包都没有收到视为通信错误，否则流程已结束 / No packet at all is a communication error, otherwise the flow has ended
+        finish((_packetCount == 0) ? FINGERPRINT_PACKET_TIMEOUT : _lastStatus);
+    }
+}
+
+// 在锁内选中会话并标记为分发中，会话在分发结束前不会被销毁 / Pick the session and mark it dispatching under the lock, so it is not destroyed before the dispatch ends
+uint32_t M5UnitFingerprint2::dispatchSession()
+{
+    if (_autoSession.load(std::memory_order_relaxed) == nullptr) {
+        return UINT32_MAX;
+    }
+
+    acquireMutex();
+    Fingerprint_AutoFlowSession* session = _autoSession.load();
+    bool taken = (session != nullptr) && session->tryLockDispatch();
+    releaseMutex();
+    if (!taken) {
+        // 由 poll() 的调用者分发中，稍后再检查超时 / Being dispatched by a poll() caller; check the timeouts again shortly
+        return (session != nullptr) ? 1 : UINT32_MAX;
+    }
+
+    session->dispatch();
+    uint32_t wait = session->nextDeadline();
+    session->unlockDispatch();
+    return wait;
+}
+
+Fingerprint_AutoEnrollSession::Fingerprint_AutoEnrollSession(M5UnitFingerprint2& device)
+    : Fingerprint_AutoFlowSession(device, FINGERPRINT_AUTO_ENROLL, 60000)
+{
+}
+
+fingerprint_status_t Fingerprint_AutoEnrollSession::begin(uint16_t ID, uint8_t enrollCount,
+                                                          fingerprint_auto_enroll_flags_t flags,
+                                                          PS_AutoEnrollCallback_t callback)
+{
+    // 参数检查与 PS_AutoEnroll 相同 / Same parameter checks as PS_AutoEnroll
+    if (enrollCount == 0 || enrollCount > 6) {
+        serialPrintln("Invalid enroll count for auto enroll session (1-6)");
+        return FINGERPRINT_PARAM_ERROR;
+    }
+    if (ID > 99) {
+        serialPrintf("Invalid ID for auto enroll session: %d (valid range: 0-99)\r\n", ID);
+        return FINGERPRINT_PARAM_ERROR;
+    }
+    if (state() == FINGERPRINT_SESSION_RUNNING) {
+        return FINGERPRINT_OPERATION_BLOCKED;
+    }
+
+    _id       = ID;
+    _flags    = flags;
+    _callback = callback;
+    _param1   = 0;
+    _param2   = 0;
+
+    uint8_t params[5];
+    params[0] = (ID >> 8) & 0xFF;
+    params[1] = ID & 0xFF;
+    params[2] = enrollCount;
+    params[3] = (static_cast<uint16_t>(flags) >> 8) & 0xFF;
+    params[4] = static_cast<uint16_t>(flags) & 0xFF;
+    return start(params, 5);
+}
+
+void Fingerprint_AutoEnrollSession::onStage(const Stage& stage)
+{
+    _param1 = (stage.length >= 1) ? stage.data[0] : 0;
+    _param2 = (stage.length >= 2) ? stage.data[1] : 0;
+
+    if (_callback != nullptr && !_callback(_id, stage.status, _param1, _param2, packetCount())) {
+        abort();
+        return;
+    }
+
+    // 存储模板阶段为最后一步；不返回状态时只会收到最终结果 / Storing the template is the last stage; without status return only the final result arrives
+    if (_param1 == PS_AUTO_ENROLL_PARAM1_STORE) {
+        finish(stage.status);
+    } else if ((_flags & FINGERPRINT_AUTO_ENROLL_NO_STATUS_RETURN) && stage.status == FINGERPRINT_OK) {
+        finish(FINGERPRINT_OK);
+    }
+}
+
+Fingerprint_AutoIdentifySession::Fingerprint_AutoIdentifySession(M5UnitFingerprint2& device)
+    : Fingerprint_AutoFlowSession(device, FINGERPRINT_AUTO_IDENTIFY, 30000)
+{
+}
+
+fingerprint_status_t Fingerprint_AutoIdentifySession::begin(uint8_t securityLevel, uint16_t ID,
+                                                            fingerprint_auto_verify_flags_t flags,
+                                                            PS_AutoIdentifyCallback_t callback)
+{
+    // 参数检查与 PS_AutoIdentify 相同 / Same parameter checks as PS_AutoIdentify
+    if (securityLevel != 0 && securityLevel != 1) {
+        serialPrintf("Invalid security level for auto identify session: %d (valid: 0-1)\r\n", securityLevel);
+        return FINGERPRINT_PARAM_ERROR;
+    }
+    if (state() == FINGERPRINT_SESSION_RUNNING) {
+        return FINGERPRINT_OPERATION_BLOCKED;
+    }
+
+    _securityLevel = securityLevel;
+    _flags         = flags;
+    _callback      = callback;
+    _param         = 0;
+    _pageID        = 0;
+    _score         = 0;
+
+    uint8_t params[5];
+    params[0] = securityLevel;
+    params[1] = (ID >> 8) & 0xFF;
+    params[2] = ID & 0xFF;
+    params[3] = (static_cast<uint16_t>(flags) >> 8) & 0xFF;
+    params[4] = static_cast<uint16_t>(flags) & 0xFF;
+    return start(params, 5);
+}
+
+void Fingerprint_AutoIdentifySession::onStage(const Stage& stage)
+{
+    _param          = (stage.length >= 1) ? stage.data[0] : 0;
+    uint16_t recvID = (stage.length >= 3) ? static_cast<uint16_t>((stage.data[1] << 8) | stage.data[2]) : 0;
+    _score          = (stage.length >= 5) ? static_cast<uint16_t>((stage.data[3] << 8) | stage.data[4]) : 0;
+
+    if (_callback != nullptr && !_callback(_securityLevel, stage.status, _param, recvID, _score, packetCount())) {
+        abort();
+        return;
+    }
+
+    // 比对阶段为最后一步，成功时带匹配的页码 ID / Matching is the last stage and carries the matched page ID on success
+    if (_param == PS_AUTO_IDENTIFY_PARAM_VERIFY) {
+        _pageID = (stage.status == FINGERPRINT_OK) ? recvID : 0;
+        finish(stage.status);
+    } else if ((_flags & FINGERPRINT_AUTO_VERIFY_NO_STATUS_RETURN) && stage.status == FINGERPRINT_OK) {
+        _pageID = recvID;
+        finish(FINGERPRINT_OK);
+    }
+}
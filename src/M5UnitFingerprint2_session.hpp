@@ -0,0 +1,233 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_SESSION_H
+#define __M5_UNIT_FINGERPRINT2_SESSION_H
+
+// 非阻塞自动流程会话：PS_AutoEnroll/PS_AutoIdentify 的状态机版本，须显式包含本头文件。
+// Non-blocking auto flow sessions: state machine versions of PS_AutoEnroll/PS_AutoIdentify; include this header
+// explicitly.
+
+#include <atomic>
+
+#include "M5UnitFingerprint2.hpp"
+
+/**
+ * @brief 自动流程会话基类 / Auto flow session base class
+ *
+ * 会话注册到模组实例后，解析器把每个阶段包直接放入会话，不经过解析队列；阶段事件在锁外分发，由解析任务中的
+ * processCommands()（原生平台由调用者）或 poll() 完成，先到者处理。整个过程没有休眠，阶段变化在包到达后
+ * 立即上报，一个任务可以同时推进多个模组上的会话。每个模组实例同一时间只能运行一个自动流程。
+ *
+ * Once registered with a module instance, the parser places each stage packet straight into the session, bypassing
+ * the parse queue. Stage events are dispatched outside the lock by processCommands() in the parse task (its caller
+ * on native platforms) or by poll(), whichever comes first. Nothing sleeps, so a stage change is reported as soon as
+ * its packet arrives, and one task can advance sessions on several modules at once. Each module instance runs at
+ * most one auto flow at a time.
+ */
+class Fingerprint_AutoFlowSession {
+public:
+    virtual ~Fingerprint_AutoFlowSession();
+
+    Fingerprint_AutoFlowSession(const Fingerprint_AutoFlowSession&)            = delete;
+    Fingerprint_AutoFlowSession& operator=(const Fingerprint_AutoFlowSession&) = delete;
+
+    /**
+     * @brief 推进会话：分发已到达的阶段包并检查超时，不阻塞 / Advance the session: dispatch arrived stage packets and check timeouts, without blocking
+     *
+     * 原生平台上同时读取并解析已到达的数据。回调在调用 poll() 的任务中执行（ESP 平台也可能在解析任务中执行）。
+     * On native platforms it also reads and parses arrived data. Callbacks run in the task calling poll() (on ESP
+     * platforms possibly in the parse task instead).
+     *
+     * @return 会话状态 / Session state
+     */
+    fingerprint_session_state_t poll();
+
+    /**
+     * @brief 立即发送取消命令，不等待应答 / Send the cancel command at once, without waiting for its reply
+     *
+     * 会话随后以 FINGERPRINT_OPERATION_BLOCKED 结束（模组在取消前已完成流程时为流程结果）。
+     * The session then finishes with FINGERPRINT_OPERATION_BLOCKED (or the flow result if the module completed the
+     * flow before the cancel).
+     *
+     * @return 会话进行中且取消命令已发出返回 true / true if the session was running and the cancel command was sent
+     */
+    bool cancel();
+
+    fingerprint_session_state_t state() const { return _state.load(std::memory_order_acquire); }
+    bool done() const { return state() == FINGERPRINT_SESSION_DONE; }
+
+    // 最终结果，含义与阻塞版本的返回值相同；done() 之前为 FINGERPRINT_OK / Final result, same meaning as the blocking version's return value; FINGERPRINT_OK before done()
+    fingerprint_status_t result() const { return done() ? _result : FINGERPRINT_OK; }
+
+    // 已收到的阶段包数量 / Stage packets received
+    int packetCount() const { return _packetCount; }
+
+    // 最近一个阶段包的确认码 / Confirmation code of the latest stage packet
+    fingerprint_status_t lastStatus() const { return _lastStatus; }
+
+    /**
+     * @brief 距下一次超时检查的时间，可用作调用者的最长休眠时间 / Time until the next timeout check, usable as the caller's longest sleep
+     * @return 毫秒，会话未运行时为 UINT32_MAX / Milliseconds, UINT32_MAX while not running
+     */
+    uint32_t nextDeadline() const;
+
+protected:
+    // 阶段包：确认码及其后的参数 / Stage packet: confirmation code and the parameters that follow it
+    struct Stage {
+        fingerprint_status_t status = FINGERPRINT_OK;
+        uint8_t length              = 0;  // 参数字节数 / Parameter bytes
+        uint8_t data[5];                  // 注册：参数1、参数2；比对：参数、ID、分数 / Enroll: param1, param2; identify: param, ID, score
+        bool cancelReply            = false;  // 注入的取消命令的应答 / Reply to an injected cancel command
+    };
+
+    Fingerprint_AutoFlowSession(M5UnitFingerprint2& device, uint8_t command, uint32_t totalTimeout_ms);
+
+    /**
+     * @brief 注册会话并发送自动流程命令 / Register the session and send the auto flow command
+     * @return 成功返回 FINGERPRINT_OK；模组已有自动流程在运行返回 FINGERPRINT_OPERATION_BLOCKED；参数超过
+     *         FINGERPRINT_ASYNC_PAYLOAD_SIZE 返回 FINGERPRINT_PARAM_ERROR；发送失败返回 FINGERPRINT_PACKET_TIMEOUT
+     *         FINGERPRINT_OK on success; FINGERPRINT_OPERATION_BLOCKED if the module already runs an auto flow;
+     *         FINGERPRINT_PARAM_ERROR if the parameters exceed FINGERPRINT_ASYNC_PAYLOAD_SIZE;
+     *         FINGERPRINT_PACKET_TIMEOUT if sending failed
+     */
+    fingerprint_status_t start(const uint8_t* params, uint16_t length);
+
+    /**
+     * @brief 处理一个阶段包，在锁外调用 / Handle one stage packet, called outside the lock
+     *
+     * 流程结束时调用 finish()，回调要求中止时调用 abort()。
+     * Calls finish() when the flow is over and abort() when the callback asks to stop.
+     */
+    virtual void onStage(const Stage& stage) = 0;
+
+    // 以指定结果结束会话；取消命令的应答未到时等待其到达 / Finish the session with the given result; waits for the cancel reply if it is still outstanding
+    void finish(fingerprint_status_t result);
+
+    // 发送取消命令并以 FINGERPRINT_OPERATION_BLOCKED 结束 / Send the cancel command and finish with FINGERPRINT_OPERATION_BLOCKED
+    void abort();
+
+    M5UnitFingerprint2& _device;
+
+private:
+    friend class M5UnitFingerprint2;
+
+    // 解析器在持锁时调用：接收阶段包 / Called by the parser with the mutex held: accept a stage packet
+    bool onFrame(const uint8_t* frame, size_t length);
+
+    // 分发已缓存的阶段包并检查超时，在锁外调用 / Dispatch buffered stage packets and check timeouts, called outside the lock
+    void dispatch();
+
+    // 从模组实例注销，持锁调用 / Unregister from the module instance, called with the mutex held
+    void detach();
+
+    // 结束会话并注销 / End the session and unregister it
+    void complete();
+
+    // 先写 _result，再以 release 发布 DONE / Write _result first, then publish DONE with release
+    void markDone();
+
+    // 分发锁：解析任务与 poll() 只尝试获取，析构时等待其释放 / Dispatch lock: the parse task and poll() only try it, the destructor waits for it
+    bool tryLockDispatch();
+    void unlockDispatch();
+
+    uint8_t _command;
+    uint32_t _totalTimeout;
+    unsigned long _startTime             = 0;
+    volatile unsigned long _lastActivity = 0;  // 最近一次收到阶段包的时间 / Time of the latest stage packet
+    unsigned long _finishTime            = 0;  // 开始等待取消应答的时间 / Time waiting for the cancel reply began
+
+    std::atomic<fingerprint_session_state_t> _state{FINGERPRINT_SESSION_IDLE};
+    fingerprint_status_t _result     = FINGERPRINT_OK;  // 由 _state 的 DONE 发布 / Published by _state becoming DONE
+    fingerprint_status_t _lastStatus = FINGERPRINT_OK;
+    int _packetCount                 = 0;
+    bool _finishing                  = false;  // 已有结果，等待取消应答 / Result known, waiting for the cancel reply
+
+    // 尚未分发的阶段包，持锁访问 / Stage packets not yet dispatched, accessed with the mutex held
+    Stage _stages[FINGERPRINT_SESSION_EVENT_DEPTH];
+    uint8_t _stageHead  = 0;
+    uint8_t _stageCount = 0;
+
+    // 正在分发时持有，防止解析任务与 poll() 同时分发 / Held while dispatching; keeps the parse task and poll() from dispatching at once
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    SemaphoreHandle_t _dispatchLock = nullptr;
+#else
+    std::mutex _dispatchLock;
+#endif
+};
+
+/**
+ * @brief 非阻塞自动注册会话 / Non-blocking auto enrollment session
+ *
+ * 与 PS_AutoEnroll 发送相同的命令，阶段包（ps_auto_enroll_param1_t）到达时立即回调。
+ * Sends the same command as PS_AutoEnroll and calls back as soon as each stage packet (ps_auto_enroll_param1_t)
+ * arrives.
+ */
+class Fingerprint_AutoEnrollSession : public Fingerprint_AutoFlowSession {
+public:
+    explicit Fingerprint_AutoEnrollSession(M5UnitFingerprint2& device);
+
+    /**
+     * @brief 开始自动注册，参数与 PS_AutoEnroll 相同 / Start auto enrollment, same parameters as PS_AutoEnroll
+     * @return 成功返回 FINGERPRINT_OK；参数错误返回 FINGERPRINT_PARAM_ERROR；模组正在运行其它自动流程返回
+     *         FINGERPRINT_OPERATION_BLOCKED；发送失败返回 FINGERPRINT_PACKET_TIMEOUT
+     *         FINGERPRINT_OK on success; FINGERPRINT_PARAM_ERROR for invalid parameters; FINGERPRINT_OPERATION_BLOCKED
+     *         if the module is running another auto flow; FINGERPRINT_PACKET_TIMEOUT if sending failed
+     */
+    fingerprint_status_t begin(uint16_t ID, uint8_t enrollCount, fingerprint_auto_enroll_flags_t flags,
+                               PS_AutoEnrollCallback_t callback = nullptr);
+
+    uint16_t id() const { return _id; }
+    uint8_t param1() const { return _param1; }  // 最近的阶段码 / Latest stage code
+    uint8_t param2() const { return _param2; }  // 最近的状态码 / Latest status code
+
+protected:
+    void onStage(const Stage& stage) override;
+
+private:
+    uint16_t _id                              = 0;
+    fingerprint_auto_enroll_flags_t _flags    = FINGERPRINT_AUTO_ENROLL_DEFAULT;
+    PS_AutoEnrollCallback_t _callback         = nullptr;
+    uint8_t _param1                           = 0;
+    uint8_t _param2                           = 0;
+};
+
+/**
+ * @brief 非阻塞自动比对会话 / Non-blocking auto identification session
+ *
+ * 与 PS_AutoIdentify 发送相同的命令，阶段包（ps_auto_identify_param_t）到达时立即回调。
+ * Sends the same command as PS_AutoIdentify and calls back as soon as each stage packet (ps_auto_identify_param_t)
+ * arrives.
+ */
+class Fingerprint_AutoIdentifySession : public Fingerprint_AutoFlowSession {
+public:
+    explicit Fingerprint_AutoIdentifySession(M5UnitFingerprint2& device);
+
+    /**
+     * @brief 开始自动比对，参数与 PS_AutoIdentify 相同 / Start auto identification, same parameters as PS_AutoIdentify
+     * @return 同 Fingerprint_AutoEnrollSession::begin() / Same as Fingerprint_AutoEnrollSession::begin()
+     */
+    fingerprint_status_t begin(uint8_t securityLevel, uint16_t ID, fingerprint_auto_verify_flags_t flags,
+                               PS_AutoIdentifyCallback_t callback = nullptr);
+
+    // 匹配的页码 ID，比对成功时有效 / Matched page ID, valid when identification succeeded
+    uint16_t pageID() const { return _pageID; }
+    uint16_t score() const { return _score; }   // 最近的匹配分数 / Latest match score
+    uint8_t param() const { return _param; }    // 最近的阶段参数 / Latest stage parameter
+
+protected:
+    void onStage(const Stage& stage) override;
+
+private:
+    uint8_t _securityLevel                    = 0;
+    fingerprint_auto_verify_flags_t _flags    = FINGERPRINT_AUTO_VERIFY_DEFAULT;
+    PS_AutoIdentifyCallback_t _callback       = nullptr;
+    uint8_t _param                            = 0;
+    uint16_t _pageID                          = 0;
+    uint16_t _score                           = 0;
+};
+
+#endif  // __M5_UNIT_FINGERPRINT2_SESSION_H
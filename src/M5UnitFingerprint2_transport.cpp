@@ -0,0 +1,360 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "M5UnitFingerprint2_transport.hpp"
+
+#if defined(ARDUINO)
+// 打开并配置串口 / Open and configure the serial port
+bool Fingerprint_ArduinoTransport::begin()
+{
+    if (_serialPort == nullptr) {
+        serialPrintln("No serial port configured.");
+        return false;
+    }
+
+    // 检查串口是否已经初始化且波特率为115200 / Check if serial port is already initialized at 115200 baud rate
+    bool needsInitialization = true;
+
+    // 尝试检查当前波特率（ESP32平台支持） / Try to check current baud rate (supported on ESP32 platform)
+#if defined(ESP32)
+    // ESP32可以检查串口状态 / ESP32 can check serial port status
+    if (_serialPort->baudRate() == 115200) {
+        needsInitialization = false;
+        serialPrintln("Serial port already initialized at 115200 baud rate, skipping initialization.");
+    }
+#endif
+
+    if (needsInitialization) {
+        // 配置UART引脚（如果提供了有效的引脚号） / Configure UART pins (if valid pin numbers are provided)
+        if (_txPin != -1 && _rxPin != -1) {
+            _serialPort->begin(115200, SERIAL_8N1, _rxPin, _txPin);  // 设置波特率和引脚 / Set baud rate and pins
+            serialPrintf("Arduino serial port initialized with TX pin %d, RX pin %d, baud rate 115200.\r\n", _txPin,
+                         _rxPin);
+        } else {
+            _serialPort->begin(115200);  // 使用默认引脚设置波特率为115200 / Use default pins, set baud rate to 115200
+            serialPrintln("Arduino serial port initialized with default pins, baud rate 115200.");
+        }
+    } else {
+        // 串口已初始化，但仍需要检查引脚配置 / Serial port already initialized, but still need to check pin configuration
+        if (_txPin != -1 && _rxPin != -1) {
+            // 如果需要特定引脚，重新配置 / If specific pins are needed, reconfigure
+            _serialPort->end();                                      // 先关闭当前配置 / First close current configuration
+            _serialPort->begin(115200, SERIAL_8N1, _rxPin, _txPin);  // 重新设置引脚 / Reset pins
+            serialPrintf("Serial port reconfigured with TX pin %d, RX pin %d.\r\n", _txPin, _rxPin);
+        } else {
+            serialPrintln("Serial port already configured, using existing pin configuration.");
+        }
+    }
+
+    _serialPort->setTimeout(1000);
+    return true;
+}
+
+size_t Fingerprint_ArduinoTransport::available()
+{
+    if (_serialPort == nullptr) {
+        return 0;
+    }
+    int available = _serialPort->available();
+    return (available > 0) ? static_cast<size_t>(available) : 0;
+}
+
+// 按可用字节数一次性块读取，避免逐字节调用驱动 / Read everything available in one block call instead of one driver call per byte
+size_t Fingerprint_ArduinoTransport::read(uint8_t* buffer, size_t length)
+{
+    size_t avail = available();
+    if (avail == 0) {
+        return 0;
+    }
+    size_t toRead = (avail < length) ? avail : length;
+    return _serialPort->readBytes(buffer, toRead);
+}
+
+size_t Fingerprint_ArduinoTransport::write(const uint8_t* buffer, size_t length)
+{
+    if (_serialPort == nullptr) {
+        return 0;
+    }
+    return _serialPort->write(buffer, length);
+}
+
+bool Fingerprint_ArduinoTransport::waitReadable(uint32_t timeout_ms)
+{
+    unsigned long startTime = millis();
+    while (available() == 0) {
+        if (millis() - startTime >= timeout_ms) {
+            return false;
+        }
+        delay(1);
+    }
+    return true;
+}
+
+// 通过 onReceive（RX FIFO 阈值/接收超时）通知数据到达 / Signal data arrival through onReceive (RX FIFO threshold / RX timeout)
+bool Fingerprint_ArduinoTransport::setReceiveCallback(Fingerprint_ReceiveCallback_t callback, void* context)
+{
+#if FINGERPRINT_EVENT_DRIVEN_RX
+    if (_serialPort == nullptr) {
+        return false;
+    }
+    if (callback == nullptr) {
+        _serialPort->onReceive(NULL);
+    } else {
+        _serialPort->onReceive([callback, context]() { callback(context); }, false);
+    }
+    return true;
+#else
+    (void)callback;
+    (void)context;
+    return false;
+#endif
+}
+#endif
+
+#if defined(__linux__) && !defined(ARDUINO)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+Fingerprint_FdTransport::Fingerprint_FdTransport(int fd, bool ownsFd) : _fd(-1), _ownsFd(false)
+{
+    adopt(fd, ownsFd);
+}
+
+Fingerprint_FdTransport::~Fingerprint_FdTransport()
+{
+    end();
+}
+
+// 接管文件描述符并设为非阻塞 / Take over a file descriptor and make it non-blocking
+void Fingerprint_FdTransport::adopt(int fd, bool ownsFd)
+{
+    end();
+    _fd     = fd;
+    _ownsFd = ownsFd;
+    if (_fd >= 0) {
+        int flags = fcntl(_fd, F_GETFL, 0);
+        if (flags >= 0) {
+            fcntl(_fd, F_SETFL, flags | O_NONBLOCK);
+        }
+    }
+}
+
+bool Fingerprint_FdTransport::begin()
+{
+    return _fd >= 0;
+}
+
+void Fingerprint_FdTransport::end()
+{
+    if (_fd >= 0 && _ownsFd) {
+        close(_fd);
+    }
+    _fd = -1;
+}
+
+size_t Fingerprint_FdTransport::available()
+{
+    int count = 0;
+    if (_fd < 0 || ioctl(_fd, FIONREAD, &count) < 0 || count < 0) {
+        return 0;
+    }
+    return static_cast<size_t>(count);
+}
+
+size_t Fingerprint_FdTransport::read(uint8_t* buffer, size_t length)
+{
+    if (_fd < 0 || buffer == nullptr || length == 0) {
+        return 0;
+    }
+    ssize_t n;
+    do {
+        n = ::read(_fd, buffer, length);
+    } while (n < 0 && errno == EINTR);
+    return (n > 0) ? static_cast<size_t>(n) : 0;
+}
+
+// 写满全部数据，发送缓冲区满时等待可写 / Write everything, waiting for writability when the send buffer is full
+size_t Fingerprint_FdTransport::write(const uint8_t* buffer, size_t length)
+{
+    if (_fd < 0 || buffer == nullptr) {
+        return 0;
+    }
+    size_t written = 0;
+    while (written < length) {
+        ssize_t n = ::write(_fd, buffer + written, length - written);
+        if (n > 0) {
+            written += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd = {_fd, POLLOUT, 0};
+            if (poll(&pfd, 1, 1000) <= 0) {
+                break;
+            }
+        } else {
+            break;
+        }
+    }
+    return written;
+}
+
+bool Fingerprint_FdTransport::waitReadable(uint32_t timeout_ms)
+{
+    if (_fd < 0) {
+        return false;
+    }
+    struct pollfd pfd = {_fd, POLLIN, 0};
+    int ret;
+    do {
+        ret = poll(&pfd, 1, static_cast<int>(timeout_ms));
+    } while (ret < 0 && errno == EINTR);
+    return ret > 0 && (pfd.revents & POLLIN);
+}
+
+bool Fingerprint_FdTransport::createSocketPair(Fingerprint_FdTransport& a, Fingerprint_FdTransport& b)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+        return false;
+    }
+    a.adopt(fds[0], true);
+    b.adopt(fds[1], true);
+    return true;
+}
+
+// 将标准波特率转换为 termios 速率常量，不支持的波特率返回 B0 / Convert standard baud rates to termios speed constants, B0 for unsupported rates
+static speed_t toTermiosSpeed(uint32_t baudRate)
+{
+    switch (baudRate) {
+        case 1200:
+            return B1200;
+        case 2400:
+            return B2400;
+        case 4800:
+            return B4800;
+        case 9600:
+            return B9600;
+        case 19200:
+            return B19200;
+        case 38400:
+            return B38400;
+        case 57600:
+            return B57600;
+        case 115200:
+            return B115200;
+        case 230400:
+            return B230400;
+        case 460800:
+            return B460800;
+#if defined(B500000)
+        case 500000:
+            return B500000;
+#endif
+#if defined(B576000)
+        case 576000:
+            return B576000;
+#endif
+        case 921600:
+            return B921600;
+#if defined(B1000000)
+        case 1000000:
+            return B1000000;
+#endif
+#if defined(B1500000)
+        case 1500000:
+            return B1500000;
+#endif
+#if defined(B2000000)
+        case 2000000:
+            return B2000000;
+#endif
+        default:
+            return B0;
+    }
+}
+
+// 配置原始模式 8N1、无流控 / Configure raw mode, 8N1, no flow control
+static bool configureRaw(int fd, uint32_t baudRate)
+{
+    struct termios tio;
+    if (tcgetattr(fd, &tio) < 0) {
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+    tio.c_cc[VMIN]  = 0;
+    tio.c_cc[VTIME] = 0;
+    if (baudRate != 0) {
+        speed_t speed = toTermiosSpeed(baudRate);
+        if (speed == B0) {
+            serialPrintf("Unsupported baud rate %u\r\n", (unsigned)baudRate);
+            return false;
+        }
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+    }
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        return false;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return true;
+}
+
+Fingerprint_TermiosTransport::Fingerprint_TermiosTransport(const char* device, uint32_t baudRate)
+    : _device(device), _baudRate(baudRate)
+{
+}
+
+bool Fingerprint_TermiosTransport::begin()
+{
+    if (_fd >= 0) {
+        return true;
+    }
+    int fd = open(_device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        serialPrintf("Failed to open %s\r\n", _device);
+        return false;
+    }
+    if (!configureRaw(fd, _baudRate)) {
+        close(fd);
+        serialPrintf("Failed to configure %s\r\n", _device);
+        return false;
+    }
+    adopt(fd, true);
+    return true;
+}
+
+Fingerprint_PtyTransport::Fingerprint_PtyTransport()
+{
+    _slaveName[0] = '\0';
+}
+
+bool Fingerprint_PtyTransport::begin()
+{
+    if (_fd >= 0) {
+        return true;
+    }
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        return false;
+    }
+    if (grantpt(fd) < 0 || unlockpt(fd) < 0 || ptsname_r(fd, _slaveName, sizeof(_slaveName)) != 0 ||
+        !configureRaw(fd, 0)) {
+        close(fd);
+        _slaveName[0] = '\0';
+        return false;
+    }
+    adopt(fd, true);
+    return true;
+}
+#endif
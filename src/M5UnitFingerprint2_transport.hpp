@@ -0,0 +1,190 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_TRANSPORT_H
+#define __M5_UNIT_FINGERPRINT2_TRANSPORT_H
+
+#include "M5UnitFingerprint2_defs.hpp"
+
+// 数据到达回调函数类型定义 / Data arrival callback function type definition
+// 参数： / Parameters:
+//   context: 注册回调时传入的上下文指针 / Context pointer passed when registering the callback
+typedef void (*Fingerprint_ReceiveCallback_t)(void* context);
+
+/**
+ * @brief 串行传输接口 / Serial transport interface
+ *
+ * 协议引擎只通过该接口收发字节，不依赖具体的串口实现。read() 不阻塞，只返回当前已到达的数据；
+ * waitReadable() 在数据到达或超时前阻塞。支持数据到达通知的后端可以实现 setReceiveCallback()，
+ * 否则引擎通过 waitReadable() 等待。
+ *
+ * The protocol engine only moves bytes through this interface and does not depend on a particular serial
+ * implementation. read() never blocks and only returns data that has already arrived; waitReadable() blocks until
+ * data arrives or the timeout passes. Backends that can signal data arrival implement setReceiveCallback(),
+ * otherwise the engine waits with waitReadable().
+ */
+class Fingerprint_Transport {
+public:
+    virtual ~Fingerprint_Transport() {}
+
+    /**
+     * @brief 打开并配置传输 / Open and configure the transport
+     * @return 成功返回 true / true on success
+     */
+    virtual bool begin() { return true; }
+
+    // 关闭传输 / Close the transport
+    virtual void end() {}
+
+    // 当前可读字节数 / Bytes currently readable
+    virtual size_t available() = 0;
+
+    /**
+     * @brief 读取已到达的数据，不阻塞 / Read data that has already arrived, without blocking
+     * @return 实际读取字节数 / Bytes actually read
+     */
+    virtual size_t read(uint8_t* buffer, size_t length) = 0;
+
+    /**
+     * @brief 写入数据 / Write data
+     * @return 实际写入字节数 / Bytes actually written
+     */
+    virtual size_t write(const uint8_t* buffer, size_t length) = 0;
+
+    /**
+     * @brief 等待数据可读 / Wait until data is readable
+     * @param timeout_ms 超时时间（毫秒） / Timeout in milliseconds
+     * @return 有数据可读返回 true，超时返回 false / true if data is readable, false on timeout
+     */
+    virtual bool waitReadable(uint32_t timeout_ms) = 0;
+
+    /**
+     * @brief 注册数据到达回调 / Register a data arrival callback
+     * @param callback 回调函数，nullptr 表示注销 / Callback function, nullptr to unregister
+     * @param context 回调上下文 / Callback context
+     * @return 后端支持数据到达通知时返回 true / true if the backend supports data arrival notification
+     */
+    virtual bool setReceiveCallback(Fingerprint_ReceiveCallback_t callback, void* context)
+    {
+        (void)callback;
+        (void)context;
+        return false;
+    }
+};
+
+#if defined(ARDUINO)
+/**
+ * @brief Arduino HardwareSerial 传输 / Arduino HardwareSerial transport
+ *
+ * begin() 以 115200 波特率配置串口（可选 TX/RX 引脚）。ESP32 Arduino 核心 2.x 及以上通过 onReceive 通知数据到达。
+ * begin() configures the port at 115200 baud (with optional TX/RX pins). On ESP32 Arduino core 2.x and later data
+ * arrival is signalled through onReceive.
+ */
+class Fingerprint_ArduinoTransport : public Fingerprint_Transport {
+public:
+    Fingerprint_ArduinoTransport(HardwareSerial* serialPort = nullptr, int txPin = -1, int rxPin = -1)
+        : _serialPort(serialPort), _txPin(txPin), _rxPin(rxPin)
+    {
+    }
+
+    bool begin() override;
+    size_t available() override;
+    size_t read(uint8_t* buffer, size_t length) override;
+    size_t write(const uint8_t* buffer, size_t length) override;
+    bool waitReadable(uint32_t timeout_ms) override;
+    bool setReceiveCallback(Fingerprint_ReceiveCallback_t callback, void* context) override;
+
+private:
+    HardwareSerial* _serialPort;
+    int _txPin;  // TX引脚编号 / TX pin number
+    int _rxPin;  // RX引脚编号 / RX pin number
+};
+#endif
+
+#if defined(__linux__) && !defined(ARDUINO)
+/**
+ * @brief 文件描述符传输（Linux） / File descriptor transport (Linux)
+ *
+ * 以非阻塞方式读写任意字节流文件描述符，waitReadable() 使用 poll()。可通过 createSocketPair() 创建一对互联的
+ * 回环传输，用于在主机上以模拟模组测试协议引擎。
+ *
+ * Reads and writes any byte-stream file descriptor in non-blocking mode; waitReadable() uses poll(). A connected
+ * pair of loopback transports can be created with createSocketPair(), for exercising the protocol engine against a
+ * simulated module on the host.
+ */
+class Fingerprint_FdTransport : public Fingerprint_Transport {
+public:
+    /**
+     * @param fd 已打开的文件描述符，-1 表示由 begin() 打开 / Open file descriptor, -1 if begin() opens it
+     * @param ownsFd 是否在 end() 时关闭该描述符 / Whether end() closes the descriptor
+     */
+    explicit Fingerprint_FdTransport(int fd = -1, bool ownsFd = true);
+    ~Fingerprint_FdTransport() override;
+
+    bool begin() override;
+    void end() override;
+    size_t available() override;
+    size_t read(uint8_t* buffer, size_t length) override;
+    size_t write(const uint8_t* buffer, size_t length) override;
+    bool waitReadable(uint32_t timeout_ms) override;
+
+    int fd() const { return _fd; }
+
+    /**
+     * @brief 创建一对互联的回环传输（socketpair） / Create a connected pair of loopback transports (socketpair)
+     * @return 成功返回 true / true on success
+     */
+    static bool createSocketPair(Fingerprint_FdTransport& a, Fingerprint_FdTransport& b);
+
+protected:
+    void adopt(int fd, bool ownsFd);
+
+    int _fd;
+    bool _ownsFd;
+};
+
+/**
+ * @brief Linux termios 串口设备传输 / Linux termios serial device transport
+ *
+ * 以原始模式（8N1，无流控）打开 USB-UART 等串口设备，例如 /dev/ttyUSB0。波特率须为标准速率（1200 到 921600，
+ * 平台支持时还有 500000 到 2000000），否则 begin() 失败。
+ * Opens a serial device such as a USB-UART adapter (e.g. /dev/ttyUSB0) in raw mode (8N1, no flow control). The baud
+ * rate must be a standard rate (1200 to 921600, plus 500000 to 2000000 where the platform defines them), otherwise
+ * begin() fails.
+ */
+class Fingerprint_TermiosTransport : public Fingerprint_FdTransport {
+public:
+    Fingerprint_TermiosTransport(const char* device, uint32_t baudRate = 115200);
+
+    bool begin() override;
+
+private:
+    const char* _device;
+    uint32_t _baudRate;
+};
+
+/**
+ * @brief 伪终端回环传输 / Pseudo-terminal loopback transport
+ *
+ * begin() 创建伪终端主端，slaveName() 给出从端设备路径，模拟模组或其它程序可以像真实串口一样打开它。
+ * begin() creates a pseudo-terminal master; slaveName() gives the slave device path, which a simulated module or
+ * another program can open like a real serial port.
+ */
+class Fingerprint_PtyTransport : public Fingerprint_FdTransport {
+public:
+    Fingerprint_PtyTransport();
+
+    bool begin() override;
+
+    // 从端设备路径，begin() 成功后有效 / Slave device path, valid after a successful begin()
+    const char* slaveName() const { return _slaveName; }
+
+private:
+    char _slaveName[64];
+};
+#endif
+
+#endif  // __M5_UNIT_FINGERPRINT2_TRANSPORT_H
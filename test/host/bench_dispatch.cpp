@@ -0,0 +1,133 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 解析包分发表出队开销：队列中有 16 到 256 个包时每次出队的时间应保持不变。作为对照，同时测量原先
+// 逐个前移包的线性队列。
+// Dequeue cost of the parsed packet dispatch table: the time per dequeue should stay flat from 16 to 256 queued
+// packets. The former linear queue, which shifts every later packet down, is measured alongside for comparison.
+
+#include "host_test.hpp"
+
+#include <cstring>
+
+#include "M5UnitFingerprint2_queue.hpp"
+
+static const size_t BENCH_DEPTH      = 256;
+static const size_t BENCH_DEQUEUES   = 1 << 18;  // 每个深度的出队总数 / Total dequeues per depth
+static const size_t BENCH_FRAME_SIZE = 139;      // 128 字节数据包 / 128-byte data packet
+
+static Fingerprint_PacketQueue<BENCH_DEPTH> queue;
+static Fingerprint_ParsedPacket linear[BENCH_DEPTH];
+static volatile uint32_t sink;
+
+static void makeFrame(uint8_t* frame, size_t length, uint8_t type, uint8_t fill)
+{
+    memset(frame, fill, length);
+    frame[0] = 0xEF;
+    frame[1] = 0x01;
+    frame[6] = type;
+    frame[7] = 0;
+    frame[8] = length - FINGERPRINT_PACKET_HEADER_SIZE;
+}
+
+// 分发表：装满 depth 个包后从 DATA 通道逐个取出 / Dispatch table: fill depth packets, then take them from the DATA lane one by one
+static double dispatchDequeueNs(size_t depth)
+{
+    uint8_t frame[BENCH_FRAME_SIZE];
+    makeFrame(frame, sizeof(frame), FINGERPRINT_PACKET_DATAPACKET, 0x5A);
+
+    uint64_t total = 0;
+    for (size_t done = 0; done < BENCH_DEQUEUES; done += depth) {
+        for (size_t i = 0; i < depth; i++) {
+            queue.push(frame, sizeof(frame), 0);
+        }
+        uint64_t start = hostNowNs();
+        for (size_t i = 0; i < depth; i++) {
+            const Fingerprint_ParsedPacket* packet = queue.front(FINGERPRINT_LANE_DATA);
+            sink += packet->data[9];
+            queue.pop(FINGERPRINT_LANE_DATA);
+        }
+        total += hostNowNs() - start;
+    }
+    return static_cast<double>(total) / BENCH_DEQUEUES;
+}
+
+// 原先的线性队列：取出队首后把其余包前移一个位置 / Former linear queue: after taking the head, move every other packet down one slot
+static double linearDequeueNs(size_t depth)
+{
+    uint8_t frame[BENCH_FRAME_SIZE];
+    makeFrame(frame, sizeof(frame), FINGERPRINT_PACKET_DATAPACKET, 0x5A);
+
+    uint64_t total = 0;
+    for (size_t done = 0; done < BENCH_DEQUEUES; done += depth) {
+        for (size_t i = 0; i < depth; i++) {
+            memcpy(linear[i].data, frame, sizeof(frame));
+            linear[i].length = sizeof(frame);
+        }
+        size_t count   = depth;
+        uint64_t start = hostNowNs();
+        for (size_t i = 0; i < depth; i++) {
+            sink += linear[0].data[9];
+            for (size_t j = 1; j < count; j++) {
+                linear[j - 1] = linear[j];
+            }
+            count--;
+        }
+        total += hostNowNs() - start;
+    }
+    return static_cast<double>(total) / BENCH_DEQUEUES;
+}
+
+// 应答排在一批数据包之后：按通道取包无需扫描 / An ACK queued behind a burst of data packets: per-lane lookup needs no scan
+static double ackBehindDataNs(size_t dataPackets)
+{
+    uint8_t data[BENCH_FRAME_SIZE];
+    uint8_t ack[12];
+    makeFrame(data, sizeof(data), FINGERPRINT_PACKET_DATAPACKET, 0x5A);
+    makeFrame(ack, sizeof(ack), FINGERPRINT_PACKET_ACKPACKET, 0x00);
+
+    queue.clear();
+    for (size_t i = 0; i < dataPackets; i++) {
+        queue.push(data, sizeof(data), 0);
+    }
+    // 每轮放入一个应答再取出，计时包含放入 / Each round pushes one ACK and takes it back; the timing includes the push
+    uint64_t start = hostNowNs();
+    for (size_t r = 0; r < BENCH_DEQUEUES; r++) {
+        queue.push(ack, sizeof(ack), 0);
+        Fingerprint_PacketQueue<BENCH_DEPTH>::index_t index = queue.claim(FINGERPRINT_LANE_ACK);
+        if (index != queue.INVALID_INDEX) {
+            sink += queue.slot(index).data[9];
+            queue.release(index);
+        }
+    }
+    uint64_t total = hostNowNs() - start;
+    queue.clear();
+    return static_cast<double>(total) / BENCH_DEQUEUES;
+}
+
+HOST_TEST(bench_dispatch_dequeue)
+{
+    // 每批出队计时一次，批次太小时时钟开销占主导 / One clock read per batch; with tiny batches the clock overhead dominates
+    static const size_t depths[] = {16, 64, 256};
+    double dispatchNs[3];
+
+    printf("%8s %16s %16s\n", "queued", "table ns/op", "linear ns/op");
+    for (size_t i = 0; i < 3; i++) {
+        dispatchNs[i]   = dispatchDequeueNs(depths[i]);
+        double linearNs = linearDequeueNs(depths[i]);
+        printf("%8u %16.1f %16.1f\n", (unsigned)depths[i], dispatchNs[i], linearNs);
+    }
+
+    double ackFew  = ackBehindDataNs(0);
+    double ackMany = ackBehindDataNs(BENCH_DEPTH - 2);
+    printf("ACK lookup: %.1f ns with an empty DATA lane, %.1f ns behind %u data packets\n", ackFew, ackMany,
+           (unsigned)(BENCH_DEPTH - 2));
+
+    // 出队开销与队列长度无关；留出计时噪声的余量 / Dequeue cost does not depend on the queue length; leave room for timing noise
+    HOST_CHECK(dispatchNs[2] < dispatchNs[0] * 4 + 20);
+    HOST_CHECK(ackMany < ackFew * 4 + 20);
+    return 0;
+}
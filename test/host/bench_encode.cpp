@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 命令帧编码：先检查一次编码的帧与 Fingerprint_Packet 加 serialize() 的结果逐字节相同，覆盖所有命令码与 0 到 40 字节参数；
+// 再测量两种方式编码一帧 PS_Search() 与握手命令的时间。
+// Command frame encoding: first checks that the one-pass frame matches Fingerprint_Packet plus serialize() byte for
+// byte, for every command code and 0 to 40 parameter bytes; then times both ways of encoding a PS_Search() frame and a
+// handshake frame.
+
+#include "host_test.hpp"
+
+#include <cstring>
+
+#include "M5UnitFingerprint2.hpp"
+
+static const int ENCODE_ROUNDS         = 2000000;
+static const size_t ENCODE_MAX_PARAMS  = 40;
+static const uint32_t ENCODE_ADDRESS   = 0xFFFFFFFF;
+static const size_t PACKET_SEND_BUFFER = FINGERPRINT_PACKET_HEADER_SIZE + FINGERPRINT_MAX_PACKET_SIZE + 2;
+
+// 让编译器认为整帧都被读取，不能只算出最后一个字节 / Make the compiler treat the whole frame as read, so it cannot compute only the last byte
+static inline void keepFrame(const uint8_t* frame)
+{
+    asm volatile("" : : "g"(frame) : "memory");
+}
+
+// 原先的路径：构造 Fingerprint_Packet 再拷贝进发送缓冲区 / Former path: build a Fingerprint_Packet, then copy it into the send buffer
+static size_t encodeWithPacket(uint8_t* frame, uint32_t address, uint8_t command, const uint8_t* param, uint16_t length)
+{
+    Fingerprint_Packet packet = Fingerprint_Packet::new_command_packet(address, command, length ? param : nullptr, length);
+    return packet.serialize(frame, PACKET_SEND_BUFFER);
+}
+
+static bool sameFrame(const uint8_t* a, size_t aLength, const uint8_t* b, size_t bLength)
+{
+    return aLength == bLength && memcmp(a, b, aLength) == 0;
+}
+
+HOST_TEST(bench_command_encode)
+{
+    uint8_t expected[PACKET_SEND_BUFFER];
+    uint8_t actual[PACKET_SEND_BUFFER];
+
+    int mismatches = 0;
+    for (int command = 0; command < 256; command++) {
+        for (uint16_t length = 0; length <= ENCODE_MAX_PARAMS; length++) {
+            uint8_t param[ENCODE_MAX_PARAMS];
+            for (uint16_t i = 0; i < length; i++) {
+                param[i] = static_cast<uint8_t>(command * 31 + i * 7);
+            }
+            size_t expectedLength = encodeWithPacket(expected, 0x12345678, command, param, length);
+            size_t actualLength   = Fingerprint_CommandFrame::encode(actual, 0x12345678, command, param, length);
+            mismatches += !sameFrame(expected, expectedLength, actual, actualLength);
+        }
+    }
+
+    uint8_t search[5]     = {1, 0x00, 0x00, 0x00, 99};
+    size_t expectedLength = encodeWithPacket(expected, ENCODE_ADDRESS, FINGERPRINT_SEARCH, search, sizeof(search));
+    size_t actualLength   = Fingerprint_CommandEncoder<FINGERPRINT_SEARCH, 5>::encode(actual, ENCODE_ADDRESS, search);
+    mismatches += !sameFrame(expected, expectedLength, actual, actualLength);
+
+    expectedLength = encodeWithPacket(expected, ENCODE_ADDRESS, FINGERPRINT_HAND_SHAKE, nullptr, 0);
+    actualLength   = Fingerprint_CommandEncoder<FINGERPRINT_HAND_SHAKE>::encode(actual, ENCODE_ADDRESS, nullptr);
+    mismatches += !sameFrame(expected, expectedLength, actual, actualLength);
+    printf("frame mismatches: %d\n", mismatches);
+    HOST_CHECK(mismatches == 0);
+
+    // 每轮改动一个参数字节，避免编译器把整个循环折叠 / Change one parameter byte per round so the compiler cannot fold the loop
+    uint64_t start = hostNowNs();
+    for (int i = 0; i < ENCODE_ROUNDS; i++) {
+        search[0] = static_cast<uint8_t>(i);
+        encodeWithPacket(expected, ENCODE_ADDRESS, FINGERPRINT_SEARCH, search, sizeof(search));
+        keepFrame(expected);
+    }
+    double packetNs = static_cast<double>(hostNowNs() - start) / ENCODE_ROUNDS;
+
+    start = hostNowNs();
+    for (int i = 0; i < ENCODE_ROUNDS; i++) {
+        uint8_t frame[Fingerprint_CommandEncoder<FINGERPRINT_SEARCH, 5>::frameSize];
+        search[0] = static_cast<uint8_t>(i);
+        Fingerprint_CommandEncoder<FINGERPRINT_SEARCH, 5>::encode(frame, ENCODE_ADDRESS, search);
+        keepFrame(frame);
+    }
+    double encoderNs = static_cast<double>(hostNowNs() - start) / ENCODE_ROUNDS;
+
+    start = hostNowNs();
+    for (int i = 0; i < ENCODE_ROUNDS; i++) {
+        uint8_t frame[Fingerprint_CommandEncoder<FINGERPRINT_HAND_SHAKE>::frameSize];
+        Fingerprint_CommandEncoder<FINGERPRINT_HAND_SHAKE>::encode(frame, ENCODE_ADDRESS ^ i, nullptr);
+        keepFrame(frame);
+    }
+    double handshakeNs = static_cast<double>(hostNowNs() - start) / ENCODE_ROUNDS;
+
+    printf("PS_Search(): packet + serialize %.1f ns, encoder %.1f ns; handshake encoder %.1f ns\n", packetNs,
+           encoderNs, handshakeNs);
+    printf("stack: Fingerprint_Packet %zu + send buffer %zu bytes; encoder frame %zu bytes (PS_Search), %zu bytes "
+           "(handshake)\n",
+           sizeof(Fingerprint_Packet), PACKET_SEND_BUFFER, Fingerprint_CommandEncoder<FINGERPRINT_SEARCH, 5>::frameSize,
+           Fingerprint_CommandEncoder<FINGERPRINT_HAND_SHAKE>::frameSize);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 多模组管理器：16 个模拟模组，每个保持 4 条异步命令在途，分别以 1、2、4 个工作线程测量每秒完成的命令数；
+// 随后在所有模组上运行 identifyAny()，只有一个模组检测到手指。
+// Multi-unit manager: 16 simulated units, each keeping 4 asynchronous commands in flight, measured in commands
+// completed per second with 1, 2 and 4 workers; then identifyAny() runs on every unit with a finger on only one.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+#include "M5UnitFingerprint2_fleet.hpp"
+
+#include <atomic>
+
+static const size_t FLEET_UNITS    = 16;
+static const int FLEET_IN_FLIGHT   = 4;
+static const uint32_t FLEET_RUN_MS = 1000;
+
+// 检测到手指的模组序号与按下的时间 / Index of the unit that sees a finger, and when
+static std::atomic<int> fingerUnit{-1};
+static const uint32_t FINGER_DELAY_MS = 150;
+
+// 自动识别：有手指的模组在 FINGER_DELAY_MS 后报告匹配，其余模组保持等待直到取消 / Auto identify: the unit with a
+// finger reports a match after FINGER_DELAY_MS, the others keep waiting until cancelled
+static bool fleetHandler(SimUnit& unit, uint8_t command, const uint8_t* param, size_t paramLength, void* context)
+{
+    (void)param;
+    (void)paramLength;
+    (void)context;
+    if (command != FINGERPRINT_AUTO_IDENTIFY) {
+        return false;
+    }
+    uint8_t started[6] = {FINGERPRINT_OK, 0x00, 0, 0, 0, 0};
+    unit.reply(started, sizeof(started));
+    if (unit.id() == fingerUnit) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(FINGER_DELAY_MS));
+        uint8_t image[6] = {FINGERPRINT_OK, 0x01, 0, 0, 0, 0};
+        unit.reply(image, sizeof(image));
+        uint8_t matched[6] = {FINGERPRINT_OK, 0x05, 0x00, 0x07, 0x00, 99};
+        unit.reply(matched, sizeof(matched));
+    }
+    return true;
+}
+
+struct FleetUnit {
+    M5UnitFingerprint2* device;
+    uint8_t id;
+};
+
+static std::atomic<bool> fleetRunning{false};
+static std::atomic<uint64_t> fleetDone{0};
+static std::atomic<uint32_t> fleetWrong{0};
+
+// 每完成一条立即提交下一条，保持在途数量 / Submit the next command as each one completes, keeping the count in flight
+static void onFleetVersion(uint32_t handle, fingerprint_status_t status, const uint8_t* response,
+                           uint16_t responseLength, void* context)
+{
+    (void)handle;
+    FleetUnit* unit = static_cast<FleetUnit*>(context);
+    if (status != FINGERPRINT_OK || responseLength != 1 || response[0] != unit->id) {
+        fleetWrong++;
+    }
+    fleetDone++;
+    if (fleetRunning) {
+        unit->device->submitCommand(FINGERPRINT_GET_FINGERPRINT_VERSION, nullptr, 0, 1000, onFleetVersion, unit);
+    }
+}
+
+static int runFleet(size_t workers)
+{
+    SimUnit* units[FLEET_UNITS];
+    FleetUnit contexts[FLEET_UNITS];
+    Fingerprint_Fleet fleet(workers);
+    for (size_t i = 0; i < FLEET_UNITS; i++) {
+        units[i] = new SimUnit(static_cast<uint8_t>(i));
+        units[i]->setHandler(fleetHandler, nullptr);
+        HOST_CHECK(units[i]->start());
+        HOST_CHECK(fleet.add(units[i]->releaseTransport()) == static_cast<int>(i));
+    }
+    HOST_CHECK(fleet.begin());
+
+    fleetRunning = true;
+    fleetDone    = 0;
+    fleetWrong   = 0;
+    for (size_t i = 0; i < FLEET_UNITS; i++) {
+        contexts[i] = {&fleet.unit(i), static_cast<uint8_t>(i)};
+        for (int k = 0; k < FLEET_IN_FLIGHT; k++) {
+            fleet.unit(i).submitCommand(FINGERPRINT_GET_FINGERPRINT_VERSION, nullptr, 0, 1000, onFleetVersion,
+                                        &contexts[i]);
+        }
+        fleet.wake(i);
+    }
+    delay(FLEET_RUN_MS);
+    fleetRunning  = false;
+    uint64_t done = fleetDone;
+    delay(100);
+
+    fingerprint_fleet_stats_t stats;
+    fleet.getStats(stats);
+    printf("%zu workers: %8.0f commands/s, %u wrong, events=%u sweeps=%u updates=%u steals=%u\n",
+           fleet.workerCount(), done * 1000.0 / FLEET_RUN_MS, fleetWrong.load(), stats.events, stats.sweeps,
+           stats.updates, stats.steals);
+    HOST_CHECK(done > 0);
+    HOST_CHECK(fleetWrong == 0);
+
+    // 一个模组检测到手指并做出判定 / One unit sees a finger and decides
+    fingerUnit = 5;
+    fingerprint_fleet_match_t match;
+    uint64_t start              = hostNowNs();
+    fingerprint_status_t result = fleet.identifyAny(3000, match);
+    double identifyMs           = (hostNowNs() - start) / 1e6;
+    printf("identifyAny: 0x%02X unit=%d page=%u score=%u in %.0f ms\n", result, match.unit, match.pageID, match.score,
+           identifyMs);
+    HOST_CHECK(result == FINGERPRINT_OK && match.unit == 5 && match.pageID == 7);
+
+    // 没有手指：到期后取消所有模组 / No finger: every unit is cancelled at the deadline
+    fingerUnit = -1;
+    result     = fleet.identifyAny(500, match);
+    printf("identifyAny without a finger: 0x%02X unit=%d\n", result, match.unit);
+    HOST_CHECK(result == FINGERPRINT_TIMEOUT && match.unit == -1);
+
+    // 流程结束后模组照常应答 / Units answer as usual after the flows
+    uint8_t version = 0;
+    HOST_CHECK(fleet.unit(3).PS_GetFirmwareVersion(version) == FINGERPRINT_OK && version == 3);
+
+    fleet.end();
+    for (size_t i = 0; i < FLEET_UNITS; i++) {
+        delete units[i];
+    }
+    return 0;
+}
+
+HOST_TEST(bench_fleet)
+{
+    static const size_t workers[] = {1, 2, 4};
+    for (size_t w : workers) {
+        HOST_CHECK(runFleet(w) == 0);
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 响应交接延迟：从解析出校验和字节到等待的调用者被唤醒，取自 getReceiveStats()。分别测量调用者自己解析，
+// 以及另一个线程调用 update() 解析并交给调用者两种情况。后一种情况下调用者在当前一次 FINGERPRINT_NATIVE_WAIT_SLICE_MS
+// 等待结束时才发现交接。
+// Response handoff latency: from the checksum byte being parsed to the waiting caller waking up, as reported by
+// getReceiveStats(). Measured with the caller parsing by itself, and with another thread parsing through update() and
+// handing the response over. In the second case the caller notices the handoff at the end of its current
+// FINGERPRINT_NATIVE_WAIT_SLICE_MS wait.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+#include <atomic>
+#include <thread>
+
+static const int LATENCY_ROUND_TRIPS = 2000;
+
+// 返回交接次数是否与往返次数相符 / Returns whether the handoff count matches the round trips
+static bool measureLatency(const char* label, bool parserThread)
+{
+    SimUnit unit(0x42);
+    if (!unit.start()) {
+        return false;
+    }
+    M5UnitFingerprint2 fp(unit.transport());
+    if (!fp.begin()) {
+        return false;
+    }
+
+    std::atomic<bool> running{true};
+    std::thread parser;
+    if (parserThread) {
+        parser = std::thread([&] {
+            while (running) {
+                fp.update();
+                unit.transport()->waitReadable(1);
+            }
+        });
+    }
+
+    fingerprint_rx_stats_t before;
+    fp.getReceiveStats(before);
+    int failed     = 0;
+    uint64_t start = hostNowNs();
+    for (int i = 0; i < LATENCY_ROUND_TRIPS; i++) {
+        uint8_t version = 0;
+        failed += (fp.PS_GetFirmwareVersion(version) != FINGERPRINT_OK || version != 0x42);
+    }
+    double roundTripUs = (hostNowNs() - start) / 1e3 / LATENCY_ROUND_TRIPS;
+
+    running = false;
+    if (parser.joinable()) {
+        parser.join();
+    }
+
+    fingerprint_rx_stats_t after;
+    fp.getReceiveStats(after);
+    uint32_t handoffs = after.handoffCount - before.handoffCount;
+    double meanUs     = handoffs ? (double)(after.handoffLatencyTotalUs - before.handoffLatencyTotalUs) / handoffs : 0;
+    printf("%-22s round trip %7.1f us, handoff mean %6.1f us max %6u us, %u handoffs, %d failed\n", label,
+           roundTripUs, meanUs, after.handoffLatencyMaxUs, handoffs, failed);
+
+    // 队列里已有应答时直接取走，不经交接 / A response already queued is taken directly, without a handoff
+    return failed == 0 && handoffs <= (uint32_t)LATENCY_ROUND_TRIPS;
+}
+
+HOST_TEST(bench_handoff_latency)
+{
+    HOST_CHECK(measureLatency("caller parses", false));
+    HOST_CHECK(measureLatency("update() thread parses", true));
+    return 0;
+}
@@ -0,0 +1,59 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 各包大小下的图像上传吞吐量：模拟模组以 115200 波特率的节奏发出 8 KB 图像，包越大帧头与校验和开销越小。
+// 随后检查批量传输策略是否把包大小提升到 256 字节，以及恢复策略是否放回原值。
+// Image upload throughput per packet size: the simulated unit sends an 8 KB image paced at 115200 baud, and larger
+// packets carry less header and checksum overhead. Then checks that the bulk profile raises the packet size to 256
+// bytes and that the restoring profile puts the previous size back.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+static const uint32_t PACKET_SIZE_LINK_BAUD = 115200;
+
+static uint8_t image[2 * SIM_UNIT_IMAGE_SIZE];
+
+HOST_TEST(bench_packet_size_throughput)
+{
+    SimUnit unit;
+    unit.setLinkBaud(PACKET_SIZE_LINK_BAUD);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    double kbPerSecond[4];
+    fp.setTransferProfile(FINGERPRINT_TRANSFER_AS_CONFIGURED);
+    for (uint8_t sizeCode = 0; sizeCode < 4; sizeCode++) {
+        HOST_CHECK(fp.setPacketSize(sizeCode) == FINGERPRINT_OK);
+        uint32_t received = 0;
+        uint64_t start    = hostNowNs();
+        HOST_CHECK(fp.PS_UpImage(image, sizeof(image), received) == FINGERPRINT_OK);
+        double seconds = (hostNowNs() - start) / 1e9;
+        HOST_CHECK(received == SIM_UNIT_IMAGE_SIZE);
+
+        kbPerSecond[sizeCode] = received / 1024.0 / seconds;
+        printf("%3u-byte packets: %u bytes in %.0f ms, %.1f KB/s\n", M5UnitFingerprint2::packetSizeBytes(sizeCode),
+               received, seconds * 1e3, kbPerSecond[sizeCode]);
+    }
+    HOST_CHECK(kbPerSecond[3] > kbPerSecond[0]);
+
+    // 批量策略：传输前提升到 FINGERPRINT_BULK_PACKET_SIZE 并保持 / Bulk profile: raise to FINGERPRINT_BULK_PACKET_SIZE before the transfer and keep it
+    uint32_t received = 0;
+    HOST_CHECK(fp.setPacketSize(0) == FINGERPRINT_OK);
+    fp.setTransferProfile(FINGERPRINT_TRANSFER_BULK);
+    HOST_CHECK(fp.PS_UpImage(image, sizeof(image), received) == FINGERPRINT_OK);
+    printf("bulk profile: module packet size %u bytes afterwards\n",
+           M5UnitFingerprint2::packetSizeBytes(unit.packetSizeCode()));
+    HOST_CHECK(unit.packetSizeCode() == FINGERPRINT_BULK_PACKET_SIZE);
+
+    // 恢复策略：传输后放回原值 / Restoring profile: put the previous size back after the transfer
+    HOST_CHECK(fp.setPacketSize(0) == FINGERPRINT_OK);
+    fp.setTransferProfile(FINGERPRINT_TRANSFER_BULK_RESTORE);
+    HOST_CHECK(fp.PS_UpImage(image, sizeof(image), received) == FINGERPRINT_OK);
+    HOST_CHECK(unit.packetSizeCode() == 0);
+    return 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "host_test.hpp"
+
+#include <cstring>
+
+static HostTestCase* caseList = nullptr;
+
+HostTestCase::HostTestCase(const char* caseName, HostTestFunction_t caseFunction)
+    : name(caseName), function(caseFunction), next(caseList)
+{
+    caseList = this;
+}
+
+// 不带参数时运行全部用例，否则只运行指定的用例 / Without arguments run every case, otherwise only the named ones
+int main(int argc, char** argv)
+{
+    int failed = 0;
+    int run    = 0;
+    for (HostTestCase* c = caseList; c != nullptr; c = c->next) {
+        bool selected = (argc < 2);
+        for (int i = 1; i < argc && !selected; i++) {
+            selected = (strcmp(argv[i], c->name) == 0);
+        }
+        if (!selected) {
+            continue;
+        }
+
+        printf("[ RUN  ] %s\n", c->name);
+        fflush(stdout);
+        int result = c->function();
+        printf("[ %s ] %s\n", (result == 0) ? " OK " : "FAIL", c->name);
+        fflush(stdout);
+        failed += (result != 0);
+        run++;
+    }
+
+    if (run == 0) {
+        printf("No matching case.\n");
+        return 1;
+    }
+    return (failed == 0) ? 0 : 1;
+}
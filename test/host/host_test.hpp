@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_HOST_TEST_H
+#define __M5_UNIT_FINGERPRINT2_HOST_TEST_H
+
+// 主机测试与基准的最小注册框架 / Minimal registration framework for host tests and benchmarks
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// 用例函数，返回 0 表示通过 / Case function, returns 0 on success
+typedef int (*HostTestFunction_t)();
+
+struct HostTestCase {
+    const char* name;
+    HostTestFunction_t function;
+    HostTestCase* next;
+
+    HostTestCase(const char* caseName, HostTestFunction_t caseFunction);
+};
+
+/**
+ * @brief 定义一个用例 / Define a case
+ *
+ * HOST_TEST(name) { ...; return 0; } 在可执行文件中以 name 注册，ctest 按名称逐个运行。
+ * HOST_TEST(name) { ...; return 0; } registers the case under name in the executable; ctest runs each by name.
+ */
+#define HOST_TEST(name)                                       \
+    static int name();                                        \
+    static HostTestCase name##_case(#name, name);             \
+    static int name()
+
+// 条件不成立时打印位置并使用例失败 / Print the location and fail the case when the condition does not hold
+#define HOST_CHECK(condition)                                                              \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);           \
+            return 1;                                                                      \
+        }                                                                                  \
+    } while (0)
+
+// 单调时钟纳秒数 / Monotonic clock in nanoseconds
+static inline uint64_t hostNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+#endif  // __M5_UNIT_FINGERPRINT2_HOST_TEST_H
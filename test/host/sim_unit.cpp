@@ -0,0 +1,162 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "sim_unit.hpp"
+
+#include <chrono>
+#include <cstring>
+
+SimUnit::SimUnit(uint8_t id) : _id(id), _host(new Fingerprint_FdTransport())
+{
+}
+
+SimUnit::~SimUnit()
+{
+    stop();
+}
+
+bool SimUnit::start()
+{
+    if (!Fingerprint_FdTransport::createSocketPair(*_host, _unit)) {
+        return false;
+    }
+    _running = true;
+    _thread  = std::thread(&SimUnit::run, this);
+    return true;
+}
+
+void SimUnit::stop()
+{
+    _running = false;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void SimUnit::setHandler(SimUnitHandler_t handler, void* context)
+{
+    _handler        = handler;
+    _handlerContext = context;
+}
+
+void SimUnit::sendFrame(uint8_t type, const uint8_t* payload, size_t length)
+{
+    uint8_t frame[FINGERPRINT_MAX_FRAME_SIZE];
+    uint16_t packetLength = static_cast<uint16_t>(length + 2);
+    uint16_t sum          = type + (packetLength >> 8) + (packetLength & 0xFF);
+
+    frame[0] = 0xEF;
+    frame[1] = 0x01;
+    memset(&frame[2], 0xFF, 4);
+    frame[6] = type;
+    frame[7] = packetLength >> 8;
+    frame[8] = packetLength & 0xFF;
+    for (size_t i = 0; i < length; i++) {
+        frame[FINGERPRINT_PACKET_HEADER_SIZE + i] = payload[i];
+        sum += payload[i];
+    }
+    frame[FINGERPRINT_PACKET_HEADER_SIZE + length]     = sum >> 8;
+    frame[FINGERPRINT_PACKET_HEADER_SIZE + length + 1] = sum & 0xFF;
+
+    size_t frameLength = FINGERPRINT_PACKET_HEADER_SIZE + length + 2;
+    _unit.write(frame, frameLength);
+
+    // 一个字节 10 位（8N1） / Ten bits per byte (8N1)
+    if (_linkBaud != 0 && type != FINGERPRINT_PACKET_ACKPACKET) {
+        std::this_thread::sleep_for(std::chrono::microseconds(frameLength * 10 * 1000000ULL / _linkBaud));
+    }
+}
+
+// 收集字节并逐帧处理，校验和不符的帧被计数并丢弃 / Collect bytes and handle them frame by frame; frames with a bad checksum are counted and dropped
+void SimUnit::run()
+{
+    uint8_t buffer[4096];
+    size_t buffered = 0;
+
+    while (_running) {
+        if (!_unit.waitReadable(10)) {
+            continue;
+        }
+        buffered += _unit.read(buffer + buffered, sizeof(buffer) - buffered);
+
+        size_t offset = 0;
+        while (buffered - offset >= FINGERPRINT_PACKET_HEADER_SIZE) {
+            const uint8_t* frame = buffer + offset;
+            size_t length        = (frame[7] << 8) | frame[8];
+            if (buffered - offset < FINGERPRINT_PACKET_HEADER_SIZE + length) {
+                break;
+            }
+            offset += FINGERPRINT_PACKET_HEADER_SIZE + length;
+            if (length < 2) {
+                continue;
+            }
+            uint16_t sum = frame[6] + frame[7] + frame[8];
+            for (size_t i = 0; i < length - 2; i++) {
+                sum += frame[FINGERPRINT_PACKET_HEADER_SIZE + i];
+            }
+            if (sum != ((frame[FINGERPRINT_PACKET_HEADER_SIZE + length - 2] << 8) |
+                        frame[FINGERPRINT_PACKET_HEADER_SIZE + length - 1])) {
+                _checksumErrors++;
+                continue;
+            }
+            if (frame[6] == FINGERPRINT_PACKET_COMMANDPACKET && length >= 3) {
+                _commands++;
+                handleCommand(frame[FINGERPRINT_PACKET_HEADER_SIZE], frame + FINGERPRINT_PACKET_HEADER_SIZE + 1,
+                              length - 3);
+            }
+        }
+        memmove(buffer, buffer + offset, buffered - offset);
+        buffered -= offset;
+    }
+}
+
+void SimUnit::handleCommand(uint8_t command, const uint8_t* param, size_t paramLength)
+{
+    if (_replyDelayMs != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(_replyDelayMs));
+    }
+    if (_handler == nullptr || !_handler(*this, command, param, paramLength, _handlerContext)) {
+        defaultReply(command, param, paramLength);
+    }
+}
+
+void SimUnit::defaultReply(uint8_t command, const uint8_t* param, size_t paramLength)
+{
+    switch (command) {
+        case FINGERPRINT_READ_SYSTEM_PARAM: {
+            uint8_t reply[17] = {0};
+            memset(&reply[9], 0xFF, 4);
+            reply[14] = _packetSizeCode;
+            this->reply(reply, sizeof(reply));
+            break;
+        }
+        case FINGERPRINT_WRITE_REG:
+            if (paramLength >= 2 && param[0] == FINGERPRINT_PACKET_REG_ADDR) {
+                _packetSizeCode = param[1] & 0x03;
+            }
+            replyCode(FINGERPRINT_OK);
+            break;
+        case FINGERPRINT_UPLOAD_IMAGE: {
+            static uint8_t image[SIM_UNIT_IMAGE_SIZE];
+            size_t packetSize = M5UnitFingerprint2::packetSizeBytes(_packetSizeCode);
+            replyCode(FINGERPRINT_OK);
+            for (size_t offset = 0; offset < sizeof(image); offset += packetSize) {
+                bool last = offset + packetSize >= sizeof(image);
+                sendFrame(last ? FINGERPRINT_PACKET_ENDDATAPACKET : FINGERPRINT_PACKET_DATAPACKET, image + offset,
+                          packetSize);
+            }
+            break;
+        }
+        case FINGERPRINT_GET_FINGERPRINT_VERSION: {
+            uint8_t reply[2] = {FINGERPRINT_OK, _id};
+            this->reply(reply, sizeof(reply));
+            break;
+        }
+        default:
+            replyCode(FINGERPRINT_OK);
+            break;
+    }
+}
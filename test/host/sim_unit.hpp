@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __M5_UNIT_FINGERPRINT2_SIM_UNIT_H
+#define __M5_UNIT_FINGERPRINT2_SIM_UNIT_H
+
+// 套接字对另一端的模拟指纹模组 / Simulated fingerprint unit on the far end of a socket pair
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "M5UnitFingerprint2.hpp"
+
+#define SIM_UNIT_IMAGE_SIZE 8192  // 模拟图像大小（字节） / Simulated image size (bytes)
+
+class SimUnit;
+
+/**
+ * @brief 命令处理函数 / Command handler
+ *
+ * 在模组线程中调用。返回 false 时按默认方式应答。
+ * Called on the unit's thread. Return false to fall back to the default reply.
+ */
+typedef bool (*SimUnitHandler_t)(SimUnit& unit, uint8_t command, const uint8_t* param, size_t paramLength,
+                                 void* context);
+
+/**
+ * @brief 模拟模组 / Simulated unit
+ *
+ * 解析主机发来的命令帧并按顺序应答，校验和不符的帧被丢弃。默认应答：
+ * READ_SYSTEM_PARAM 返回 17 字节参数（地址 0xFFFFFFFF 与当前包大小），WRITE_REG 记录包大小寄存器，
+ * UPLOAD_IMAGE 返回确认包和 SIM_UNIT_IMAGE_SIZE 字节的数据包，GET_FINGERPRINT_VERSION 返回 id，其余返回 {0}。
+ * Parses command frames from the host and replies in order; frames with a bad checksum are dropped. Default replies:
+ * READ_SYSTEM_PARAM returns the 17-byte parameters (address 0xFFFFFFFF and the current packet size), WRITE_REG
+ * records the packet size register, UPLOAD_IMAGE returns an ACK followed by SIM_UNIT_IMAGE_SIZE bytes of data
+ * packets, GET_FINGERPRINT_VERSION returns the id, everything else returns {0}.
+ */
+class SimUnit {
+public:
+    explicit SimUnit(uint8_t id = 0);
+    ~SimUnit();
+
+    // 创建套接字对并启动模组线程 / Create the socket pair and start the unit's thread
+    bool start();
+    void stop();
+
+    // 主机一侧的传输，交给 M5UnitFingerprint2 / Host side transport, handed to M5UnitFingerprint2
+    Fingerprint_FdTransport* transport() { return _host.get(); }
+
+    // 交出主机一侧传输的所有权（例如交给 Fingerprint_Fleet），之后 transport() 返回 nullptr / Hand over ownership
+    // of the host side transport (to a Fingerprint_Fleet, say); transport() returns nullptr afterwards
+    Fingerprint_FdTransport* releaseTransport() { return _host.release(); }
+
+    void setHandler(SimUnitHandler_t handler, void* context);
+
+    // 每个应答前的处理时间 / Processing time before each reply
+    void setReplyDelayMs(uint32_t ms) { _replyDelayMs = ms; }
+
+    // 按该波特率（8N1）为数据包限速，0 表示不限速 / Pace data packets at this baud rate (8N1), 0 for no pacing
+    void setLinkBaud(uint32_t baud) { _linkBaud = baud; }
+
+    void sendFrame(uint8_t type, const uint8_t* payload, size_t length);
+    void reply(const uint8_t* payload, size_t length) { sendFrame(FINGERPRINT_PACKET_ACKPACKET, payload, length); }
+    void replyCode(uint8_t code) { reply(&code, 1); }
+
+    uint8_t id() const { return _id; }
+    uint8_t packetSizeCode() const { return _packetSizeCode; }
+    uint32_t commandsReceived() const { return _commands; }
+    uint32_t checksumErrors() const { return _checksumErrors; }
+
+private:
+    void run();
+    void handleCommand(uint8_t command, const uint8_t* param, size_t paramLength);
+    void defaultReply(uint8_t command, const uint8_t* param, size_t paramLength);
+
+    uint8_t _id;
+    std::unique_ptr<Fingerprint_FdTransport> _host;
+    Fingerprint_FdTransport _unit;
+    std::thread _thread;
+    std::atomic<bool> _running{false};
+    SimUnitHandler_t _handler = nullptr;
+    void* _handlerContext     = nullptr;
+    uint32_t _replyDelayMs    = 0;
+    uint32_t _linkBaud        = 0;
+    std::atomic<uint8_t> _packetSizeCode{1};
+    std::atomic<uint32_t> _commands{0};
+    std::atomic<uint32_t> _checksumErrors{0};
+};
+
+#endif  // __M5_UNIT_FINGERPRINT2_SIM_UNIT_H
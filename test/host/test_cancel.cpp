@@ -0,0 +1,109 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// PS_Cancel 中止进行中的阻塞式 PS_AutoEnroll/PS_AutoIdentify：模拟模组发出第一个阶段包后等待手指，
+// 另一线程调用 PS_Cancel，流程立即返回 FINGERPRINT_OPERATION_BLOCKED，之后模组照常应答。
+// PS_Cancel pre-empts a running blocking PS_AutoEnroll/PS_AutoIdentify: the simulated unit sends the first stage packet
+// and waits for a finger, another thread calls PS_Cancel, the flow returns FINGERPRINT_OPERATION_BLOCKED at once, and
+// the unit answers as usual afterwards.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+#include <atomic>
+#include <thread>
+
+struct CancelUnit {
+    std::atomic<bool> waiting{false};  // 自动流程已开始等待手指 / The auto flow is waiting for a finger
+    std::atomic<int> cancels{0};
+};
+
+static bool cancelHandler(SimUnit& unit, uint8_t command, const uint8_t* param, size_t paramLength, void* context)
+{
+    (void)param;
+    (void)paramLength;
+    CancelUnit* cancel = static_cast<CancelUnit*>(context);
+    if (command == FINGERPRINT_AUTO_ENROLL) {
+        uint8_t started[3] = {FINGERPRINT_OK, 0x00, 0x00};
+        unit.reply(started, sizeof(started));
+        cancel->waiting = true;
+        return true;
+    }
+    if (command == FINGERPRINT_AUTO_IDENTIFY) {
+        uint8_t started[6] = {FINGERPRINT_OK, 0x00, 0, 0, 0, 0};
+        unit.reply(started, sizeof(started));
+        cancel->waiting = true;
+        return true;
+    }
+    if (command == FINGERPRINT_CANCEL_AUTO_FLOW) {
+        cancel->waiting = false;
+        cancel->cancels++;
+        unit.replyCode(FINGERPRINT_OK);
+        return true;
+    }
+    return false;
+}
+
+typedef fingerprint_status_t (*AutoFlowRunner_t)(M5UnitFingerprint2& fp);
+
+static fingerprint_status_t runAutoEnroll(M5UnitFingerprint2& fp)
+{
+    return fp.PS_AutoEnroll(3, 2, FINGERPRINT_AUTO_ENROLL_DEFAULT);
+}
+
+static fingerprint_status_t runAutoIdentify(M5UnitFingerprint2& fp)
+{
+    uint16_t pageID = 0;
+    return fp.PS_AutoIdentify(0, 0xFFFF, FINGERPRINT_AUTO_VERIFY_DEFAULT, pageID);
+}
+
+static int cancelPreempts(AutoFlowRunner_t runner)
+{
+    CancelUnit cancel;
+    SimUnit unit(0x31);
+    unit.setHandler(cancelHandler, &cancel);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    std::atomic<bool> flowDone{false};
+    fingerprint_status_t flowResult = FINGERPRINT_OK;
+    std::thread flow([&] {
+        flowResult = runner(fp);
+        flowDone   = true;
+    });
+    while (!cancel.waiting) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    HOST_CHECK(!flowDone);
+
+    uint64_t start                = hostNowNs();
+    fingerprint_status_t canceled = fp.PS_Cancel();
+    flow.join();
+    double cancelMs = (hostNowNs() - start) / 1e6;
+    printf("cancel=0x%02X flow=0x%02X in %.1f ms\n", canceled, flowResult, cancelMs);
+
+    HOST_CHECK(canceled == FINGERPRINT_OK);
+    HOST_CHECK(flowResult == FINGERPRINT_OPERATION_BLOCKED);
+    HOST_CHECK(cancel.cancels == 1);
+    HOST_CHECK(cancelMs < 1000);
+
+    // 模组回到空闲，下一条命令得到自己的应答 / The unit is idle again and the next command gets its own reply
+    uint8_t version = 0;
+    HOST_CHECK(fp.PS_GetFirmwareVersion(version) == FINGERPRINT_OK && version == 0x31);
+    return 0;
+}
+
+HOST_TEST(cancel_preempts_auto_enroll)
+{
+    return cancelPreempts(runAutoEnroll);
+}
+
+HOST_TEST(cancel_preempts_auto_identify)
+{
+    return cancelPreempts(runAutoIdentify);
+}
@@ -0,0 +1,119 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 08H/09H 支持探测：任何格式正确的应答都记为支持，只有指令无效确认码或连续多次无应答才记为不支持。
+// 08H/09H support probing: any well-formed acknowledge records support; only the invalid-command confirmation code or
+// repeated silence records it unsupported.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+#include <atomic>
+
+// 前 silent 条上传特征命令不应答，其余以 code 应答 / Leave the first silent template uploads unanswered, answer the rest with code
+struct CharUnit {
+    std::atomic<int> calls{0};
+    int silent   = 0;
+    uint8_t code = FINGERPRINT_OK;
+};
+
+static bool charHandler(SimUnit& unit, uint8_t command, const uint8_t* param, size_t paramLength, void* context)
+{
+    (void)param;
+    (void)paramLength;
+    CharUnit* charUnit = static_cast<CharUnit*>(context);
+    if (command != FINGERPRINT_UPLOAD_MODEL) {
+        return false;
+    }
+    if (++charUnit->calls <= charUnit->silent) {
+        return true;
+    }
+    unit.replyCode(charUnit->code);
+    return true;
+}
+
+static fingerprint_status_t upChar(M5UnitFingerprint2& fp)
+{
+    static uint8_t buffer[4096];
+    uint32_t actualSize = 0;
+    return fp.PS_UpChar(FINGERPRINT_CHAR_TRANSFER_BUFFER_ID, buffer, sizeof(buffer), actualSize);
+}
+
+// 非零确认码也说明模组实现了 08H / A non-zero confirmation code still shows the module implements 08H
+HOST_TEST(char_transfer_error_code_means_supported)
+{
+    CharUnit charUnit;
+    charUnit.code = FINGERPRINT_UPLOAD_FEATURE_FAIL;
+    SimUnit unit;
+    unit.setHandler(charHandler, &charUnit);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    HOST_CHECK(upChar(fp) == FINGERPRINT_UPLOAD_FEATURE_FAIL);
+    HOST_CHECK(fp.getCharTransferSupport() == FINGERPRINT_CHAR_TRANSFER_SUPPORTED);
+    return 0;
+}
+
+HOST_TEST(char_transfer_invalid_code_means_unsupported)
+{
+    CharUnit charUnit;
+    charUnit.code = FINGERPRINT_CHAR_TRANSFER_INVALID_CODE;
+    SimUnit unit;
+    unit.setHandler(charHandler, &charUnit);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    HOST_CHECK(upChar(fp) == static_cast<fingerprint_status_t>(FINGERPRINT_CHAR_TRANSFER_INVALID_CODE));
+    HOST_CHECK(fp.getCharTransferSupport() == FINGERPRINT_CHAR_TRANSFER_UNSUPPORTED);
+
+    // 已确认的结果只由显式设置改变 / A settled result changes only when set explicitly
+    fp.setCharTransferSupport(FINGERPRINT_CHAR_TRANSFER_UNKNOWN);
+    charUnit.code = FINGERPRINT_UPLOAD_FEATURE_FAIL;
+    HOST_CHECK(upChar(fp) == FINGERPRINT_UPLOAD_FEATURE_FAIL);
+    HOST_CHECK(fp.getCharTransferSupport() == FINGERPRINT_CHAR_TRANSFER_SUPPORTED);
+    return 0;
+}
+
+// 一次无应答不下结论，下一次应答即记为支持 / One silence settles nothing; the next acknowledge records support
+HOST_TEST(char_transfer_single_silence_keeps_probing)
+{
+    CharUnit charUnit;
+    charUnit.silent = 1;
+    charUnit.code   = FINGERPRINT_UPLOAD_FEATURE_FAIL;
+    SimUnit unit;
+    unit.setHandler(charHandler, &charUnit);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    HOST_CHECK(upChar(fp) == FINGERPRINT_PACKET_TIMEOUT);
+    HOST_CHECK(fp.getCharTransferSupport() == FINGERPRINT_CHAR_TRANSFER_UNKNOWN);
+    HOST_CHECK(upChar(fp) == FINGERPRINT_UPLOAD_FEATURE_FAIL);
+    HOST_CHECK(fp.getCharTransferSupport() == FINGERPRINT_CHAR_TRANSFER_SUPPORTED);
+    return 0;
+}
+
+// 连续 FINGERPRINT_CHAR_TRANSFER_SILENT_LIMIT 次无应答记为不支持 / FINGERPRINT_CHAR_TRANSFER_SILENT_LIMIT silences in a row record no support
+HOST_TEST(char_transfer_repeated_silence_means_unsupported)
+{
+    CharUnit charUnit;
+    charUnit.silent = FINGERPRINT_CHAR_TRANSFER_SILENT_LIMIT;
+    SimUnit unit;
+    unit.setHandler(charHandler, &charUnit);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    for (int i = 1; i < FINGERPRINT_CHAR_TRANSFER_SILENT_LIMIT; i++) {
+        HOST_CHECK(upChar(fp) == FINGERPRINT_PACKET_TIMEOUT);
+        HOST_CHECK(fp.getCharTransferSupport() == FINGERPRINT_CHAR_TRANSFER_UNKNOWN);
+    }
+    HOST_CHECK(upChar(fp) == FINGERPRINT_PACKET_TIMEOUT);
+    HOST_CHECK(fp.getCharTransferSupport() == FINGERPRINT_CHAR_TRANSFER_UNSUPPORTED);
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// C++20 协程封装：在 std::thread 调度器上 co_await 单条命令、串接两个任务，以及参数过长时不挂起。
+// 以 C++20 单独编译为 fingerprint_coro_test。
+// C++20 coroutine wrappers: co_await a single command on the std::thread scheduler, chain two tasks, and complete
+// without suspending when the parameters are too long. Built separately as C++20 into fingerprint_coro_test.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "M5UnitFingerprint2_coro.hpp"
+
+#ifndef FINGERPRINT_CORO_AVAILABLE
+#error "fingerprint_coro_test must be built as C++20 with coroutine support"
+#endif
+
+static const uint8_t CORO_UNIT_ID = 0x41;
+
+// 分离的任务把结果写在这里，测试线程等待 done / Detached tasks write their results here and the test thread waits for done
+struct CoroOutcome {
+    std::atomic<bool> done{false};
+    fingerprint_status_t status = FINGERPRINT_PACKET_TIMEOUT;
+    uint8_t version             = 0;
+    uint16_t count              = 0;
+    bool onScheduler            = false;
+};
+
+static bool awaitOutcome(const CoroOutcome& outcome)
+{
+    uint64_t deadline = hostNowNs() + 2000000000ull;
+    while (!outcome.done) {
+        if (hostNowNs() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// 读取固件版本，模拟模组以其 ID 作为版本 / Read the firmware version; the simulated unit reports its ID as the version
+static Fingerprint_Task<uint8_t> readVersion(const Fingerprint_CoDevice& co)
+{
+    Fingerprint_CommandResult result = co_await co.command(FINGERPRINT_GET_FINGERPRINT_VERSION);
+    co_return (result.ok() && result.length >= 1) ? result.data[0] : 0;
+}
+
+static Fingerprint_Task<> awaitVersion(const Fingerprint_CoDevice& co, CoroOutcome& outcome, std::thread::id caller)
+{
+    Fingerprint_CommandResult result = co_await co.command(FINGERPRINT_GET_FINGERPRINT_VERSION);
+    outcome.status      = result.status;
+    outcome.version     = (result.length >= 1) ? result.data[0] : 0;
+    outcome.onScheduler = (std::this_thread::get_id() != caller);
+    outcome.done        = true;
+}
+
+// 外层任务等待内层任务，再发出两条命令 / The outer task awaits the inner one, then sends two more commands
+static Fingerprint_Task<> chainedTasks(const Fingerprint_CoDevice& co, CoroOutcome& outcome)
+{
+    uint8_t version                  = co_await readVersion(co);
+    Fingerprint_CommandResult shake  = co_await co.handShake();
+    Fingerprint_CommandResult models = co_await co.validTemplateNum();
+    outcome.status                   = shake.ok() ? models.status : shake.status;
+    outcome.version                  = version;
+    outcome.count                    = models.u16(0);
+    outcome.done                     = true;
+}
+
+static Fingerprint_Task<> oversizedCommand(const Fingerprint_CoDevice& co, CoroOutcome& outcome)
+{
+    static uint8_t params[FINGERPRINT_ASYNC_PAYLOAD_SIZE + 1];
+    Fingerprint_CommandResult result = co_await co.command(FINGERPRINT_CONTROL_LED, params, sizeof(params));
+    outcome.status                   = result.status;
+    outcome.done                     = true;
+}
+
+static bool coroHandler(SimUnit& unit, uint8_t command, const uint8_t* param, size_t paramLength, void* context)
+{
+    (void)param;
+    (void)paramLength;
+    (void)context;
+    if (command == FINGERPRINT_VALID_MODEL_COUNT) {
+        uint8_t count[3] = {FINGERPRINT_OK, 0x00, 0x07};
+        unit.reply(count, sizeof(count));
+        return true;
+    }
+    return false;
+}
+
+#define CORO_SETUP()                                                          \
+    SimUnit unit(CORO_UNIT_ID);                                               \
+    unit.setHandler(coroHandler, nullptr);                                    \
+    HOST_CHECK(unit.start());                                                 \
+    M5UnitFingerprint2 fp(unit.transport());                                  \
+    HOST_CHECK(fp.begin());                                                   \
+    Fingerprint_CoroScheduler scheduler;                                      \
+    HOST_CHECK(scheduler.attach(fp));                                         \
+    HOST_CHECK(scheduler.begin());                                            \
+    Fingerprint_CoDevice co(fp, &scheduler)
+
+// 单条命令：协程在调度线程上恢复并得到应答 / A single command: the coroutine resumes on the scheduler thread with the acknowledge
+HOST_TEST(coro_await_command)
+{
+    CORO_SETUP();
+
+    CoroOutcome outcome;
+    awaitVersion(co, outcome, std::this_thread::get_id()).start();
+    HOST_CHECK(awaitOutcome(outcome));
+    scheduler.end();
+
+    HOST_CHECK(outcome.status == FINGERPRINT_OK);
+    HOST_CHECK(outcome.version == CORO_UNIT_ID);
+    HOST_CHECK(outcome.onScheduler);
+    return 0;
+}
+
+// 串接的任务：内层任务的返回值交给外层，之后的命令依次完成 / Chained tasks: the inner task's value reaches the outer one and the later commands complete in turn
+HOST_TEST(coro_chained_tasks)
+{
+    CORO_SETUP();
+
+    CoroOutcome outcome;
+    chainedTasks(co, outcome).start();
+    HOST_CHECK(awaitOutcome(outcome));
+    scheduler.end();
+
+    printf("status=0x%02X version=0x%02X count=%u commands=%u\n", outcome.status, outcome.version, outcome.count,
+           static_cast<unsigned>(unit.commandsReceived()));
+    HOST_CHECK(outcome.status == FINGERPRINT_OK);
+    HOST_CHECK(outcome.version == CORO_UNIT_ID);
+    HOST_CHECK(outcome.count == 7);
+    return 0;
+}
+
+// 参数超过 FINGERPRINT_ASYNC_PAYLOAD_SIZE：不发出命令，直接以参数错误完成 / Parameters above FINGERPRINT_ASYNC_PAYLOAD_SIZE: nothing is sent and the result is a parameter error
+HOST_TEST(coro_oversized_params)
+{
+    CORO_SETUP();
+
+    uint32_t before = unit.commandsReceived();
+    CoroOutcome outcome;
+    oversizedCommand(co, outcome).start();
+    HOST_CHECK(outcome.done);
+    scheduler.end();
+
+    HOST_CHECK(outcome.status == FINGERPRINT_PARAM_ERROR);
+    HOST_CHECK(unit.commandsReceived() == before);
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 多个实例并行：每个实例有自己的锁和响应槽，应答只交给发出命令的实例，各实例之间不互相串行。
+// Instances in parallel: each instance has its own locks and response slot, so answers reach only the instance that
+// sent the command and the instances do not serialize behind each other.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+#include <atomic>
+#include <thread>
+
+static const int MULTI_UNITS            = 4;
+static const int MULTI_COMMANDS         = 100;
+static const uint32_t MULTI_REPLY_DELAY = 2;  // 模组处理时间（毫秒） / Unit processing time (milliseconds)
+
+HOST_TEST(multi_unit_parallel)
+{
+    SimUnit* units[MULTI_UNITS];
+    M5UnitFingerprint2* fp[MULTI_UNITS];
+    for (int i = 0; i < MULTI_UNITS; i++) {
+        units[i] = new SimUnit(0x10 + i);
+        units[i]->setReplyDelayMs(MULTI_REPLY_DELAY);
+        HOST_CHECK(units[i]->start());
+        fp[i] = new M5UnitFingerprint2(units[i]->transport());
+        HOST_CHECK(fp[i]->begin());
+    }
+
+    std::atomic<int> wrong{0};
+    std::thread users[MULTI_UNITS];
+    uint64_t start = hostNowNs();
+    for (int i = 0; i < MULTI_UNITS; i++) {
+        users[i] = std::thread([&, i] {
+            for (int k = 0; k < MULTI_COMMANDS; k++) {
+                uint8_t version = 0;
+                if (fp[i]->PS_GetFirmwareVersion(version) != FINGERPRINT_OK || version != units[i]->id()) {
+                    wrong++;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < MULTI_UNITS; i++) {
+        users[i].join();
+    }
+    double elapsedMs = (hostNowNs() - start) / 1e6;
+    printf("%d units x %d commands in %.0f ms, %d wrong\n", MULTI_UNITS, MULTI_COMMANDS, elapsedMs, wrong.load());
+
+    for (int i = 0; i < MULTI_UNITS; i++) {
+        delete fp[i];
+        delete units[i];
+    }
+
+    HOST_CHECK(wrong == 0);
+    // 串行执行至少需要 units * commands * delay；并行时接近单个实例的时间 / Serial execution needs at least
+    // units * commands * delay; in parallel it stays close to one instance's time
+    HOST_CHECK(elapsedMs < MULTI_UNITS * MULTI_COMMANDS * MULTI_REPLY_DELAY);
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 自动流程会话的状态机：开始后等待手指，阶段包到达后结束，此时由另一线程 poll()，测试线程只读取 done() 与 result()；
+// 以及等待手指时取消。
+// Auto flow session state machine: after begin() it waits for a finger and finishes once the stage packets arrive,
+// with another thread calling poll() while the test thread only reads done() and result(); and a cancel while it
+// waits for a finger.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "M5UnitFingerprint2_session.hpp"
+
+struct SessionUnit {
+    std::atomic<bool> waiting{false};  // 自动流程已开始等待手指 / The auto flow is waiting for a finger
+    std::atomic<int> cancels{0};
+};
+
+static bool sessionHandler(SimUnit& unit, uint8_t command, const uint8_t* param, size_t paramLength, void* context)
+{
+    (void)param;
+    (void)paramLength;
+    SessionUnit* session = static_cast<SessionUnit*>(context);
+    if (command == FINGERPRINT_AUTO_ENROLL) {
+        uint8_t started[3] = {FINGERPRINT_OK, PS_AUTO_ENROLL_PARAM1_LEGAL_CHECK, 0x00};
+        unit.reply(started, sizeof(started));
+        session->waiting = true;
+        return true;
+    }
+    if (command == FINGERPRINT_AUTO_IDENTIFY) {
+        uint8_t started[6] = {FINGERPRINT_OK, PS_AUTO_IDENTIFY_PARAM_LEGAL_CHECK, 0, 0, 0, 0};
+        unit.reply(started, sizeof(started));
+        session->waiting = true;
+        return true;
+    }
+    if (command == FINGERPRINT_CANCEL_AUTO_FLOW) {
+        session->waiting = false;
+        session->cancels++;
+        unit.replyCode(FINGERPRINT_OK);
+        return true;
+    }
+    return false;
+}
+
+// 在另一线程推进会话，直到结束 / Advance the session on another thread until it is done
+class SessionPoller {
+public:
+    explicit SessionPoller(Fingerprint_AutoFlowSession& session)
+        : _thread([&session] {
+              while (session.poll() == FINGERPRINT_SESSION_RUNNING) {
+                  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+              }
+          })
+    {
+    }
+    ~SessionPoller() { _thread.join(); }
+
+private:
+    std::thread _thread;
+};
+
+template <typename Predicate>
+static bool waitFor(Predicate predicate)
+{
+    uint64_t deadline = hostNowNs() + 2000000000ull;
+    while (!predicate()) {
+        if (hostNowNs() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// 开始 → 等待手指 → 按手指后的阶段包 → 结束 / Begin → waiting for a finger → the stages after the finger is placed → done
+HOST_TEST(session_enroll_waits_then_done)
+{
+    SessionUnit sessionUnit;
+    SimUnit unit(0x51);
+    unit.setHandler(sessionHandler, &sessionUnit);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    Fingerprint_AutoEnrollSession session(fp);
+    HOST_CHECK(session.state() == FINGERPRINT_SESSION_IDLE);
+    HOST_CHECK(session.begin(3, 1, FINGERPRINT_AUTO_ENROLL_DEFAULT) == FINGERPRINT_OK);
+    HOST_CHECK(session.state() == FINGERPRINT_SESSION_RUNNING);
+    {
+        SessionPoller poller(session);
+
+        // 只有合法性检测的阶段包：会话仍在进行 / Only the legality check stage so far: the session keeps running
+        HOST_CHECK(waitFor([&] { return sessionUnit.waiting.load(); }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        HOST_CHECK(!session.done());
+        HOST_CHECK(session.result() == FINGERPRINT_OK);
+
+        // 按下手指 / A finger is placed
+        const uint8_t stages[][3] = {{FINGERPRINT_OK, PS_AUTO_ENROLL_PARAM1_GET_IMAGE, 0x01},
+                                     {FINGERPRINT_OK, PS_AUTO_ENROLL_PARAM1_GEN_CHAR, 0x01},
+                                     {FINGERPRINT_OK, PS_AUTO_ENROLL_PARAM1_MERGE_TEMPLATE, 0xF0},
+                                     {FINGERPRINT_OK, PS_AUTO_ENROLL_PARAM1_STORE, 0xF2}};
+        for (const uint8_t* stage : stages) {
+            unit.reply(stage, 3);
+        }
+        HOST_CHECK(waitFor([&] { return session.done(); }));
+    }
+
+    printf("result=0x%02X packets=%d param1=%u\n", session.result(), session.packetCount(), session.param1());
+    HOST_CHECK(session.result() == FINGERPRINT_OK);
+    HOST_CHECK(session.packetCount() == 5);
+    HOST_CHECK(session.param1() == PS_AUTO_ENROLL_PARAM1_STORE);
+    HOST_CHECK(sessionUnit.cancels == 0);
+
+    // 会话已注销，阻塞命令照常工作 / The session is unregistered and blocking commands work as usual
+    uint8_t version = 0;
+    HOST_CHECK(fp.PS_GetFirmwareVersion(version) == FINGERPRINT_OK && version == 0x51);
+    return 0;
+}
+
+// 等待手指时取消：会话以 FINGERPRINT_OPERATION_BLOCKED 结束 / Cancel while waiting for a finger: the session finishes with FINGERPRINT_OPERATION_BLOCKED
+HOST_TEST(session_identify_cancel)
+{
+    SessionUnit sessionUnit;
+    SimUnit unit(0x52);
+    unit.setHandler(sessionHandler, &sessionUnit);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    // cancel() 与 poll() 在同一线程调用 / cancel() is called on the same thread as poll()
+    Fingerprint_AutoIdentifySession session(fp);
+    HOST_CHECK(session.begin(0, 0xFFFF, FINGERPRINT_AUTO_VERIFY_DEFAULT) == FINGERPRINT_OK);
+    HOST_CHECK(waitFor([&] { return session.poll() == FINGERPRINT_SESSION_RUNNING && session.packetCount() == 1; }));
+    HOST_CHECK(sessionUnit.waiting);
+
+    HOST_CHECK(session.cancel());
+    HOST_CHECK(waitFor([&] { return session.poll() == FINGERPRINT_SESSION_DONE; }));
+
+    printf("result=0x%02X packets=%d cancels=%d\n", session.result(), session.packetCount(), sessionUnit.cancels.load());
+    HOST_CHECK(session.result() == FINGERPRINT_OPERATION_BLOCKED);
+    HOST_CHECK(sessionUnit.cancels == 1);
+    HOST_CHECK(!session.cancel());
+
+    uint8_t version = 0;
+    HOST_CHECK(fp.PS_GetFirmwareVersion(version) == FINGERPRINT_OK && version == 0x52);
+    return 0;
+}
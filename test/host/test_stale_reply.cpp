@@ -0,0 +1,178 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 命令超时之后：下一条形状相同的命令必须得到自己的应答，无论超时的命令从未应答还是迟到应答。
+// 阻塞命令与异步命令同时在途时，应答交给发出该命令的一方。
+// After a command times out, the next command of the same shape must get its own reply, whether the timed-out command
+// never answers or answers late. With a blocking and an asynchronous command in flight together, each reply goes to
+// whoever sent the command.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+#include <atomic>
+#include <thread>
+
+// 版本查询应答第 n 条命令时返回 n / The version query answers the n-th command with n
+struct CountingUnit {
+    std::atomic<uint8_t> count{0};
+    uint8_t silent      = 0;  // 不应答的命令序号 / Number of the command left unanswered
+    uint8_t late        = 0;  // 迟到应答的命令序号 / Number of the command answered late
+    uint32_t lateMs     = 0;  // 迟到的时间 / How late
+    uint32_t delayMs    = 0;  // 每个版本应答前的处理时间 / Processing time before each version reply
+};
+
+static bool countingHandler(SimUnit& unit, uint8_t command, const uint8_t* param, size_t paramLength, void* context)
+{
+    (void)param;
+    (void)paramLength;
+    CountingUnit* counting = static_cast<CountingUnit*>(context);
+    if (command != FINGERPRINT_GET_FINGERPRINT_VERSION) {
+        return false;
+    }
+    uint8_t n = ++counting->count;
+    if (n == counting->silent) {
+        return true;
+    }
+    uint32_t delayMs = (n == counting->late) ? counting->lateMs : counting->delayMs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+    uint8_t reply[2] = {FINGERPRINT_OK, n};
+    unit.reply(reply, sizeof(reply));
+    return true;
+}
+
+// 超时的命令从未应答 / The timed-out command never answers
+HOST_TEST(stale_reply_timeout_then_success)
+{
+    CountingUnit counting;
+    counting.silent = 1;
+    SimUnit unit;
+    unit.setHandler(countingHandler, &counting);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    uint8_t version = 0;
+    HOST_CHECK(fp.PS_GetFirmwareVersion(version) == FINGERPRINT_PACKET_TIMEOUT);
+    for (uint8_t n = 2; n <= 4; n++) {
+        HOST_CHECK(fp.PS_GetFirmwareVersion(version) == FINGERPRINT_OK);
+        HOST_CHECK(version == n);
+    }
+
+    fingerprint_rx_stats_t stats;
+    fp.getReceiveStats(stats);
+    printf("probes=%u stale=%u mismatched=%u\n", stats.syncProbes, stats.staleReplies, stats.mismatchedReplies);
+    HOST_CHECK(stats.syncProbes == 1);
+    HOST_CHECK(stats.staleReplies == 0);
+    return 0;
+}
+
+// 超时的命令在下一条命令发出之后才应答 / The timed-out command answers after the next command has been sent
+HOST_TEST(stale_reply_late_reply_dropped)
+{
+    CountingUnit counting;
+    counting.late   = 1;
+    counting.lateMs = 1300;
+    SimUnit unit;
+    unit.setHandler(countingHandler, &counting);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    uint8_t version = 0;
+    HOST_CHECK(fp.PS_GetFirmwareVersion(version) == FINGERPRINT_PACKET_TIMEOUT);
+    HOST_CHECK(fp.PS_GetFirmwareVersion(version) == FINGERPRINT_OK);
+    HOST_CHECK(version == 2);
+    HOST_CHECK(fp.PS_GetFirmwareVersion(version) == FINGERPRINT_OK);
+    HOST_CHECK(version == 3);
+
+    fingerprint_rx_stats_t stats;
+    fp.getReceiveStats(stats);
+    printf("probes=%u stale=%u mismatched=%u\n", stats.syncProbes, stats.staleReplies, stats.mismatchedReplies);
+    HOST_CHECK(stats.staleReplies == 1);
+    return 0;
+}
+
+struct AsyncResult {
+    std::atomic<bool> done{false};
+    fingerprint_status_t status = FINGERPRINT_OK;
+    uint8_t value               = 0;
+};
+
+static void onVersion(uint32_t handle, fingerprint_status_t status, const uint8_t* response, uint16_t responseLength,
+                      void* context)
+{
+    (void)handle;
+    AsyncResult* result = static_cast<AsyncResult*>(context);
+    result->status      = status;
+    result->value       = (responseLength > 0) ? response[0] : 0;
+    result->done        = true;
+}
+
+static bool awaitAsync(M5UnitFingerprint2& fp, AsyncResult& result)
+{
+    uint64_t start = hostNowNs();
+    while (!result.done && hostNowNs() - start < 3000000000ULL) {
+        fp.update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return result.done;
+}
+
+// 异步命令超时后，下一条异步命令成功 / After an asynchronous command times out, the next one succeeds
+HOST_TEST(stale_reply_async_timeout_then_success)
+{
+    CountingUnit counting;
+    counting.silent = 1;
+    SimUnit unit;
+    unit.setHandler(countingHandler, &counting);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    AsyncResult first;
+    HOST_CHECK(fp.submitCommand(FINGERPRINT_GET_FINGERPRINT_VERSION, nullptr, 0, 200, onVersion, &first) != 0);
+    HOST_CHECK(awaitAsync(fp, first));
+    HOST_CHECK(first.status == FINGERPRINT_PACKET_TIMEOUT);
+
+    AsyncResult second;
+    HOST_CHECK(fp.submitCommand(FINGERPRINT_GET_FINGERPRINT_VERSION, nullptr, 0, 1000, onVersion, &second) != 0);
+    HOST_CHECK(awaitAsync(fp, second));
+    HOST_CHECK(second.status == FINGERPRINT_OK);
+    HOST_CHECK(second.value == 2);
+    return 0;
+}
+
+// 阻塞命令先发出，异步命令随后：各自得到自己的应答 / A blocking command goes out first and an asynchronous one follows: each gets its own reply
+HOST_TEST(stale_reply_blocking_and_async_in_flight)
+{
+    CountingUnit counting;
+    counting.delayMs = 50;
+    SimUnit unit;
+    unit.setHandler(countingHandler, &counting);
+    HOST_CHECK(unit.start());
+    M5UnitFingerprint2 fp(unit.transport());
+    HOST_CHECK(fp.begin());
+
+    fingerprint_status_t blockingStatus = FINGERPRINT_PACKET_TIMEOUT;
+    uint8_t blockingValue               = 0;
+    std::thread blocking([&] { blockingStatus = fp.PS_GetFirmwareVersion(blockingValue); });
+    while (unit.commandsReceived() == 0 || counting.count == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    AsyncResult async;
+    HOST_CHECK(fp.submitCommand(FINGERPRINT_GET_FINGERPRINT_VERSION, nullptr, 0, 1000, onVersion, &async) != 0);
+    bool asyncDone = awaitAsync(fp, async);
+    blocking.join();
+
+    printf("blocking=0x%02X value=%u, async=0x%02X value=%u\n", blockingStatus, blockingValue, async.status,
+           async.value);
+    HOST_CHECK(asyncDone);
+    HOST_CHECK(blockingStatus == FINGERPRINT_OK && blockingValue == 1);
+    HOST_CHECK(async.status == FINGERPRINT_OK && async.value == 2);
+    return 0;
+}
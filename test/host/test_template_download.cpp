@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 7BH 分段下载：段长加倍直到模组的上限、分段被拒绝后退回已接受的段长、缓存的段长被拒绝时重新学习。
+// 每种情况都检查模拟模组拼出的模板与原模板逐字节相同，且没有校验和错误的帧。
+// 7BH chunked download: the chunk doubling up to the module's limit, falling back to the accepted size after a rejected
+// chunk, and learning again when the cached size is rejected. Each case checks that the template the simulated unit
+// reassembles matches the original byte for byte, with no frame failing its checksum.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+#include <atomic>
+#include <cstring>
+
+static const uint16_t DOWNLOAD_TEMPLATE_SIZE = 600;
+
+// 模组按偏移拼接收到的分段，拒绝超过 limit 的分段 / The module places chunks at their offsets and rejects any above limit
+struct DownloadUnit {
+    uint8_t received[DOWNLOAD_TEMPLATE_SIZE];
+    std::atomic<uint16_t> limit{0};  // 0 为不限 / 0 for no limit
+    std::atomic<uint16_t> largest{0};
+    std::atomic<int> rejected{0};
+};
+
+static bool downloadHandler(SimUnit& unit, uint8_t command, const uint8_t* param, size_t paramLength, void* context)
+{
+    DownloadUnit* download = static_cast<DownloadUnit*>(context);
+    if (command != FINGERPRINT_DOWN_TEMPLATE || paramLength < 4) {
+        return false;
+    }
+    uint16_t offset = (param[0] << 8) | param[1];
+    uint16_t size   = (param[2] << 8) | param[3];
+    if (paramLength != 4u + size || offset + size > DOWNLOAD_TEMPLATE_SIZE ||
+        (download->limit != 0 && size > download->limit)) {
+        download->rejected++;
+        unit.replyCode(FINGERPRINT_RECEIVE_ERROR);
+        return true;
+    }
+    memcpy(download->received + offset, param + 4, size);
+    if (size > download->largest) {
+        download->largest = size;
+    }
+    unit.replyCode(FINGERPRINT_OK);
+    return true;
+}
+
+static uint8_t original[DOWNLOAD_TEMPLATE_SIZE];
+
+// 下载一次并比较模组拼出的模板 / Download once and compare the template the module reassembled
+static bool downloadMatches(M5UnitFingerprint2& fp, SimUnit& unit, DownloadUnit& download)
+{
+    for (uint16_t i = 0; i < DOWNLOAD_TEMPLATE_SIZE; i++) {
+        original[i] = static_cast<uint8_t>(i * 13 + 5);
+    }
+    memset(download.received, 0, sizeof(download.received));
+    return fp.PS_DownloadTemplateAuto(original, sizeof(original)) == FINGERPRINT_OK &&
+           memcmp(download.received, original, sizeof(original)) == 0 && unit.checksumErrors() == 0;
+}
+
+#define DOWNLOAD_SETUP(download)                                              \
+    SimUnit unit(0x22);                                                       \
+    unit.setHandler(downloadHandler, &download);                              \
+    HOST_CHECK(unit.start());                                                 \
+    M5UnitFingerprint2 fp(unit.transport());                                  \
+    HOST_CHECK(fp.begin());                                                   \
+    fp.setCharTransferSupport(FINGERPRINT_CHAR_TRANSFER_UNSUPPORTED)
+
+// 模组不限段长：段长加倍到 FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX 并缓存 / No limit in the module: the chunk doubles to FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX and is cached
+HOST_TEST(template_download_doubles_to_limit)
+{
+    DownloadUnit download;
+    DOWNLOAD_SETUP(download);
+
+    HOST_CHECK(downloadMatches(fp, unit, download));
+    printf("largest=%u learned=%u\n", download.largest.load(), fp.getTemplateDownloadChunkSize());
+    HOST_CHECK(download.largest == FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX);
+    HOST_CHECK(fp.getTemplateDownloadChunkSize() == FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_MAX);
+    HOST_CHECK(downloadMatches(fp, unit, download));
+    HOST_CHECK(download.rejected == 0);
+    return 0;
+}
+
+// 模组拒绝超过 150 字节的分段：加倍到 200 被拒绝后退回 100 并保持 / The module rejects chunks above 150 bytes: doubling to 200 is rejected, so 100 is resent and kept
+HOST_TEST(template_download_rejected_chunk_falls_back)
+{
+    DownloadUnit download;
+    download.limit = 150;
+    DOWNLOAD_SETUP(download);
+
+    HOST_CHECK(downloadMatches(fp, unit, download));
+    printf("rejected=%d learned=%u\n", download.rejected.load(), fp.getTemplateDownloadChunkSize());
+    HOST_CHECK(download.rejected == 1);
+    HOST_CHECK(fp.getTemplateDownloadChunkSize() == FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_START);
+
+    // 之后的下载流水线发送，不再被拒绝 / Later downloads are pipelined and no longer rejected
+    HOST_CHECK(downloadMatches(fp, unit, download));
+    HOST_CHECK(download.rejected == 1);
+    return 0;
+}
+
+// 同一固件版本下模组改为只接受 64 字节：缓存的 100 被拒绝，重新学习 / Same firmware, but the module now takes only 64 bytes: the cached 100 is rejected and learned again
+HOST_TEST(template_download_cached_size_relearn)
+{
+    DownloadUnit download;
+    download.limit = 150;
+    DOWNLOAD_SETUP(download);
+
+    HOST_CHECK(downloadMatches(fp, unit, download));
+    HOST_CHECK(fp.getTemplateDownloadChunkSize() == FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_START);
+
+    download.limit = 64;
+    HOST_CHECK(downloadMatches(fp, unit, download));
+    printf("learned=%u\n", fp.getTemplateDownloadChunkSize());
+    HOST_CHECK(fp.getTemplateDownloadChunkSize() == FINGERPRINT_TEMPLATE_DOWNLOAD_CHUNK_START / 2);
+    HOST_CHECK(downloadMatches(fp, unit, download));
+    return 0;
+}
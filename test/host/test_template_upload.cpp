@@ -0,0 +1,175 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// 7AH 分段上传：学习模组截断应答的长度、第一段被拒绝时减半、缓存的段长不再相符时重新学习，以及计时回调。
+// 每种情况都检查上传的模板与模拟模组中的逐字节相同。
+// 7AH chunked upload: learning the size the module caps replies at, halving when the first chunk is rejected,
+// learning again when the cached size no longer matches, and the timed callback. Each case checks that the uploaded
+// template matches the simulated unit's byte for byte.
+
+#include "host_test.hpp"
+#include "sim_unit.hpp"
+
+#include <atomic>
+#include <cstring>
+
+static const uint16_t UPLOAD_TEMPLATE_SIZE = 300;
+
+// 模组中的模板与 7AH 的应答方式 / The template in the module, and how it answers 7AH
+struct UploadUnit {
+    uint8_t data[UPLOAD_TEMPLATE_SIZE];
+    std::atomic<uint16_t> cap{0};         // 应答最多携带的字节数，0 为不限 / Most bytes a reply carries, 0 for no cap
+    std::atomic<uint16_t> maxRequest{0};  // 超过该长度的请求被拒绝，0 为不限 / Requests above this size are rejected, 0 for no limit
+    std::atomic<uint16_t> firstRequest{0};
+    std::atomic<int> rejected{0};
+
+    UploadUnit()
+    {
+        for (uint16_t i = 0; i < UPLOAD_TEMPLATE_SIZE; i++) {
+            data[i] = static_cast<uint8_t>(i * 7 + 3);
+        }
+    }
+};
+
+static bool uploadHandler(SimUnit& unit, uint8_t command, const uint8_t* param, size_t paramLength, void* context)
+{
+    UploadUnit* upload = static_cast<UploadUnit*>(context);
+    if (command != FINGERPRINT_UP_TEMPLATE || paramLength < 4) {
+        return false;
+    }
+    uint16_t offset   = (param[0] << 8) | param[1];
+    uint16_t size     = (param[2] << 8) | param[3];
+    uint16_t expected = 0;
+    upload->firstRequest.compare_exchange_strong(expected, size);
+
+    uint8_t reply[3 + FINGERPRINT_MAX_PACKET_SIZE] = {FINGERPRINT_OK, 0, 0};
+    if (upload->maxRequest != 0 && size > upload->maxRequest) {
+        upload->rejected++;
+        reply[0] = FINGERPRINT_UPLOAD_FEATURE_FAIL;
+        unit.reply(reply, 3);
+        return true;
+    }
+    uint16_t length = (offset < UPLOAD_TEMPLATE_SIZE) ? UPLOAD_TEMPLATE_SIZE - offset : 0;
+    if (length > size) {
+        length = size;
+    }
+    if (upload->cap != 0 && length > upload->cap) {
+        length = upload->cap;
+    }
+    reply[1] = length >> 8;
+    reply[2] = length & 0xFF;
+    memcpy(reply + 3, upload->data + offset, length);
+    unit.reply(reply, 3 + length);
+    return true;
+}
+
+// 上传一次并与模组中的模板比较 / Upload once and compare with the module's template
+static bool uploadMatches(M5UnitFingerprint2& fp, const UploadUnit& upload)
+{
+    uint8_t buffer[1024];
+    uint32_t actualSize = 0;
+    memset(buffer, 0, sizeof(buffer));
+    return fp.PS_UploadTemplateAuto(buffer, sizeof(buffer), actualSize) == FINGERPRINT_OK &&
+           actualSize == UPLOAD_TEMPLATE_SIZE && memcmp(buffer, upload.data, UPLOAD_TEMPLATE_SIZE) == 0;
+}
+
+#define UPLOAD_SETUP(upload)                                                  \
+    SimUnit unit(0x21);                                                       \
+    unit.setHandler(uploadHandler, &upload);                                  \
+    HOST_CHECK(unit.start());                                                 \
+    M5UnitFingerprint2 fp(unit.transport());                                  \
+    HOST_CHECK(fp.begin());                                                   \
+    fp.setCharTransferSupport(FINGERPRINT_CHAR_TRANSFER_UNSUPPORTED)
+
+// 模组把应答截断为 100 字节：学到 100，之后流水线上传 / The module caps replies at 100 bytes: 100 is learned and later uploads are pipelined
+HOST_TEST(template_upload_capped_replies)
+{
+    UploadUnit upload;
+    upload.cap = 100;
+    UPLOAD_SETUP(upload);
+
+    HOST_CHECK(uploadMatches(fp, upload));
+    HOST_CHECK(upload.firstRequest == FINGERPRINT_TEMPLATE_CHUNK_MAX);
+    HOST_CHECK(fp.getTemplateChunkSize() == 100);
+    HOST_CHECK(uploadMatches(fp, upload));
+    HOST_CHECK(fp.getTemplateChunkSize() == 100);
+    return 0;
+}
+
+// 模组拒绝超过 100 字节的请求：第一段减半两次 / The module rejects requests above 100 bytes: the first chunk is halved twice
+HOST_TEST(template_upload_rejected_first_chunk_halves)
+{
+    UploadUnit upload;
+    upload.maxRequest = 100;
+    UPLOAD_SETUP(upload);
+
+    HOST_CHECK(uploadMatches(fp, upload));
+    printf("rejected=%d learned=%u\n", upload.rejected.load(), fp.getTemplateChunkSize());
+    HOST_CHECK(upload.rejected == 2);
+    HOST_CHECK(fp.getTemplateChunkSize() == FINGERPRINT_TEMPLATE_CHUNK_MAX / 2 / 2);
+    return 0;
+}
+
+// 同一固件版本下模组改为截断到 64 字节：缓存的 100 不再相符，重新学习 / Same firmware, but the module now caps at 64 bytes: the cached 100 no longer matches and is learned again
+HOST_TEST(template_upload_cached_size_relearn)
+{
+    UploadUnit upload;
+    upload.cap = 100;
+    UPLOAD_SETUP(upload);
+
+    HOST_CHECK(uploadMatches(fp, upload));
+    HOST_CHECK(fp.getTemplateChunkSize() == 100);
+
+    upload.cap = 64;
+    HOST_CHECK(uploadMatches(fp, upload));
+    HOST_CHECK(fp.getTemplateChunkSize() == 64);
+    HOST_CHECK(uploadMatches(fp, upload));
+    return 0;
+}
+
+struct TimedProgress {
+    int calls          = 0;
+    int completions    = 0;
+    uint32_t lastTotal = 0;
+    uint32_t lastUs    = 0;
+    bool monotonic     = true;
+};
+
+static bool onTimedUpload(uint16_t currentSize, uint32_t totalSize, int packetCount, bool isComplete,
+                          uint32_t elapsedUs, void* context)
+{
+    (void)currentSize;
+    (void)packetCount;
+    TimedProgress* progress = static_cast<TimedProgress*>(context);
+    progress->calls++;
+    progress->completions += isComplete;
+    progress->monotonic   = progress->monotonic && elapsedUs >= progress->lastUs;
+    progress->lastTotal   = totalSize;
+    progress->lastUs      = elapsedUs;
+    return true;
+}
+
+// 计时回调：每段一次，最后一次标记完成并给出整个模板的用时 / Timed callback: once per chunk, then a final call marked complete with the time for the whole template
+HOST_TEST(template_upload_timed_callback)
+{
+    UploadUnit upload;
+    upload.cap = 100;
+    UPLOAD_SETUP(upload);
+    unit.setReplyDelayMs(2);
+
+    uint8_t buffer[1024];
+    uint32_t actualSize = 0;
+    TimedProgress progress;
+    HOST_CHECK(fp.PS_UploadTemplateAuto(buffer, sizeof(buffer), actualSize, onTimedUpload, &progress) ==
+               FINGERPRINT_OK);
+    printf("calls=%d total=%u elapsed=%u us\n", progress.calls, progress.lastTotal, progress.lastUs);
+    HOST_CHECK(actualSize == UPLOAD_TEMPLATE_SIZE);
+    HOST_CHECK(memcmp(buffer, upload.data, UPLOAD_TEMPLATE_SIZE) == 0);
+    HOST_CHECK(progress.calls == 4 && progress.completions == 1);
+    HOST_CHECK(progress.lastTotal == UPLOAD_TEMPLATE_SIZE);
+    HOST_CHECK(progress.monotonic && progress.lastUs >= 2000);
+    return 0;
+}